@@ -1,13 +1,26 @@
 #include "base_node.h"
+#include "node_registry.h"
+#include <algorithm>
 #include <stdexcept>
+#include <iostream>
 
 namespace image_processor {
 
-    // Initialize static member for unique ID generation
-    int BaseNode::s_nextId = 0;
+    // Slot of m_outputPyramids holding the pyramid of the output itself
+    static const int PYRAMID_IMAGE_SLOT = 3;
+
+    // Initialize static member for unique ID generation. IDs only need to be
+    // unique, so relaxed ordering is enough for nodes created on any thread.
+    std::atomic<int> BaseNode::s_nextId(0);
+
+    // Output versions are compared for equality only, so relaxed ordering is enough as well
+    std::atomic<uint64_t> BaseNode::s_nextOutputVersion(0);
 
     BaseNode::BaseNode(const std::string& name)
-        : m_name(name), m_id(s_nextId++) {}
+        : m_name(name), m_id(s_nextId.fetch_add(1, std::memory_order_relaxed)), m_graphIndex(-1) {}
+
+    BaseNode::BaseNode(const BaseNode& other)
+        : m_name(other.m_name), m_id(s_nextId.fetch_add(1, std::memory_order_relaxed)), m_graphIndex(-1) {}
 
     std::string BaseNode::getName() const {
         return m_name;
@@ -21,6 +34,10 @@ namespace image_processor {
         return m_id;
     }
 
+    int BaseNode::getGraphIndex() const {
+        return m_graphIndex;
+    }
+
     bool BaseNode::connectOutput(int outputIndex, BaseNode* targetNode, int inputIndex) {
         if (outputIndex < 0 || outputIndex >= getOutputCount() ||
             inputIndex < 0 || inputIndex >= targetNode->getInputCount()) {
@@ -69,7 +86,7 @@ namespace image_processor {
 
     bool BaseNode::isReady() const {
         for (int i = 0; i < getInputCount(); ++i) {
-            if (getInputConnection(i).first == nullptr) {
+            if (getInputConnection(i).first == nullptr && !isInputOptional(i)) {
                 return false;
             }
         }
@@ -81,10 +98,270 @@ namespace image_processor {
     }
 
     cv::Mat BaseNode::getOutputValue(int outputIndex) const {
-        if (m_outputValues.find(outputIndex) != m_outputValues.end()) {
-            return m_outputValues.at(outputIndex);
+        return getOutputPortValue(outputIndex).getMat();
+    }
+
+    PortValue BaseNode::getOutputPortValue(int outputIndex) const {
+        auto it = m_outputValues.find(outputIndex);
+        if (it != m_outputValues.end()) {
+            return it->second;
+        }
+        return PortValue();
+    }
+
+    uint64_t BaseNode::getOutputVersion(int outputIndex) const {
+        auto it = m_outputVersions.find(outputIndex);
+        if (it != m_outputVersions.end()) {
+            return it->second;
+        }
+        return 0;
+    }
+
+    PortValue BaseNode::getInputPortValue(int inputIndex) const {
+        auto connection = getInputConnection(inputIndex);
+        if (connection.first == nullptr) {
+            return PortValue();
+        }
+        return connection.first->getOutputPortValue(connection.second);
+    }
+
+    PortType BaseNode::getInputType(int index) const {
+        return PortType::IMAGE;
+    }
+
+    PortType BaseNode::getOutputType(int index) const {
+        return PortType::IMAGE;
+    }
+
+    bool BaseNode::isInputOptional(int index) const {
+        return false;
+    }
+
+    void BaseNode::setOutputValue(int outputIndex, const PortValue& value) {
+        m_outputValues[outputIndex] = value;
+        m_outputVersions[outputIndex] = s_nextOutputVersion.fetch_add(1, std::memory_order_relaxed) + 1;
+
+        std::lock_guard<std::mutex> lock(m_derivedMutex);
+        m_derivedOutputs.erase(outputIndex);
+        m_outputPyramids.erase(outputIndex);
+    }
+
+    // Whether an image already has a derived form, so it serves as that form itself
+    static bool hasDerivedForm(const cv::Mat& image, DerivedFormat format) {
+        const int channels = image.channels();
+        return (format == DerivedFormat::GRAY && channels == 1 && image.depth() != CV_16F) ||
+            (format == DerivedFormat::FLOAT && image.depth() == CV_32F) ||
+            (format == DerivedFormat::PLANAR && channels == 1);
+    }
+
+    cv::Mat BaseNode::getDerivedOutput(int outputIndex, DerivedFormat format) const {
+        cv::Mat output = getOutputValue(outputIndex);
+        if (output.empty() || hasDerivedForm(output, format)) {
+            return output;
+        }
+
+        // Holding the lock while converting makes concurrent consumers wait
+        // for the first conversion instead of repeating it
+        std::lock_guard<std::mutex> lock(m_derivedMutex);
+        cv::Mat& derived = m_derivedOutputs[outputIndex][static_cast<int>(format)];
+        if (derived.empty()) {
+            derived = deriveImage(output, format);
+        }
+        return derived;
+    }
+
+    cv::Mat BaseNode::deriveImage(const cv::Mat& image, DerivedFormat format) {
+        if (image.empty() || hasDerivedForm(image, format)) {
+            return image;
+        }
+
+        const int channels = image.channels();
+        const bool halfFloat = image.depth() == CV_16F;
+        cv::Mat derived;
+        switch (format) {
+        case DerivedFormat::GRAY: {
+            // Gray conversion and the consumers of gray images work in single precision
+            cv::Mat source = image;
+            if (halfFloat) {
+                image.convertTo(source, CV_32F);
+            }
+            if (channels == 3) {
+                cv::cvtColor(source, derived, cv::COLOR_BGR2GRAY);
+            }
+            else if (channels == 4) {
+                cv::cvtColor(source, derived, cv::COLOR_BGRA2GRAY);
+            }
+            else if (halfFloat && channels == 1) {
+                derived = source;
+            }
+            else {
+                cv::extractChannel(source, derived, 0);
+            }
+            break;
+        }
+
+        case DerivedFormat::FLOAT:
+            image.convertTo(derived, CV_32F);
+            break;
+
+        case DerivedFormat::PLANAR: {
+            // Deinterleave straight into the rows of one matrix
+            derived.create(image.rows * channels, image.cols, image.depth());
+            std::vector<cv::Mat> sources = { image };
+            std::vector<cv::Mat> planes;
+            std::vector<int> fromTo;
+            for (int c = 0; c < channels; ++c) {
+                planes.push_back(derived.rowRange(c * image.rows, (c + 1) * image.rows));
+                fromTo.push_back(c);
+                fromTo.push_back(c);
+            }
+            cv::mixChannels(sources, planes, fromTo.data(), channels);
+            break;
+        }
+        }
+
+        return derived;
+    }
+
+    cv::Mat BaseNode::getDerivedInput(int inputIndex, DerivedFormat format) const {
+        auto connection = getInputConnection(inputIndex);
+        if (connection.first == nullptr) {
+            return cv::Mat();
+        }
+        return connection.first->getDerivedOutput(connection.second, format);
+    }
+
+    std::vector<cv::Mat> BaseNode::getOutputPyramid(int outputIndex, int levels) const {
+        return getPyramid(outputIndex, getOutputValue(outputIndex), PYRAMID_IMAGE_SLOT, levels);
+    }
+
+    std::vector<cv::Mat> BaseNode::getOutputPyramid(int outputIndex, int levels, DerivedFormat format) const {
+        return getPyramid(outputIndex, getDerivedOutput(outputIndex, format), static_cast<int>(format), levels);
+    }
+
+    std::vector<cv::Mat> BaseNode::getInputPyramid(int inputIndex, int levels) const {
+        auto connection = getInputConnection(inputIndex);
+        if (connection.first == nullptr) {
+            return {};
+        }
+        return connection.first->getOutputPyramid(connection.second, levels);
+    }
+
+    std::vector<cv::Mat> BaseNode::getInputPyramid(int inputIndex, int levels, DerivedFormat format) const {
+        auto connection = getInputConnection(inputIndex);
+        if (connection.first == nullptr) {
+            return {};
+        }
+        return connection.first->getOutputPyramid(connection.second, levels, format);
+    }
+
+    std::vector<cv::Mat> BaseNode::getPyramid(int outputIndex, const cv::Mat& image, int slot, int levels) const {
+        if (image.empty()) {
+            return {};
         }
-        return cv::Mat();
+
+        std::lock_guard<std::mutex> lock(m_derivedMutex);
+        std::vector<cv::Mat>& pyramid = m_outputPyramids[outputIndex][slot];
+        if (pyramid.empty()) {
+            // cv::pyrDown does not take half floats
+            if (image.depth() == CV_16F) {
+                cv::Mat widened;
+                image.convertTo(widened, CV_32F);
+                pyramid.push_back(widened);
+            }
+            else {
+                pyramid.push_back(image);
+            }
+        }
+
+        // Extend the cached pyramid from its coarsest level
+        while (static_cast<int>(pyramid.size()) <= levels &&
+            std::min(pyramid.back().rows, pyramid.back().cols) > 1) {
+            cv::Mat level;
+            cv::pyrDown(pyramid.back(), level);
+            pyramid.push_back(level);
+        }
+
+        const size_t count = std::min(pyramid.size(), static_cast<size_t>(std::max(levels, 0)) + 1);
+        return std::vector<cv::Mat>(pyramid.begin(), pyramid.begin() + count);
+    }
+
+    void BaseNode::clearDerivedOutputs() {
+        std::lock_guard<std::mutex> lock(m_derivedMutex);
+        m_derivedOutputs.clear();
+        m_outputPyramids.clear();
+    }
+
+    cv::Rect BaseNode::getRequestedRegion() const {
+        return m_requestedRegion;
+    }
+
+    int BaseNode::getRegionMargin(int inputIndex) const {
+        return WHOLE_IMAGE_MARGIN;
+    }
+
+    bool BaseNode::isRegionExact() const {
+        return true;
+    }
+
+    cv::Rect BaseNode::getSinkRegion() const {
+        return cv::Rect();
+    }
+
+    bool BaseNode::isCacheable() const {
+        return true;
+    }
+
+    void BaseNode::hashCacheState(ContentHasher& hasher) const {
+    }
+
+    bool BaseNode::filterRequestedRegion(const cv::Mat& input, cv::Mat& output, int margin,
+        const std::function<void(const cv::Mat&, cv::Mat&)>& filter) const {
+        const cv::Rect frame(0, 0, input.cols, input.rows);
+        const cv::Rect region = m_requestedRegion & frame;
+        if (margin < 0 || region.empty() || region == frame) {
+            return false;
+        }
+
+        // Filter the region with the pixels its margin reaches; at the image
+        // borders the view ends where the image does, so border handling is unchanged
+        const cv::Rect source = cv::Rect(region.x - margin, region.y - margin,
+            region.width + 2 * margin, region.height + 2 * margin) & frame;
+        cv::Mat filtered;
+        filter(input(source), filtered);
+        if (filtered.size() != source.size()) {
+            std::cerr << "BaseNode::filterRequestedRegion: Node " << m_name << " filtered the region to a different size." << std::endl;
+            return false;
+        }
+
+        cv::Mat result(input.size(), filtered.type());
+        cv::Mat target = result(region);
+        filtered(region - source.tl()).copyTo(target);
+        output = result;
+        return true;
+    }
+
+    ParameterMap BaseNode::getParameters() const {
+        return {};
+    }
+
+    bool BaseNode::setParameter(const std::string& name, const ParameterValue& value) {
+        return false;
+    }
+
+    bool BaseNode::setParameters(const ParameterMap& parameters) {
+        bool success = true;
+        for (const auto& parameter : parameters) {
+            if (!setParameter(parameter.first, parameter.second)) {
+                std::cerr << "BaseNode::setParameters: Node " << m_name << " rejected parameter '" << parameter.first << "'." << std::endl;
+                success = false;
+            }
+        }
+        return success;
+    }
+
+    BaseNode* BaseNode::clone() const {
+        return NodeRegistry::instance().cloneNode(*this);
     }
 
-}
\ No newline at end of file
+}
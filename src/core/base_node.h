@@ -4,10 +4,26 @@
 #include <vector>
 #include <memory>
 #include <unordered_map>
+#include <atomic>
+#include <array>
+#include <mutex>
+#include <functional>
+#include <cstdint>
 #include <opencv2/opencv.hpp>
+#include "node_parameters.h"
+#include "port_value.h"
 
 namespace image_processor {
+    // Representations derived from an output image and cached on its producer
+    enum class DerivedFormat {
+        GRAY,    // Single channel (BGR or BGRA converted to gray; CV_32F for half-float images)
+        FLOAT,   // CV_32F with the same channels and unscaled values
+        PLANAR   // Channel planes stacked vertically in one single-channel matrix
+    };
+
     class Image;
+    class NodeGraph;
+    class ContentHasher;
     class BaseNode {
     public:
         BaseNode(const std::string& name);
@@ -17,6 +33,10 @@ namespace image_processor {
         void setName(const std::string& name);
         int getId() const;
 
+        // Dense index of the node within its graph (0..nodeCount-1), or -1 if
+        // the node is not in a graph. Indices are compacted when a node is removed.
+        int getGraphIndex() const;
+
         bool connectOutput(int outputIndex, BaseNode* targetNode, int inputIndex);
         bool disconnectOutput(int outputIndex, BaseNode* targetNode, int inputIndex);
 
@@ -35,10 +55,96 @@ namespace image_processor {
         virtual bool setInputValue(int inputIndex, const cv::Mat& value);
         virtual cv::Mat getOutputValue(int outputIndex) const;
 
+        // Typed port access. getOutputValue returns the matrix of a port value
+        // and an empty Mat for scalar outputs.
+        PortValue getOutputPortValue(int outputIndex) const;
+        PortValue getInputPortValue(int inputIndex) const;
+
+        // Version of an output, drawn from a counter shared by all nodes each
+        // time the output is set, or 0 if it was never set. An output with an
+        // unchanged version holds the same value, so consumers can key work
+        // derived from an input on it.
+        uint64_t getOutputVersion(int outputIndex) const;
+
+        // Port types (IMAGE by default). Optional inputs may stay unconnected.
+        virtual PortType getInputType(int index) const;
+        virtual PortType getOutputType(int index) const;
+        virtual bool isInputOptional(int index) const;
+
+        // Stable type identifier used by graph files (e.g. "BlurNode")
+        virtual std::string getTypeName() const = 0;
+
+        // Parameter reflection used to save and restore node configuration
+        virtual ParameterMap getParameters() const;
+        virtual bool setParameter(const std::string& name, const ParameterValue& value);
+        bool setParameters(const ParameterMap& parameters);
+
+        // Derived representation of an output, computed on first request and
+        // shared read-only by every consumer until the output is set again.
+        // Returns the output itself when it already has the requested form.
+        cv::Mat getDerivedOutput(int outputIndex, DerivedFormat format) const;
+        cv::Mat getDerivedInput(int inputIndex, DerivedFormat format) const;
+
+        // Gaussian pyramid of an output, or of one of its derived forms, built
+        // on first request and cached like the derived representations. Level
+        // 0 is the image and each further level halves its size (cv::pyrDown).
+        // Asking for more levels extends the cached pyramid. Half-float images
+        // give CV_32F levels. Stops early when a level is a single pixel wide.
+        std::vector<cv::Mat> getOutputPyramid(int outputIndex, int levels) const;
+        std::vector<cv::Mat> getOutputPyramid(int outputIndex, int levels, DerivedFormat format) const;
+        std::vector<cv::Mat> getInputPyramid(int inputIndex, int levels) const;
+        std::vector<cv::Mat> getInputPyramid(int inputIndex, int levels, DerivedFormat format) const;
+
+        // Drop the derived representations and pyramids of all outputs
+        void clearDerivedOutputs();
+
+        // Region of interest propagation. Before each run the graph sets on
+        // every node the part of its outputs its consumers read, in the pixel
+        // coordinates of the image (an empty rectangle for the whole image).
+        // A consumer reads the region it was asked for grown by its margin for
+        // the input, so the requests travel from the sinks back to the sources.
+        // Nodes that compute only the requested region leave the rest of their
+        // outputs undefined.
+        static constexpr int WHOLE_IMAGE_MARGIN = -1;
+        cv::Rect getRequestedRegion() const;
+
+        // Pixels around each output pixel that it depends on in an input, or
+        // WHOLE_IMAGE_MARGIN if it may depend on any pixel (the default, which
+        // is always correct). Nodes that override it must honour the requested
+        // region in process(), for example with filterRequestedRegion.
+        virtual int getRegionMargin(int inputIndex) const;
+
+        // Whether a requested region holds the same pixels as the whole image
+        // would (the default). Nodes whose margin only cuts off an influence
+        // that reaches further, or whose whole-image path takes a different
+        // route, such as a coarse pyramid level, return false.
+        virtual bool isRegionExact() const;
+
+        // Region a node without consumers needs (empty for the whole image)
+        virtual cv::Rect getSinkRegion() const;
+
+        // Result cache support (see NodeGraph::setResultCache). A node is
+        // cacheable when its outputs depend only on its inputs, its type and
+        // its parameters; nodes with random or external state return false.
+        virtual bool isCacheable() const;
+
+        // Add state that affects the outputs but is not in the parameters,
+        // such as an image fed directly, to the cache key of the node
+        virtual void hashCacheState(ContentHasher& hasher) const;
+
+        // Create an unconnected copy with the same type, name and parameters.
+        // Output values are per-run state and are not copied.
+        virtual BaseNode* clone() const;
+
     protected:
+        // Copies the name only; the copy gets a new ID and no connections or outputs
+        BaseNode(const BaseNode& other);
+        BaseNode& operator=(const BaseNode&) = delete;
+
         std::string m_name;                  // Node name
         int m_id;                            // Unique node ID
-        static int s_nextId;                 // Static counter for generating unique IDs
+        int m_graphIndex;                    // Index within the owning graph, -1 if none
+        static std::atomic<int> s_nextId;    // Lock-free counter for generating unique IDs
 
         // Maps input index to (source node, output index)
         std::unordered_map<int, std::pair<BaseNode*, int>> m_inputs;
@@ -46,8 +152,48 @@ namespace image_processor {
         // Maps output index to vector of (target node, input index)
         std::unordered_map<int, std::vector<std::pair<BaseNode*, int>>> m_outputs;
 
+        // Store the value of an output after processing and give it a new
+        // version. Consumers share the matrix and key caches on the version,
+        // so it must not be modified afterwards; store a new matrix instead.
+        void setOutputValue(int outputIndex, const PortValue& value);
+
         // Output values stored after processing
-        std::unordered_map<int, cv::Mat> m_outputValues;
+        std::unordered_map<int, PortValue> m_outputValues;
+
+        // Compute only the requested region of an output. The filter receives a
+        // view of the input covering the region grown by margin (clipped to the
+        // image) and returns an image of the size of the view; its part under
+        // the region is copied into an output of the input size whose other
+        // pixels are left uninitialized. Returns false, without calling the
+        // filter, when the whole image is requested or margin is
+        // WHOLE_IMAGE_MARGIN, so the caller falls back to the full image.
+        bool filterRequestedRegion(const cv::Mat& input, cv::Mat& output, int margin,
+            const std::function<void(const cv::Mat&, cv::Mat&)>& filter) const;
+
+        // Convert an image to a derived representation, the conversion
+        // getDerivedOutput caches. Returns the image itself when it already
+        // has the requested form.
+        static cv::Mat deriveImage(const cv::Mat& image, DerivedFormat format);
+
+    private:
+        // Version of each output value (see getOutputVersion)
+        std::unordered_map<int, uint64_t> m_outputVersions;
+        static std::atomic<uint64_t> s_nextOutputVersion;
+
+        // Derived representations per output, indexed by DerivedFormat. Consumers
+        // may request them concurrently, so access is guarded by m_derivedMutex.
+        mutable std::unordered_map<int, std::array<cv::Mat, 3>> m_derivedOutputs;
+        mutable std::mutex m_derivedMutex;
+
+        // Pyramids per output, indexed by DerivedFormat with the output itself
+        // in the last slot. Guarded by m_derivedMutex as well.
+        mutable std::unordered_map<int, std::array<std::vector<cv::Mat>, 4>> m_outputPyramids;
+
+        std::vector<cv::Mat> getPyramid(int outputIndex, const cv::Mat& image, int slot, int levels) const;
+
+        cv::Rect m_requestedRegion;  // Part of the outputs consumers read, empty for all
+
+        friend class NodeGraph;  // Assigns m_graphIndex and m_requestedRegion
     };
 
 }
@@ -0,0 +1,887 @@
+#include "graph_serializer.h"
+#include "node_registry.h"
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iterator>
+#include <unordered_map>
+#include <cstring>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <cerrno>
+#include <climits>
+
+namespace image_processor {
+
+    // Binary format constants
+    static const char BINARY_MAGIC[4] = { 'N', 'G', 'R', 'B' };
+    static const uint32_t BINARY_VERSION = 1;
+    static const int TEXT_VERSION = 1;
+
+    // Type tags for parameter values in the binary format
+    enum BinaryValueTag : uint8_t {
+        TAG_INT = 0,
+        TAG_DOUBLE = 1,
+        TAG_BOOL = 2,
+        TAG_STRING = 3,
+        TAG_MATRIX = 4
+    };
+
+    // Names of the matrix depths in the text format, indexed by CV_8U ... CV_16F
+    static const char* const MATRIX_DEPTH_NAMES[] = { "8U", "8S", "16U", "16S", "32S", "32F", "64F", "16F" };
+    static const int MATRIX_DEPTH_COUNT = sizeof(MATRIX_DEPTH_NAMES) / sizeof(MATRIX_DEPTH_NAMES[0]);
+
+    // Text format helpers
+
+    static std::string quoteString(const std::string& value) {
+        std::string result = "\"";
+        for (char c : value) {
+            if (c == '"' || c == '\\') {
+                result += '\\';
+                result += c;
+            }
+            else if (c == '\n') {
+                result += "\\n";
+            }
+            else {
+                result += c;
+            }
+        }
+        result += '"';
+        return result;
+    }
+
+    static std::string formatDouble(double value) {
+        std::ostringstream stream;
+        stream.imbue(std::locale::classic());
+        stream.precision(17);
+        stream << value;
+
+        // Make sure the value reads back as a double rather than an int
+        std::string text = stream.str();
+        if (text.find_first_of(".eEn") == std::string::npos) {
+            text += ".0";
+        }
+        return text;
+    }
+
+    static std::string formatValue(const ParameterValue& value) {
+        if (const int* i = std::get_if<int>(&value)) {
+            return std::to_string(*i);
+        }
+        if (const double* d = std::get_if<double>(&value)) {
+            return formatDouble(*d);
+        }
+        if (const bool* b = std::get_if<bool>(&value)) {
+            return *b ? "true" : "false";
+        }
+        if (const std::string* s = std::get_if<std::string>(&value)) {
+            return quoteString(*s);
+        }
+
+        // Written as [rows x cols x channels depth: v0 v1 ...] with the
+        // channels of each element in turn; one channel is left out
+        const cv::Mat& matrix = std::get<cv::Mat>(value);
+        const int channels = matrix.channels();
+        cv::Mat values;
+        matrix.convertTo(values, CV_MAKETYPE(CV_64F, channels));
+
+        std::string text = "[" + std::to_string(values.rows) + "x" + std::to_string(values.cols);
+        if (channels > 1) {
+            text += "x" + std::to_string(channels);
+        }
+        text += " " + std::string(MATRIX_DEPTH_NAMES[matrix.depth()]) + ":";
+        for (int y = 0; y < values.rows; ++y) {
+            const double* row = values.ptr<double>(y);
+            for (int i = 0; i < values.cols * channels; ++i) {
+                text += " " + formatDouble(row[i]);
+            }
+        }
+        text += "]";
+        return text;
+    }
+
+    static std::string formatPort(int index, const std::string& name) {
+        return index >= 0 ? std::to_string(index) : quoteString(name);
+    }
+
+    /**
+     * Split a line into whitespace separated tokens. Quoted strings and
+     * bracketed matrices may contain whitespace; '#' outside of them starts
+     * a comment.
+     */
+    static bool tokenizeLine(const std::string& line, std::vector<std::string>& tokens) {
+        tokens.clear();
+        size_t pos = 0;
+
+        while (pos < line.size()) {
+            while (pos < line.size() && std::isspace(static_cast<unsigned char>(line[pos]))) {
+                ++pos;
+            }
+            if (pos >= line.size() || line[pos] == '#') {
+                break;
+            }
+
+            std::string token;
+            while (pos < line.size() && !std::isspace(static_cast<unsigned char>(line[pos]))) {
+                char c = line[pos];
+                if (c == '"') {
+                    // Copy the quoted section verbatim, including escapes
+                    token += c;
+                    ++pos;
+                    while (pos < line.size() && line[pos] != '"') {
+                        if (line[pos] == '\\' && pos + 1 < line.size()) {
+                            token += line[pos++];
+                        }
+                        token += line[pos++];
+                    }
+                    if (pos >= line.size()) {
+                        return false; // Unterminated string
+                    }
+                    token += line[pos++];
+                }
+                else if (c == '[') {
+                    size_t end = line.find(']', pos);
+                    if (end == std::string::npos) {
+                        return false; // Unterminated matrix
+                    }
+                    token += line.substr(pos, end - pos + 1);
+                    pos = end + 1;
+                }
+                else {
+                    token += c;
+                    ++pos;
+                }
+            }
+            tokens.push_back(token);
+        }
+
+        return true;
+    }
+
+    static bool unquoteString(const std::string& token, std::string& result) {
+        if (token.size() < 2 || token.front() != '"' || token.back() != '"') {
+            return false;
+        }
+
+        result.clear();
+        for (size_t i = 1; i + 1 < token.size(); ++i) {
+            if (token[i] == '\\' && i + 2 < token.size()) {
+                ++i;
+                result += token[i] == 'n' ? '\n' : token[i];
+            }
+            else {
+                result += token[i];
+            }
+        }
+        return true;
+    }
+
+    static bool parseInt(const std::string& text, int& result) {
+        if (text.empty()) {
+            return false;
+        }
+
+        char* end = nullptr;
+        errno = 0;
+        long value = std::strtol(text.c_str(), &end, 10);
+        if (*end != '\0' || errno == ERANGE || value < INT_MIN || value > INT_MAX) {
+            return false;
+        }
+
+        result = static_cast<int>(value);
+        return true;
+    }
+
+    static bool parseDouble(const std::string& text, double& result) {
+        if (text.empty()) {
+            return false;
+        }
+
+        std::istringstream stream(text);
+        stream.imbue(std::locale::classic());
+        stream >> result;
+        return !stream.fail() && stream.eof();
+    }
+
+    static bool parseMatrix(const std::string& text, cv::Mat& result) {
+        // Expected form: [rows x cols x channels depth: v0 v1 ...]; the
+        // channel count defaults to 1 and the depth to 32F
+        size_t colon = text.find(':');
+        if (text.size() < 2 || text.front() != '[' || text.back() != ']' || colon == std::string::npos) {
+            return false;
+        }
+
+        std::istringstream header(text.substr(1, colon - 1));
+        std::string shape;
+        std::string depthName;
+        std::string rest;
+        if (!(header >> shape) || ((header >> depthName) && (header >> rest))) {
+            return false;
+        }
+
+        int depth = CV_32F;
+        if (!depthName.empty()) {
+            const char* const* found = std::find(MATRIX_DEPTH_NAMES, MATRIX_DEPTH_NAMES + MATRIX_DEPTH_COUNT, depthName);
+            if (found == MATRIX_DEPTH_NAMES + MATRIX_DEPTH_COUNT) {
+                return false;
+            }
+            depth = static_cast<int>(found - MATRIX_DEPTH_NAMES);
+        }
+
+        std::vector<int> sizes;
+        size_t start = 0;
+        while (true) {
+            size_t separator = shape.find('x', start);
+            int size = 0;
+            if (!parseInt(shape.substr(start, separator - start), size) || size <= 0) {
+                return false;
+            }
+            sizes.push_back(size);
+            if (separator == std::string::npos) {
+                break;
+            }
+            start = separator + 1;
+        }
+        if (sizes.size() < 2 || sizes.size() > 3) {
+            return false;
+        }
+
+        const int rows = sizes[0];
+        const int cols = sizes[1];
+        const int channels = sizes.size() == 3 ? sizes[2] : 1;
+
+        // Every value takes at least two characters, which bounds the
+        // allocation by the length of the text
+        if (channels > CV_CN_MAX ||
+            static_cast<uint64_t>(rows) * cols * channels > text.size() / 2) {
+            return false;
+        }
+
+        std::istringstream stream(text.substr(colon + 1, text.size() - colon - 2));
+        stream.imbue(std::locale::classic());
+
+        cv::Mat values(rows, cols, CV_MAKETYPE(CV_64F, channels));
+        for (int y = 0; y < rows; ++y) {
+            double* row = values.ptr<double>(y);
+            for (int i = 0; i < cols * channels; ++i) {
+                if (!(stream >> row[i])) {
+                    return false;
+                }
+            }
+        }
+
+        if (stream >> rest) {
+            return false;
+        }
+
+        values.convertTo(result, CV_MAKETYPE(depth, channels));
+        return true;
+    }
+
+    static bool parseValue(const std::string& text, ParameterValue& value) {
+        if (text.empty()) {
+            return false;
+        }
+
+        if (text.front() == '"') {
+            std::string s;
+            if (!unquoteString(text, s)) {
+                return false;
+            }
+            value = s;
+            return true;
+        }
+
+        if (text.front() == '[') {
+            cv::Mat matrix;
+            if (!parseMatrix(text, matrix)) {
+                return false;
+            }
+            value = matrix;
+            return true;
+        }
+
+        if (text == "true" || text == "false") {
+            value = (text == "true");
+            return true;
+        }
+
+        int intValue = 0;
+        if (parseInt(text, intValue)) {
+            value = intValue;
+            return true;
+        }
+
+        double doubleValue = 0.0;
+        if (parseDouble(text, doubleValue)) {
+            value = doubleValue;
+            return true;
+        }
+
+        // Bare words are strings, typically enum names such as GAUSSIAN
+        value = text;
+        return true;
+    }
+
+    static bool parsePort(const std::string& text, int& index, std::string& name) {
+        if (!text.empty() && text.front() == '"') {
+            index = -1;
+            return unquoteString(text, name);
+        }
+        name.clear();
+        return parseInt(text, index) && index >= 0;
+    }
+
+    // Binary format helpers
+
+    class BinaryWriter {
+    public:
+        explicit BinaryWriter(std::vector<char>& buffer) : m_buffer(buffer) {}
+
+        void writeBytes(const void* data, size_t size) {
+            const char* bytes = static_cast<const char*>(data);
+            m_buffer.insert(m_buffer.end(), bytes, bytes + size);
+        }
+
+        template <typename T>
+        void write(T value) {
+            writeBytes(&value, sizeof(T));
+        }
+
+        void writeString(const std::string& value) {
+            write<uint32_t>(static_cast<uint32_t>(value.size()));
+            writeBytes(value.data(), value.size());
+        }
+
+    private:
+        std::vector<char>& m_buffer;
+    };
+
+    class BinaryReader {
+    public:
+        BinaryReader(const std::vector<char>& buffer) : m_buffer(buffer), m_offset(0) {}
+
+        bool readBytes(void* data, size_t size) {
+            if (size > m_buffer.size() - m_offset) {
+                return false;
+            }
+            std::memcpy(data, m_buffer.data() + m_offset, size);
+            m_offset += size;
+            return true;
+        }
+
+        template <typename T>
+        bool read(T& value) {
+            return readBytes(&value, sizeof(T));
+        }
+
+        bool readString(std::string& value) {
+            uint32_t size = 0;
+            if (!read(size) || size > m_buffer.size() - m_offset) {
+                return false;
+            }
+            value.assign(m_buffer.data() + m_offset, size);
+            m_offset += size;
+            return true;
+        }
+
+        bool atEnd() const {
+            return m_offset == m_buffer.size();
+        }
+
+        size_t remaining() const {
+            return m_buffer.size() - m_offset;
+        }
+
+    private:
+        const std::vector<char>& m_buffer;
+        size_t m_offset;
+    };
+
+    static void writeBinaryValue(BinaryWriter& writer, const ParameterValue& value) {
+        if (const int* i = std::get_if<int>(&value)) {
+            writer.write<uint8_t>(TAG_INT);
+            writer.write<int32_t>(*i);
+        }
+        else if (const double* d = std::get_if<double>(&value)) {
+            writer.write<uint8_t>(TAG_DOUBLE);
+            writer.write<double>(*d);
+        }
+        else if (const bool* b = std::get_if<bool>(&value)) {
+            writer.write<uint8_t>(TAG_BOOL);
+            writer.write<uint8_t>(*b ? 1 : 0);
+        }
+        else if (const std::string* s = std::get_if<std::string>(&value)) {
+            writer.write<uint8_t>(TAG_STRING);
+            writer.writeString(*s);
+        }
+        else {
+            const cv::Mat& matrix = std::get<cv::Mat>(value);
+            writer.write<uint8_t>(TAG_MATRIX);
+            writer.write<int32_t>(matrix.rows);
+            writer.write<int32_t>(matrix.cols);
+            writer.write<int32_t>(matrix.type());
+            size_t rowBytes = matrix.cols * matrix.elemSize();
+            for (int y = 0; y < matrix.rows; ++y) {
+                writer.writeBytes(matrix.ptr(y), rowBytes);
+            }
+        }
+    }
+
+    static bool readBinaryValue(BinaryReader& reader, ParameterValue& value) {
+        uint8_t tag = 0;
+        if (!reader.read(tag)) {
+            return false;
+        }
+
+        switch (tag) {
+        case TAG_INT: {
+            int32_t i = 0;
+            if (!reader.read(i)) {
+                return false;
+            }
+            value = static_cast<int>(i);
+            return true;
+        }
+
+        case TAG_DOUBLE: {
+            double d = 0.0;
+            if (!reader.read(d)) {
+                return false;
+            }
+            value = d;
+            return true;
+        }
+
+        case TAG_BOOL: {
+            uint8_t b = 0;
+            if (!reader.read(b)) {
+                return false;
+            }
+            value = (b != 0);
+            return true;
+        }
+
+        case TAG_STRING: {
+            std::string s;
+            if (!reader.readString(s)) {
+                return false;
+            }
+            value = s;
+            return true;
+        }
+
+        case TAG_MATRIX: {
+            int32_t rows = 0;
+            int32_t cols = 0;
+            int32_t type = 0;
+            if (!reader.read(rows) || !reader.read(cols) || !reader.read(type) ||
+                rows <= 0 || cols <= 0 || type < 0 || type != CV_MAT_TYPE(type) || CV_MAT_DEPTH(type) > CV_64F) {
+                return false;
+            }
+
+            // The data must be in the buffer before the matrix is allocated
+            const uint64_t elements = static_cast<uint64_t>(rows) * static_cast<uint64_t>(cols);
+            if (elements > reader.remaining() / CV_ELEM_SIZE(type)) {
+                return false;
+            }
+            cv::Mat matrix(rows, cols, type);
+            size_t rowBytes = matrix.cols * matrix.elemSize();
+            for (int y = 0; y < rows; ++y) {
+                if (!reader.readBytes(matrix.ptr(y), rowBytes)) {
+                    return false;
+                }
+            }
+            value = matrix;
+            return true;
+        }
+
+        default:
+            return false;
+        }
+    }
+
+    // Port resolution
+
+    static int findOutputIndex(const BaseNode* node, int index, const std::string& name) {
+        if (index >= 0) {
+            return index;
+        }
+        for (int i = 0; i < node->getOutputCount(); ++i) {
+            if (node->getOutputName(i) == name) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    static int findInputIndex(const BaseNode* node, int index, const std::string& name) {
+        if (index >= 0) {
+            return index;
+        }
+        for (int i = 0; i < node->getInputCount(); ++i) {
+            if (node->getInputName(i) == name) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    // GraphSerializer
+
+    void GraphSerializer::describeGraph(const NodeGraph& graph, GraphDescription& description) {
+        description.nodes.clear();
+        description.connections.clear();
+
+        std::vector<BaseNode*> nodes = graph.getAllNodes();
+        std::unordered_map<const BaseNode*, int> nodeIndices;
+
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            nodeIndices[nodes[i]] = static_cast<int>(i);
+
+            NodeDescription node;
+            node.typeName = nodes[i]->getTypeName();
+            node.name = nodes[i]->getName();
+            node.parameters = nodes[i]->getParameters();
+            description.nodes.push_back(node);
+        }
+
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            for (int outputIndex = 0; outputIndex < nodes[i]->getOutputCount(); ++outputIndex) {
+                for (const auto& connection : nodes[i]->getConnectedNodes(outputIndex)) {
+                    auto target = nodeIndices.find(connection.first);
+                    if (target == nodeIndices.end()) {
+                        continue; // Connected to a node outside this graph
+                    }
+
+                    ConnectionDescription edge;
+                    edge.sourceNode = static_cast<int>(i);
+                    edge.outputIndex = outputIndex;
+                    edge.targetNode = target->second;
+                    edge.inputIndex = connection.second;
+                    description.connections.push_back(edge);
+                }
+            }
+        }
+    }
+
+    bool GraphSerializer::buildGraph(const GraphDescription& description, NodeGraph& graph) {
+        std::vector<BaseNode*> nodes;
+
+        // Create and configure every node before touching the graph
+        for (const NodeDescription& nodeDescription : description.nodes) {
+            BaseNode* node = NodeRegistry::instance().createNode(nodeDescription.typeName, nodeDescription.name);
+            if (!node) {
+                std::cerr << "GraphSerializer::buildGraph: Unknown node type '" << nodeDescription.typeName << "'." << std::endl;
+            }
+            else if (!node->setParameters(nodeDescription.parameters)) {
+                std::cerr << "GraphSerializer::buildGraph: Invalid parameters for node '" << nodeDescription.name << "'." << std::endl;
+                delete node;
+                node = nullptr;
+            }
+
+            if (!node) {
+                for (BaseNode* created : nodes) {
+                    delete created;
+                }
+                return false;
+            }
+            nodes.push_back(node);
+        }
+
+        for (BaseNode* node : nodes) {
+            graph.addNode(node);
+        }
+
+        // Connect the nodes, rolling back the whole description on failure
+        for (const ConnectionDescription& connection : description.connections) {
+            bool success = false;
+
+            if (connection.sourceNode >= 0 && connection.sourceNode < static_cast<int>(nodes.size()) &&
+                connection.targetNode >= 0 && connection.targetNode < static_cast<int>(nodes.size())) {
+                BaseNode* source = nodes[connection.sourceNode];
+                BaseNode* target = nodes[connection.targetNode];
+                int outputIndex = findOutputIndex(source, connection.outputIndex, connection.outputName);
+                int inputIndex = findInputIndex(target, connection.inputIndex, connection.inputName);
+
+                success = outputIndex >= 0 && inputIndex >= 0 &&
+                    graph.connectNodes(source->getId(), outputIndex, target->getId(), inputIndex);
+            }
+
+            if (!success) {
+                std::cerr << "GraphSerializer::buildGraph: Invalid connection from node " << connection.sourceNode
+                    << " to node " << connection.targetNode << "." << std::endl;
+                for (BaseNode* node : nodes) {
+                    graph.removeNode(node->getId());
+                }
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    std::string GraphSerializer::toText(const GraphDescription& description) {
+        std::string text = "# node-based-image-processor graph\n";
+        text += "graph " + std::to_string(TEXT_VERSION) + "\n";
+
+        for (size_t i = 0; i < description.nodes.size(); ++i) {
+            const NodeDescription& node = description.nodes[i];
+            text += "node " + std::to_string(i) + " " + node.typeName + " " + quoteString(node.name);
+            for (const auto& parameter : node.parameters) {
+                text += " " + parameter.first + "=" + formatValue(parameter.second);
+            }
+            text += "\n";
+        }
+
+        for (const ConnectionDescription& connection : description.connections) {
+            text += "connect " + std::to_string(connection.sourceNode) + " " +
+                formatPort(connection.outputIndex, connection.outputName) + " " +
+                std::to_string(connection.targetNode) + " " +
+                formatPort(connection.inputIndex, connection.inputName) + "\n";
+        }
+
+        return text;
+    }
+
+    bool GraphSerializer::fromText(const std::string& text, GraphDescription& description) {
+        description.nodes.clear();
+        description.connections.clear();
+
+        std::unordered_map<std::string, int> nodeKeys;
+        std::istringstream stream(text);
+        std::string line;
+        std::vector<std::string> tokens;
+        int lineNumber = 0;
+
+        while (std::getline(stream, line)) {
+            ++lineNumber;
+
+            if (!tokenizeLine(line, tokens)) {
+                std::cerr << "GraphSerializer::fromText: Unterminated value on line " << lineNumber << "." << std::endl;
+                return false;
+            }
+            if (tokens.empty()) {
+                continue;
+            }
+
+            if (tokens[0] == "graph") {
+                int version = 0;
+                if (tokens.size() != 2 || !parseInt(tokens[1], version) || version != TEXT_VERSION) {
+                    std::cerr << "GraphSerializer::fromText: Unsupported graph version on line " << lineNumber << "." << std::endl;
+                    return false;
+                }
+            }
+            else if (tokens[0] == "node") {
+                NodeDescription node;
+                if (tokens.size() < 4 || !unquoteString(tokens[3], node.name)) {
+                    std::cerr << "GraphSerializer::fromText: Expected 'node <key> <type> \"<name>\"' on line " << lineNumber << "." << std::endl;
+                    return false;
+                }
+                if (nodeKeys.count(tokens[1])) {
+                    std::cerr << "GraphSerializer::fromText: Duplicate node key '" << tokens[1] << "' on line " << lineNumber << "." << std::endl;
+                    return false;
+                }
+                node.typeName = tokens[2];
+
+                for (size_t i = 4; i < tokens.size(); ++i) {
+                    size_t equals = tokens[i].find('=');
+                    ParameterValue value;
+                    if (equals == std::string::npos || equals == 0 ||
+                        !parseValue(tokens[i].substr(equals + 1), value)) {
+                        std::cerr << "GraphSerializer::fromText: Invalid parameter '" << tokens[i] << "' on line " << lineNumber << "." << std::endl;
+                        return false;
+                    }
+                    node.parameters[tokens[i].substr(0, equals)] = value;
+                }
+
+                nodeKeys[tokens[1]] = static_cast<int>(description.nodes.size());
+                description.nodes.push_back(node);
+            }
+            else if (tokens[0] == "connect") {
+                ConnectionDescription connection;
+                if (tokens.size() != 5 ||
+                    !nodeKeys.count(tokens[1]) || !nodeKeys.count(tokens[3]) ||
+                    !parsePort(tokens[2], connection.outputIndex, connection.outputName) ||
+                    !parsePort(tokens[4], connection.inputIndex, connection.inputName)) {
+                    std::cerr << "GraphSerializer::fromText: Expected 'connect <node> <output> <node> <input>' with known nodes on line " << lineNumber << "." << std::endl;
+                    return false;
+                }
+                connection.sourceNode = nodeKeys[tokens[1]];
+                connection.targetNode = nodeKeys[tokens[3]];
+                description.connections.push_back(connection);
+            }
+            else {
+                std::cerr << "GraphSerializer::fromText: Unknown statement '" << tokens[0] << "' on line " << lineNumber << "." << std::endl;
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    std::vector<char> GraphSerializer::toBinary(const GraphDescription& description) {
+        std::vector<char> data;
+        BinaryWriter writer(data);
+
+        writer.writeBytes(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+        writer.write<uint32_t>(BINARY_VERSION);
+
+        writer.write<uint32_t>(static_cast<uint32_t>(description.nodes.size()));
+        for (const NodeDescription& node : description.nodes) {
+            writer.writeString(node.typeName);
+            writer.writeString(node.name);
+            writer.write<uint32_t>(static_cast<uint32_t>(node.parameters.size()));
+            for (const auto& parameter : node.parameters) {
+                writer.writeString(parameter.first);
+                writeBinaryValue(writer, parameter.second);
+            }
+        }
+
+        writer.write<uint32_t>(static_cast<uint32_t>(description.connections.size()));
+        for (const ConnectionDescription& connection : description.connections) {
+            writer.write<int32_t>(connection.sourceNode);
+            writer.write<int32_t>(connection.outputIndex);
+            writer.writeString(connection.outputName);
+            writer.write<int32_t>(connection.targetNode);
+            writer.write<int32_t>(connection.inputIndex);
+            writer.writeString(connection.inputName);
+        }
+
+        return data;
+    }
+
+    bool GraphSerializer::fromBinary(const std::vector<char>& data, GraphDescription& description) {
+        description.nodes.clear();
+        description.connections.clear();
+
+        BinaryReader reader(data);
+        char magic[sizeof(BINARY_MAGIC)];
+        uint32_t version = 0;
+        if (!reader.readBytes(magic, sizeof(magic)) || std::memcmp(magic, BINARY_MAGIC, sizeof(magic)) != 0 ||
+            !reader.read(version) || version != BINARY_VERSION) {
+            std::cerr << "GraphSerializer::fromBinary: Not a supported binary graph." << std::endl;
+            return false;
+        }
+
+        uint32_t nodeCount = 0;
+        if (!reader.read(nodeCount)) {
+            std::cerr << "GraphSerializer::fromBinary: Truncated node table." << std::endl;
+            return false;
+        }
+
+        for (uint32_t i = 0; i < nodeCount; ++i) {
+            NodeDescription node;
+            uint32_t parameterCount = 0;
+            if (!reader.readString(node.typeName) || !reader.readString(node.name) || !reader.read(parameterCount)) {
+                std::cerr << "GraphSerializer::fromBinary: Truncated node " << i << "." << std::endl;
+                return false;
+            }
+
+            for (uint32_t p = 0; p < parameterCount; ++p) {
+                std::string key;
+                ParameterValue value;
+                if (!reader.readString(key) || !readBinaryValue(reader, value)) {
+                    std::cerr << "GraphSerializer::fromBinary: Invalid parameter in node " << i << "." << std::endl;
+                    return false;
+                }
+                node.parameters[key] = value;
+            }
+
+            description.nodes.push_back(node);
+        }
+
+        uint32_t connectionCount = 0;
+        if (!reader.read(connectionCount)) {
+            std::cerr << "GraphSerializer::fromBinary: Truncated connection table." << std::endl;
+            return false;
+        }
+
+        for (uint32_t i = 0; i < connectionCount; ++i) {
+            ConnectionDescription connection;
+            int32_t sourceNode = 0;
+            int32_t outputIndex = 0;
+            int32_t targetNode = 0;
+            int32_t inputIndex = 0;
+            if (!reader.read(sourceNode) || !reader.read(outputIndex) || !reader.readString(connection.outputName) ||
+                !reader.read(targetNode) || !reader.read(inputIndex) || !reader.readString(connection.inputName)) {
+                std::cerr << "GraphSerializer::fromBinary: Truncated connection " << i << "." << std::endl;
+                return false;
+            }
+            if (sourceNode < 0 || sourceNode >= static_cast<int32_t>(nodeCount) ||
+                targetNode < 0 || targetNode >= static_cast<int32_t>(nodeCount)) {
+                std::cerr << "GraphSerializer::fromBinary: Connection " << i << " references an unknown node." << std::endl;
+                return false;
+            }
+
+            connection.sourceNode = sourceNode;
+            connection.outputIndex = outputIndex;
+            connection.targetNode = targetNode;
+            connection.inputIndex = inputIndex;
+            description.connections.push_back(connection);
+        }
+
+        if (!reader.atEnd()) {
+            std::cerr << "GraphSerializer::fromBinary: Unexpected trailing data." << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    bool GraphSerializer::saveText(const NodeGraph& graph, const std::string& filePath) {
+        GraphDescription description;
+        describeGraph(graph, description);
+
+        std::ofstream file(filePath, std::ios::binary);
+        if (!file) {
+            std::cerr << "GraphSerializer::saveText: Failed to open " << filePath << std::endl;
+            return false;
+        }
+
+        file << toText(description);
+        return static_cast<bool>(file);
+    }
+
+    bool GraphSerializer::saveBinary(const NodeGraph& graph, const std::string& filePath) {
+        GraphDescription description;
+        describeGraph(graph, description);
+        std::vector<char> data = toBinary(description);
+
+        std::ofstream file(filePath, std::ios::binary);
+        if (!file) {
+            std::cerr << "GraphSerializer::saveBinary: Failed to open " << filePath << std::endl;
+            return false;
+        }
+
+        file.write(data.data(), data.size());
+        return static_cast<bool>(file);
+    }
+
+    bool GraphSerializer::loadDescription(const std::string& filePath, GraphDescription& description) {
+        std::ifstream file(filePath, std::ios::binary);
+        if (!file) {
+            std::cerr << "GraphSerializer::loadDescription: Failed to open " << filePath << std::endl;
+            return false;
+        }
+
+        std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        if (data.size() >= sizeof(BINARY_MAGIC) && std::memcmp(data.data(), BINARY_MAGIC, sizeof(BINARY_MAGIC)) == 0) {
+            return fromBinary(data, description);
+        }
+        return fromText(std::string(data.begin(), data.end()), description);
+    }
+
+    bool GraphSerializer::load(const std::string& filePath, NodeGraph& graph) {
+        GraphDescription description;
+        if (!loadDescription(filePath, description)) {
+            return false;
+        }
+        return buildGraph(description, graph);
+    }
+
+}
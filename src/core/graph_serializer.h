@@ -0,0 +1,159 @@
+#pragma once
+
+#include "node_graph.h"
+#include "node_parameters.h"
+#include <string>
+#include <vector>
+
+namespace image_processor {
+
+    /**
+     * @brief Description of a single node in a graph file
+     */
+    struct NodeDescription {
+        std::string typeName;     // Stable type identifier (BaseNode::getTypeName)
+        std::string name;         // Display name of the node
+        ParameterMap parameters;  // Node parameters (BaseNode::getParameters)
+    };
+
+    /**
+     * @brief Description of a connection in a graph file
+     *
+     * Ports are identified either by index or, when the index is -1, by the
+     * name reported by getOutputName / getInputName.
+     */
+    struct ConnectionDescription {
+        int sourceNode = -1;      // Index into GraphDescription::nodes
+        int outputIndex = -1;     // Output port index on the source node
+        std::string outputName;   // Output port name, used when outputIndex is -1
+        int targetNode = -1;      // Index into GraphDescription::nodes
+        int inputIndex = -1;      // Input port index on the target node
+        std::string inputName;    // Input port name, used when inputIndex is -1
+    };
+
+    /**
+     * @brief In-memory form of a graph file
+     *
+     * A description can be parsed once and instantiated into any number of
+     * NodeGraph objects, which keeps hot-swapping pipelines cheap.
+     */
+    struct GraphDescription {
+        std::vector<NodeDescription> nodes;
+        std::vector<ConnectionDescription> connections;
+    };
+
+    /**
+     * @brief Reads and writes node graphs in a text or binary format
+     *
+     * Text format (one statement per line, '#' starts a comment):
+     *
+     *     graph 1
+     *     node 0 InputNode "Input" imagePath="input/input.jpg"
+     *     node 1 BlurNode "Blur" blurType=GAUSSIAN kernelSize=15 sigmaX=0.0
+     *     node 2 OutputNode "Output"
+     *     connect 0 0 1 "Image"
+     *     connect 1 0 2 0
+     *
+     * A node statement gives a key used by later connect statements, the node
+     * type, its quoted display name and any number of name=value parameters.
+     * Values are integers, decimals (containing '.' or an exponent), true/false,
+     * strings (quoted, or a bare word such as an enum name) and matrices
+     * written as [<rows>x<cols>x<channels> <depth>: v0 v1 ...] with the
+     * channels of each element in turn. The channel count may be left out
+     * for one channel, and the depth (8U, 8S, 16U, 16S, 32S, 32F, 64F or
+     * 16F) for CV_32F, so "[3x3: ...]" is a single-channel float matrix.
+     * A connect statement names the source key, output port, target key and
+     * input port; ports are given by index or by quoted port name.
+     *
+     * The binary format stores the same information length-prefixed in host
+     * byte order behind the "NGRB" magic, so loading needs no text parsing.
+     * Matrices keep their exact type in the binary form.
+     */
+    class GraphSerializer {
+    public:
+        /**
+         * @brief Capture the nodes, parameters and connections of a graph
+         * @param graph The graph to describe
+         * @param description Receives the description
+         */
+        static void describeGraph(const NodeGraph& graph, GraphDescription& description);
+
+        /**
+         * @brief Create the nodes and connections of a description in a graph
+         *
+         * Nodes are appended to the graph. If any node cannot be created or
+         * configured, or any connection fails, nothing is added.
+         *
+         * @param description The description to instantiate
+         * @param graph The graph to add the nodes to
+         * @return True if the whole description was instantiated, false otherwise
+         */
+        static bool buildGraph(const GraphDescription& description, NodeGraph& graph);
+
+        /**
+         * @brief Write a description in the text format
+         * @param description The description to write
+         * @return The text form of the description
+         */
+        static std::string toText(const GraphDescription& description);
+
+        /**
+         * @brief Parse a description from the text format
+         * @param text The text to parse
+         * @param description Receives the parsed description
+         * @return True if the text was parsed successfully, false otherwise
+         */
+        static bool fromText(const std::string& text, GraphDescription& description);
+
+        /**
+         * @brief Write a description in the binary format
+         * @param description The description to write
+         * @return The binary form of the description
+         */
+        static std::vector<char> toBinary(const GraphDescription& description);
+
+        /**
+         * @brief Parse a description from the binary format
+         * @param data The binary data to parse
+         * @param description Receives the parsed description
+         * @return True if the data was parsed successfully, false otherwise
+         */
+        static bool fromBinary(const std::vector<char>& data, GraphDescription& description);
+
+        /**
+         * @brief Save a graph to a file in the text format
+         * @param graph The graph to save
+         * @param filePath The path of the file to write
+         * @return True if the file was written successfully, false otherwise
+         */
+        static bool saveText(const NodeGraph& graph, const std::string& filePath);
+
+        /**
+         * @brief Save a graph to a file in the binary format
+         * @param graph The graph to save
+         * @param filePath The path of the file to write
+         * @return True if the file was written successfully, false otherwise
+         */
+        static bool saveBinary(const NodeGraph& graph, const std::string& filePath);
+
+        /**
+         * @brief Load a description from a text or binary file
+         *
+         * The format is detected from the file contents.
+         *
+         * @param filePath The path of the file to read
+         * @param description Receives the parsed description
+         * @return True if the file was loaded successfully, false otherwise
+         */
+        static bool loadDescription(const std::string& filePath, GraphDescription& description);
+
+        /**
+         * @brief Load a text or binary graph file into a graph
+         * @param filePath The path of the file to read
+         * @param graph The graph to add the loaded nodes to
+         * @return True if the file was loaded successfully, false otherwise
+         */
+        static bool load(const std::string& filePath, NodeGraph& graph);
+    };
+
+}
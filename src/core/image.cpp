@@ -1,4 +1,5 @@
 #include "image.h"
+#include "raw_image_file.h"
 #include <iostream>
 
 namespace image_processor {
@@ -33,6 +34,10 @@ namespace image_processor {
     }
 
     bool Image::load(const std::string& filePath) {
+        if (RawImageFile::isRawImage(filePath)) {
+            m_mat = cv::Mat();
+            return RawImageFile::map(filePath, m_mat);
+        }
         m_mat = cv::imread(filePath, cv::IMREAD_UNCHANGED);
         return !isEmpty();
     }
@@ -43,6 +48,10 @@ namespace image_processor {
             return false;
         }
 
+        if (RawImageFile::hasRawExtension(filePath)) {
+            return RawImageFile::save(filePath, m_mat);
+        }
+
         try {
             return cv::imwrite(filePath, m_mat);
         }
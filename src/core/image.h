@@ -67,6 +67,10 @@ namespace image_processor {
 
         /**
          * @brief Load an image from a file
+         *
+         * Raw image files (see RawImageFile) are memory mapped rather than
+         * read, whatever their extension.
+         *
          * @param filePath The path to the image file
          * @return True if the image was loaded successfully, false otherwise
          */
@@ -74,7 +78,8 @@ namespace image_processor {
 
         /**
          * @brief Save the image to a file
-         * @param filePath The path where the image should be saved
+         * @param filePath The path where the image should be saved; the ".ipr"
+         *        extension writes a raw image file, others choose an OpenCV codec
          * @return True if the image was saved successfully, false otherwise
          */
         bool save(const std::string& filePath) const;
@@ -0,0 +1,54 @@
+#include "image_strips.h"
+#include "raw_image_file.h"
+#include "tiff_image_file.h"
+#include <iostream>
+#include <thread>
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace image_processor {
+
+    std::unique_ptr<ImageStripReader> ImageStripReader::open(const std::string& filePath) {
+        if (RawImageFile::isRawImage(filePath)) {
+            return RawImageFile::openStrips(filePath);
+        }
+        if (TiffImageFile::isTiff(filePath)) {
+            return TiffImageFile::openStrips(filePath);
+        }
+
+        std::cerr << "ImageStripReader::open: " << filePath << " is neither a raw image file nor a TIFF file." << std::endl;
+        return nullptr;
+    }
+
+    std::unique_ptr<ImageStripWriter> ImageStripWriter::create(const std::string& filePath, cv::Size size, int type) {
+        if (size.width <= 0 || size.height <= 0) {
+            std::cerr << "ImageStripWriter::create: Cannot create an empty image." << std::endl;
+            return nullptr;
+        }
+        if (RawImageFile::hasRawExtension(filePath)) {
+            return RawImageFile::createStrips(filePath, size, type);
+        }
+        if (TiffImageFile::hasTiffExtension(filePath)) {
+            return TiffImageFile::createStrips(filePath, size, type);
+        }
+
+        std::cerr << "ImageStripWriter::create: " << filePath << " has neither a raw image (.ipr) nor a TIFF extension." << std::endl;
+        return nullptr;
+    }
+
+    std::filesystem::path temporaryPathFor(const std::filesystem::path& filePath) {
+#ifdef _WIN32
+        const long processId = _getpid();
+#else
+        const long processId = getpid();
+#endif
+        std::filesystem::path temporaryPath = filePath;
+        temporaryPath += "." + std::to_string(processId) + "." +
+            std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+        return temporaryPath;
+    }
+
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <filesystem>
+#include <memory>
+#include <string>
+
+namespace image_processor {
+
+    /**
+     * @brief Reads an image file a band of rows at a time
+     *
+     * For images too large to decode as a whole (see NodeGraph::processStreaming).
+     * Besides the rows asked for, a reader holds at most one strip or tile
+     * row of the file in memory.
+     */
+    class ImageStripReader {
+    public:
+        /**
+         * @brief Destructor
+         */
+        virtual ~ImageStripReader() = default;
+
+        /**
+         * @brief Get the size of the whole image
+         * @return The size in pixels
+         */
+        virtual cv::Size getSize() const = 0;
+
+        /**
+         * @brief Get the OpenCV type of the image
+         * @return The type, including the channel count
+         */
+        virtual int getType() const = 0;
+
+        /**
+         * @brief Read a band of rows
+         *
+         * Rows can be read in any order, but reading them from top to bottom
+         * decodes every strip or tile of the file only once.
+         *
+         * @param firstRow The first row to read
+         * @param rowCount The number of rows to read
+         * @param rows Receives the rows, the full width of the image
+         * @return True if the rows were read, false otherwise
+         */
+        virtual bool readRows(int firstRow, int rowCount, cv::Mat& rows) = 0;
+
+        /**
+         * @brief Open a raw image file (see RawImageFile) or a TIFF file
+         * @param filePath The path of the file; the format is taken from its content
+         * @return The reader, or nullptr if the file cannot be read by strips
+         */
+        static std::unique_ptr<ImageStripReader> open(const std::string& filePath);
+    };
+
+    /**
+     * @brief Writes an image file a band of rows at a time, from top to bottom
+     *
+     * The file is written under a temporary name and only appears under its
+     * own name once finish has succeeded. A writer destroyed before that
+     * deletes what it has written.
+     */
+    class ImageStripWriter {
+    public:
+        /**
+         * @brief Destructor
+         */
+        virtual ~ImageStripWriter() = default;
+
+        /**
+         * @brief Append a band of rows below the rows written so far
+         * @param rows The rows, the full width and the type of the image
+         * @return True if the rows were written, false otherwise
+         */
+        virtual bool writeRows(const cv::Mat& rows) = 0;
+
+        /**
+         * @brief Complete the file once every row has been written
+         * @return True if the file is complete, false otherwise
+         */
+        virtual bool finish() = 0;
+
+        /**
+         * @brief Create a raw image file (".ipr") or a TIFF file (".tif", ".tiff")
+         * @param filePath The path of the file; the format is taken from its extension
+         * @param size The size of the whole image
+         * @param type The OpenCV type of the image
+         * @return The writer, or nullptr if the file cannot be written by strips
+         */
+        static std::unique_ptr<ImageStripWriter> create(const std::string& filePath, cv::Size size, int type);
+    };
+
+    /**
+     * @brief Name to write a file under until it is complete
+     *
+     * The name includes the process and thread ids, so processes and threads
+     * writing the same file at the same time never share a temporary file.
+     *
+     * @param filePath The path of the complete file
+     * @return The path of the temporary file, next to the complete file
+     */
+    std::filesystem::path temporaryPathFor(const std::filesystem::path& filePath);
+
+}
@@ -1,10 +1,23 @@
 #include "input_node.h"
+#include "image.h"
+#include "node_registry.h"
+#include "result_cache.h"
 #include <iostream>
 
 namespace image_processor {
 
+    // Register the node type for graph files and dynamic construction
+    static NodeTypeRegistrar s_inputNodeRegistrar({
+        "InputNode",
+        "Input",
+        [](const std::string& name) -> BaseNode* { return new InputNode(name); },
+        {
+            { "imagePath", ParameterType::STRING, std::string(), "Image file to load (empty when fed with setImage)" }
+        }
+    });
+
     InputNode::InputNode(const std::string& name)
-        : BaseNode(name), m_currentImagePath("") {
+        : BaseNode(name), m_currentImagePath(""), m_imageChanged(false) {
     }
 
     void InputNode::process() {
@@ -13,8 +26,14 @@ namespace image_processor {
             return;
         }
 
-        // Simply pass the input image to the output
-        m_outputValues[0] = m_image.clone();
+        // Outputs are not modified once set, so the image is shared rather than
+        // copied. It is set again only when it changes, so the output version
+        // stays the same across runs and consumers can reuse work derived from
+        // it (e.g. BlendNode's converted blend image).
+        if (m_imageChanged || getOutputValue(0).empty()) {
+            setOutputValue(0, m_image);
+            m_imageChanged = false;
+        }
     }
 
     int InputNode::getInputCount() const {
@@ -36,15 +55,47 @@ namespace image_processor {
         return "";
     }
 
+    std::string InputNode::getTypeName() const {
+        return "InputNode";
+    }
+
+    BaseNode* InputNode::clone() const {
+        return new InputNode(*this);
+    }
+
+    void InputNode::hashCacheState(ContentHasher& hasher) const {
+        hasher.add(m_image);
+    }
+
+    ParameterMap InputNode::getParameters() const {
+        ParameterMap parameters;
+        parameters["imagePath"] = m_currentImagePath;
+        return parameters;
+    }
+
+    bool InputNode::setParameter(const std::string& name, const ParameterValue& value) {
+        if (name == "imagePath") {
+            std::string path;
+            if (!parameterToString(value, path)) {
+                return false;
+            }
+            // An empty path describes an input that is fed directly via setImage
+            return path.empty() || loadImage(path);
+        }
+        return false;
+    }
+
     bool InputNode::loadImage(const std::string& filePath) {
-        cv::Mat loadedImage = cv::imread(filePath, cv::IMREAD_UNCHANGED);
-        if (loadedImage.empty()) {
+        // Image maps raw image files instead of decoding them
+        Image loadedImage;
+        if (!loadedImage.load(filePath)) {
             std::cerr << "InputNode::loadImage: Failed to load image from " << filePath << std::endl;
             return false;
         }
 
-        m_image = loadedImage;
+        m_image = loadedImage.getMat();
         m_currentImagePath = filePath;
+        m_imageChanged = true;
 
         // Automatically process the node to update the output
         process();
@@ -60,6 +111,7 @@ namespace image_processor {
 
         m_image = image.clone();
         m_currentImagePath = ""; // Direct image input, no file path
+        m_imageChanged = true;
 
         // Automatically process the node to update the output
         process();
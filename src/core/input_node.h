@@ -25,7 +25,18 @@ namespace image_processor {
 
         virtual std::string getInputName(int index) const override;
         virtual std::string getOutputName(int index) const override;
+        virtual std::string getTypeName() const override;
 
+        virtual ParameterMap getParameters() const override;
+        virtual bool setParameter(const std::string& name, const ParameterValue& value) override;
+
+        // Copies share the image data and do not reload it from disk
+        virtual BaseNode* clone() const override;
+
+        // The image content is part of the cache key of everything downstream
+        virtual void hashCacheState(ContentHasher& hasher) const override;
+
+        // Raw image files (RawImageFile) are memory mapped, without a copy
         bool loadImage(const std::string& filePath);
         void setImage(const cv::Mat& image);
 
@@ -37,6 +48,7 @@ namespace image_processor {
     private:
         cv::Mat m_image;                     // The input image
         std::string m_currentImagePath;      // Path to the currently loaded image file (if any)
+        bool m_imageChanged;                 // m_image was replaced since the output was last set
     };
 
 }
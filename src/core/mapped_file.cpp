@@ -0,0 +1,114 @@
+#include "mapped_file.h"
+#include <filesystem>
+#include <limits>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace image_processor {
+
+    // Map the start of a file copy-on-write, so the image can be written to without touching the file
+    static unsigned char* mapFile(const std::string& filePath, size_t length) {
+#ifdef _WIN32
+        HANDLE file = CreateFileW(std::filesystem::path(filePath).c_str(), GENERIC_READ, FILE_SHARE_READ,
+            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return nullptr;
+        }
+        // The view keeps the file and the mapping object open by itself
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (mapping == nullptr) {
+            return nullptr;
+        }
+        void* address = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, length);
+        CloseHandle(mapping);
+        return static_cast<unsigned char*>(address);
+#else
+        int file = open(filePath.c_str(), O_RDONLY);
+        if (file < 0) {
+            return nullptr;
+        }
+        // The mapping keeps the file open by itself
+        void* address = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+        close(file);
+        return address == MAP_FAILED ? nullptr : static_cast<unsigned char*>(address);
+#endif
+    }
+
+    static void unmapFile(unsigned char* address, size_t length) {
+#ifdef _WIN32
+        UnmapViewOfFile(address);
+#else
+        munmap(address, length);
+#endif
+    }
+
+    // Allocator of the images returned by mapImageFile. OpenCV hands a
+    // cv::Mat back to the allocator of its data when the last reference is
+    // released, which here unmaps the file. Images created through a copy of
+    // such a cv::Mat (e.g. as the destination of a filter) get ordinary memory.
+    class MappedFileAllocator : public cv::MatAllocator {
+    public:
+        cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+            cv::AccessFlag flags, cv::UMatUsageFlags usageFlags) const override {
+            return cv::Mat::getStdAllocator()->allocate(dims, sizes, type, data, step, flags, usageFlags);
+        }
+
+        bool allocate(cv::UMatData* data, cv::AccessFlag accessFlags, cv::UMatUsageFlags usageFlags) const override {
+            return cv::Mat::getStdAllocator()->allocate(data, accessFlags, usageFlags);
+        }
+
+        void deallocate(cv::UMatData* data) const override {
+            if (data == nullptr) {
+                return;
+            }
+            // origdata and size describe the whole mapping, data its first row
+            unmapFile(data->origdata, data->size);
+            delete data;
+        }
+    };
+
+    static MappedFileAllocator& mappedFileAllocator() {
+        // Never destroyed, since images may outlive static destruction
+        static MappedFileAllocator* allocator = new MappedFileAllocator();
+        return *allocator;
+    }
+
+    bool mapImageFile(const std::string& filePath, uint64_t dataOffset, int rows, int cols, int type,
+        uint64_t step, cv::Mat& image) {
+        // The mapping starts at the beginning of the file, which is aligned
+        // as every system requires, whatever the offset of the first row
+        const uint64_t length = dataOffset + step * rows;
+        if (length > std::numeric_limits<size_t>::max()) {
+            return false;
+        }
+
+        unsigned char* address = mapFile(filePath, static_cast<size_t>(length));
+        if (address == nullptr) {
+            return false;
+        }
+
+        // Hand the mapping to the image, which releases it through the allocator
+        MappedFileAllocator& allocator = mappedFileAllocator();
+        cv::UMatData* data = new cv::UMatData(&allocator);
+        data->origdata = address;
+        data->data = address + dataOffset;
+        data->size = static_cast<size_t>(length);
+        data->refcount = 1;
+
+        cv::Mat mapped(rows, cols, type, data->data, static_cast<size_t>(step));
+        mapped.allocator = &allocator;
+        mapped.u = data;
+        image = mapped;
+        return true;
+    }
+
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <string>
+
+namespace image_processor {
+
+    /**
+     * @brief Map the pixel data of an image stored in a file
+     *
+     * The file is mapped copy-on-write from its start through the last row,
+     * so the image can be written to without touching the file. The mapping
+     * is released when the last reference to the image is, and images
+     * created through a copy of it get ordinary memory.
+     *
+     * @param filePath The path of the file
+     * @param dataOffset Position of the first row in the file
+     * @param rows The number of rows
+     * @param cols The number of columns
+     * @param type OpenCV type, including the channel count
+     * @param step Bytes from one row to the next
+     * @param image Receives the mapped image
+     * @return True if the file was mapped, false otherwise
+     */
+    bool mapImageFile(const std::string& filePath, uint64_t dataOffset, int rows, int cols, int type,
+        uint64_t step, cv::Mat& image);
+
+}
@@ -1,14 +1,19 @@
 #include "node_graph.h"
+#include "image_strips.h"
 #include "input_node.h"
 #include "output_node.h"
+#include "result_cache.h"
+#include <atomic>
+#include <functional>
+#include <future>
 #include <iostream>
 #include <queue>
 #include <algorithm>
-#include <typeinfo>
 
 namespace image_processor {
 
-    NodeGraph::NodeGraph() {
+    NodeGraph::NodeGraph()
+        : m_resultCache(nullptr) {
     }
 
     NodeGraph::~NodeGraph() {
@@ -26,7 +31,14 @@ namespace image_processor {
             return false;
         }
 
+        if (node->getGraphIndex() != -1) {
+            std::cerr << "NodeGraph::addNode: Node with ID " << node->getId() << " already belongs to a graph." << std::endl;
+            return false;
+        }
+
+        node->m_graphIndex = static_cast<int>(m_nodes.size());
         m_nodes.push_back(node);
+        m_nodesByType[node->getTypeName()].push_back(node);
         return true;
     }
 
@@ -62,13 +74,62 @@ namespace image_processor {
             }
         }
 
-        // Remove the node from the graph
+        // Remove the node from the type index
+        auto typeIt = m_nodesByType.find(node->getTypeName());
+        if (typeIt != m_nodesByType.end()) {
+            auto& sameType = typeIt->second;
+            sameType.erase(std::remove(sameType.begin(), sameType.end(), node), sameType.end());
+            if (sameType.empty()) {
+                m_nodesByType.erase(typeIt);
+            }
+        }
+
+        // Remove the node from the graph and compact the indices of the nodes after it
         delete node;
-        m_nodes.erase(it);
+        it = m_nodes.erase(it);
+        for (; it != m_nodes.end(); ++it) {
+            (*it)->m_graphIndex--;
+        }
 
         return true;
     }
 
+    std::unique_ptr<NodeGraph> NodeGraph::clone(std::unordered_map<int, int>* idMap) const {
+        std::unique_ptr<NodeGraph> copy(new NodeGraph());
+        copy->m_resultCache = m_resultCache;
+        std::unordered_map<const BaseNode*, BaseNode*> copies;
+
+        for (BaseNode* node : m_nodes) {
+            BaseNode* nodeCopy = node->clone();
+            if (!nodeCopy) {
+                std::cerr << "NodeGraph::clone: Failed to clone node " << node->getName() << " (ID: " << node->getId() << ")." << std::endl;
+                return nullptr;
+            }
+            copy->addNode(nodeCopy);
+            copies[node] = nodeCopy;
+        }
+
+        // Recreate the connections; the source graph is acyclic, so the copy is too
+        for (BaseNode* node : m_nodes) {
+            for (int outputIndex = 0; outputIndex < node->getOutputCount(); ++outputIndex) {
+                for (const auto& connection : node->getConnectedNodes(outputIndex)) {
+                    auto target = copies.find(connection.first);
+                    if (target != copies.end()) {
+                        copies[node]->connectOutput(outputIndex, target->second, connection.second);
+                    }
+                }
+            }
+        }
+
+        if (idMap) {
+            for (BaseNode* node : m_nodes) {
+                (*idMap)[node->getId()] = copies[node]->getId();
+            }
+        }
+
+        return copy;
+    }
+
     BaseNode* NodeGraph::getNode(int nodeId) const {
         auto it = std::find_if(m_nodes.begin(), m_nodes.end(),
             [nodeId](const BaseNode* node) { return node->getId() == nodeId; });
@@ -80,6 +141,13 @@ namespace image_processor {
         return *it;
     }
 
+    BaseNode* NodeGraph::getNodeByIndex(int index) const {
+        if (index < 0 || index >= static_cast<int>(m_nodes.size())) {
+            return nullptr;
+        }
+        return m_nodes[index];
+    }
+
     std::vector<BaseNode*> NodeGraph::getAllNodes() const {
         return m_nodes;
     }
@@ -99,6 +167,15 @@ namespace image_processor {
             return false;
         }
 
+        // Check that the port types match
+        PortType outputType = sourceNode->getOutputType(outputIndex);
+        PortType inputType = targetNode->getInputType(inputIndex);
+        if (!arePortTypesCompatible(outputType, inputType)) {
+            std::cerr << "NodeGraph::connectNodes: Cannot connect " << portTypeToString(outputType)
+                << " output to " << portTypeToString(inputType) << " input." << std::endl;
+            return false;
+        }
+
         // Check if the input is already connected
         auto existingConnection = targetNode->getInputConnection(inputIndex);
         if (existingConnection.first) {
@@ -132,21 +209,246 @@ namespace image_processor {
         return sourceNode->disconnectOutput(outputIndex, targetNode, inputIndex);
     }
 
+    // Process a node, or report that its inputs are missing
+    static void processReadyNode(BaseNode* node) {
+        if (node->isReady()) {
+            node->process();
+        }
+        else {
+            std::cerr << "NodeGraph::processGraph: Node " << node->getName() << " (ID: " << node->getId() << ") is not ready to process." << std::endl;
+        }
+    }
+
     void NodeGraph::processGraph() {
+        // Derived representations only live for one run
+        for (BaseNode* node : m_nodes) {
+            node->clearDerivedOutputs();
+        }
+
         // Get the processing order
         std::vector<BaseNode*> processingOrder = getProcessingOrder();
+        propagateRequestedRegions(processingOrder);
 
-        // Process each node in order
+        if (m_resultCache != nullptr) {
+            processWithCache(processingOrder);
+            return;
+        }
+
+        // Group the nodes by their distance from the sources; a node only
+        // consumes outputs of earlier levels, so the nodes of a level (such as
+        // the consumers of the outputs of one splitter) are independent
+        std::vector<int> levelOf(m_nodes.size(), 0);
+        std::vector<std::vector<BaseNode*>> levels;
         for (BaseNode* node : processingOrder) {
-            if (node->isReady()) {
-                node->process();
+            int level = 0;
+            for (int i = 0; i < node->getInputCount(); ++i) {
+                int producerIndex = indexOf(node->getInputConnection(i).first);
+                if (producerIndex != -1) {
+                    level = std::max(level, levelOf[producerIndex] + 1);
+                }
             }
-            else {
-                std::cerr << "NodeGraph::processGraph: Node " << node->getName() << " (ID: " << node->getId() << ") is not ready to process." << std::endl;
+            levelOf[node->m_graphIndex] = level;
+            if (level >= static_cast<int>(levels.size())) {
+                levels.resize(level + 1);
+            }
+            levels[level].push_back(node);
+        }
+
+        // Process the nodes of each level concurrently, on at most as many
+        // threads as OpenCV uses. They run on threads of their own rather than
+        // in cv::parallel_for_, which would run the row bands of every node
+        // serially. With OpenCV's default backend the cv::parallel_for_ calls
+        // inside nodes that run concurrently still execute serially, since the
+        // thread pool serves one caller at a time. A level with several heavy
+        // nodes therefore trades parallelism inside each node for parallelism
+        // between nodes.
+        const size_t threadCount = static_cast<size_t>(std::max(cv::getNumThreads(), 1));
+        for (const std::vector<BaseNode*>& level : levels) {
+            std::atomic<size_t> nextNode(0);
+            auto processNodes = [&level, &nextNode]() {
+                for (size_t i = nextNode++; i < level.size(); i = nextNode++) {
+                    processReadyNode(level[i]);
+                }
+            };
+
+            std::vector<std::future<void>> workers;
+            for (size_t i = 1; i < std::min(level.size(), threadCount); ++i) {
+                workers.push_back(std::async(std::launch::async, processNodes));
+            }
+            processNodes();
+            for (std::future<void>& worker : workers) {
+                worker.get();
             }
         }
     }
 
+    bool NodeGraph::processStreaming(const std::unordered_map<BaseNode*, std::string>& inputPaths,
+        const std::unordered_map<BaseNode*, std::string>& outputPaths, int stripRows) {
+        if (stripRows <= 0) {
+            std::cerr << "NodeGraph::processStreaming: Strip height must be positive." << std::endl;
+            return false;
+        }
+
+        // Open the file of every input node; all images must have the same size
+        std::vector<std::pair<InputNode*, std::unique_ptr<ImageStripReader>>> readers;
+        cv::Size size;
+        for (BaseNode* node : m_nodes) {
+            if (node->getInputCount() > 0) {
+                continue;
+            }
+            InputNode* inputNode = dynamic_cast<InputNode*>(node);
+            if (inputNode == nullptr) {
+                std::cerr << "NodeGraph::processStreaming: Node " << node->getName() << " (ID: " << node->getId() << ") creates its own image and cannot be streamed." << std::endl;
+                return false;
+            }
+            auto path = inputPaths.find(node);
+            if (path == inputPaths.end()) {
+                std::cerr << "NodeGraph::processStreaming: Input node " << node->getName() << " (ID: " << node->getId() << ") has no file." << std::endl;
+                return false;
+            }
+
+            std::unique_ptr<ImageStripReader> reader = ImageStripReader::open(path->second);
+            if (!reader) {
+                return false;
+            }
+            if (readers.empty()) {
+                size = reader->getSize();
+            }
+            else if (reader->getSize() != size) {
+                std::cerr << "NodeGraph::processStreaming: Input images must have the same size." << std::endl;
+                return false;
+            }
+            readers.emplace_back(inputNode, std::move(reader));
+        }
+        if (readers.empty()) {
+            std::cerr << "NodeGraph::processStreaming: Graph has no input nodes." << std::endl;
+            return false;
+        }
+
+        for (const auto& path : outputPaths) {
+            if (indexOf(path.first) == -1 || dynamic_cast<OutputNode*>(path.first) == nullptr) {
+                std::cerr << "NodeGraph::processStreaming: Files can only be written by output nodes of the graph." << std::endl;
+                return false;
+            }
+        }
+
+        // Writers are created with the first strip, which gives the type of each output
+        std::vector<OutputNode*> outputNodes;
+        std::vector<cv::Rect> previousRegions;
+        for (BaseNode* node : getOutputNodes()) {
+            outputNodes.push_back(static_cast<OutputNode*>(node));
+            previousRegions.push_back(outputNodes.back()->getRegion());
+        }
+        std::vector<std::unique_ptr<ImageStripWriter>> writers(outputNodes.size());
+
+        const std::vector<BaseNode*> processingOrder = getProcessingOrder();
+
+        // Strips of approximate nodes can differ from the whole image near their boundaries
+        for (BaseNode* node : processingOrder) {
+            if (!node->isRegionExact()) {
+                std::cerr << "NodeGraph::processStreaming: Warning: Node " << node->getName() << " (ID: " << node->getId()
+                    << ") is computed only approximately by strips; its output may differ from the whole image." << std::endl;
+            }
+        }
+
+        // Strips are never computed again, so caching them would only fill the
+        // cache with intermediates and evict useful entries
+        ResultCache* resultCache = m_resultCache;
+        m_resultCache = nullptr;
+
+        bool success = true;
+        for (int top = 0; top < size.height && success; top += stripRows) {
+            const int bottom = std::min(top + stripRows, size.height);
+
+            // Find the input rows the strip depends on, the same rows for every input
+            for (OutputNode* node : outputNodes) {
+                node->setRegion(cv::Rect(0, top, size.width, bottom - top));
+            }
+            propagateRequestedRegions(processingOrder);
+            int readTop = top;
+            int readBottom = bottom;
+            for (const auto& reader : readers) {
+                const cv::Rect region = reader.first->getRequestedRegion();
+                if (reader.first->getConnectedNodes(0).empty()) {
+                    continue;
+                }
+                if (region.empty()) {
+                    std::cerr << "NodeGraph::processStreaming: The whole image of input node " << reader.first->getName()
+                        << " (ID: " << reader.first->getId() << ") is needed at once, so the graph cannot be streamed." << std::endl;
+                    success = false;
+                    break;
+                }
+                readTop = std::min(readTop, region.y);
+                readBottom = std::max(readBottom, region.y + region.height);
+            }
+            if (!success) {
+                break;
+            }
+            readTop = std::max(readTop, 0);
+            readBottom = std::min(readBottom, size.height);
+
+            for (auto& reader : readers) {
+                cv::Mat rows;
+                if (!reader.second->readRows(readTop, readBottom - readTop, rows)) {
+                    success = false;
+                    break;
+                }
+                reader.first->setImage(rows);
+            }
+            if (!success) {
+                break;
+            }
+
+            // Compute the strip in the coordinates of the rows read
+            for (OutputNode* node : outputNodes) {
+                node->setRegion(cv::Rect(0, top - readTop, size.width, bottom - top));
+            }
+            processGraph();
+
+            for (size_t i = 0; i < outputNodes.size(); ++i) {
+                auto path = outputPaths.find(outputNodes[i]);
+                if (path == outputPaths.end()) {
+                    continue;
+                }
+                const cv::Mat rows = outputNodes[i]->getImage();
+                if (rows.rows != bottom - top) {
+                    std::cerr << "NodeGraph::processStreaming: Output node " << outputNodes[i]->getName() << " (ID: " << outputNodes[i]->getId()
+                        << ") has no image for rows " << top << " to " << bottom << "." << std::endl;
+                    success = false;
+                    break;
+                }
+                if (!writers[i]) {
+                    writers[i] = ImageStripWriter::create(path->second, cv::Size(rows.cols, size.height), rows.type());
+                }
+                if (!writers[i] || !writers[i]->writeRows(rows)) {
+                    success = false;
+                    break;
+                }
+            }
+        }
+
+        for (size_t i = 0; i < outputNodes.size(); ++i) {
+            outputNodes[i]->setRegion(previousRegions[i]);
+        }
+        m_resultCache = resultCache;
+
+        // Unfinished writers delete their files
+        for (auto& writer : writers) {
+            if (success && writer && !writer->finish()) {
+                success = false;
+            }
+        }
+        return success;
+    }
+
+    void NodeGraph::setResultCache(ResultCache* cache) {
+        m_resultCache = cache;
+    }
+
+    ResultCache* NodeGraph::getResultCache() const {
+        return m_resultCache;
+    }
+
     void NodeGraph::clear() {
         // Delete all nodes
         for (BaseNode* node : m_nodes) {
@@ -154,6 +456,7 @@ namespace image_processor {
         }
 
         m_nodes.clear();
+        m_nodesByType.clear();
     }
 
     bool NodeGraph::containsNode(int nodeId) const {
@@ -166,20 +469,11 @@ namespace image_processor {
     }
 
     std::vector<BaseNode*> NodeGraph::findNodesByType(const std::string& typeName) const {
-        std::vector<BaseNode*> result;
-
-        for (BaseNode* node : m_nodes) {
-            // Get the type name of the node
-            const std::type_info& typeInfo = typeid(*node);
-            std::string nodeTypeName = typeInfo.name();
-
-            // Check if the type name contains the search string
-            if (nodeTypeName.find(typeName) != std::string::npos) {
-                result.push_back(node);
-            }
+        auto it = m_nodesByType.find(typeName);
+        if (it == m_nodesByType.end()) {
+            return {};
         }
-
-        return result;
+        return it->second;
     }
 
     std::vector<BaseNode*> NodeGraph::findNodesByName(const std::string& name) const {
@@ -229,7 +523,7 @@ namespace image_processor {
         for (BaseNode* node : m_nodes) {
             for (int i = 0; i < node->getInputCount(); ++i) {
                 auto connection = node->getInputConnection(i);
-                if (!connection.first) {
+                if (!connection.first && !node->isInputOptional(i)) {
                     std::cerr << "NodeGraph::validateGraph: Node " << node->getName() << " (ID: " << node->getId() << ") has unconnected input " << i << "." << std::endl;
                     return false;
                 }
@@ -241,73 +535,232 @@ namespace image_processor {
 
     std::vector<BaseNode*> NodeGraph::getProcessingOrder() const {
         std::vector<BaseNode*> result;
-        std::unordered_map<int, bool> processedNodes;
+        result.reserve(m_nodes.size());
 
-        // Initialize all nodes as unprocessed
+        // Count the connected inputs of every node, indexed by graph index
+        std::vector<int> pendingInputs(m_nodes.size(), 0);
         for (BaseNode* node : m_nodes) {
-            processedNodes[node->getId()] = false;
+            for (int i = 0; i < node->getInputCount(); ++i) {
+                if (indexOf(node->getInputConnection(i).first) != -1) {
+                    pendingInputs[node->m_graphIndex]++;
+                }
+            }
         }
 
-        // Process nodes until all are processed
-        while (result.size() < m_nodes.size()) {
-            bool foundNode = false;
-
-            for (BaseNode* node : m_nodes) {
-                int nodeId = node->getId();
+        // Start with the nodes that have no dependencies, in graph order
+        std::queue<BaseNode*> ready;
+        for (BaseNode* node : m_nodes) {
+            if (pendingInputs[node->m_graphIndex] == 0) {
+                ready.push(node);
+            }
+        }
 
-                // Skip already processed nodes
-                if (processedNodes[nodeId]) {
-                    continue;
+        while (!ready.empty()) {
+            BaseNode* node = ready.front();
+            ready.pop();
+            result.push_back(node);
+
+            // Release the nodes that consume this node's outputs
+            for (int i = 0; i < node->getOutputCount(); ++i) {
+                for (const auto& connection : node->getConnectedNodes(i)) {
+                    int targetIndex = indexOf(connection.first);
+                    if (targetIndex != -1 && --pendingInputs[targetIndex] == 0) {
+                        ready.push(connection.first);
+                    }
                 }
+            }
+        }
+
+        if (result.size() < m_nodes.size()) {
+            std::cerr << "NodeGraph::getProcessingOrder: Could not determine processing order. Graph might contain cycles." << std::endl;
+        }
+
+        return result;
+    }
+
+    void NodeGraph::propagateRequestedRegions(const std::vector<BaseNode*>& processingOrder) {
+        for (auto it = processingOrder.rbegin(); it != processingOrder.rend(); ++it) {
+            BaseNode* node = *it;
+            bool consumed = false;
+            bool wholeImage = false;
+            cv::Rect region;
+
+            for (int i = 0; i < node->getOutputCount() && !wholeImage; ++i) {
+                for (const auto& connection : node->getConnectedNodes(i)) {
+                    consumed = true;
+
+                    // Consumers outside the graph are not processed here and get everything
+                    const cv::Rect requested = indexOf(connection.first) != -1 ?
+                        connection.first->m_requestedRegion : cv::Rect();
+                    const int margin = connection.first->getRegionMargin(connection.second);
+                    if (requested.empty() || margin < 0) {
+                        wholeImage = true;
+                        break;
+                    }
 
-                // Check if all dependencies are processed
-                if (!hasUnprocessedDependencies(node, processedNodes)) {
-                    // Add the node to the result and mark it as processed
-                    result.push_back(node);
-                    processedNodes[nodeId] = true;
-                    foundNode = true;
+                    const cv::Rect grown(requested.x - margin, requested.y - margin,
+                        requested.width + 2 * margin, requested.height + 2 * margin);
+                    region = region.empty() ? grown : (region | grown);
                 }
             }
 
-            // If no node was found in this iteration, there might be a cycle
-            if (!foundNode) {
-                std::cerr << "NodeGraph::getProcessingOrder: Could not determine processing order. Graph might contain cycles." << std::endl;
-                break;
+            if (!consumed) {
+                node->m_requestedRegion = node->getSinkRegion();
+            }
+            else {
+                node->m_requestedRegion = wholeImage ? cv::Rect() : region;
             }
         }
+    }
 
-        return result;
+    std::vector<uint64_t> NodeGraph::computeCacheKeys(const std::vector<BaseNode*>& processingOrder,
+        std::vector<char>& cacheable) const {
+        std::vector<uint64_t> keys(m_nodes.size(), 0);
+        cacheable.assign(m_nodes.size(), 0);
+
+        // Producers come first in processing order, so their keys are ready
+        for (BaseNode* node : processingOrder) {
+            const int index = node->m_graphIndex;
+            bool nodeCacheable = node->isCacheable();
+
+            ContentHasher hasher;
+            hasher.add(RESULT_CACHE_ALGORITHM_VERSION);
+            hasher.add(node->getTypeName());
+            for (const auto& parameter : node->getParameters()) {
+                hasher.add(parameter.first);
+                hasher.add(parameter.second);
+            }
+            node->hashCacheState(hasher);
+
+            // Outputs computed for a region differ from full ones outside it
+            const cv::Rect& region = node->m_requestedRegion;
+            for (int value : { region.x, region.y, region.width, region.height }) {
+                hasher.add(static_cast<uint64_t>(static_cast<int64_t>(value)));
+            }
+
+            for (int i = 0; i < node->getInputCount() && nodeCacheable; ++i) {
+                auto connection = node->getInputConnection(i);
+                if (connection.first == nullptr) {
+                    hasher.add(UINT64_MAX);
+                    continue;
+                }
+                int producer = indexOf(connection.first);
+                if (producer == -1 || !cacheable[producer]) {
+                    nodeCacheable = false;
+                    break;
+                }
+                hasher.add(keys[producer]);
+                hasher.add(static_cast<uint64_t>(connection.second));
+            }
+
+            keys[index] = hasher.digest();
+            cacheable[index] = nodeCacheable;
+        }
+
+        return keys;
     }
 
-    bool NodeGraph::hasUnprocessedDependencies(BaseNode* node, const std::unordered_map<int, bool>& processedNodes) const {
-        for (int i = 0; i < node->getInputCount(); ++i) {
-            auto connection = node->getInputConnection(i);
-            if (connection.first) {
-                int sourceNodeId = connection.first->getId();
-                if (!processedNodes.at(sourceNodeId)) {
-                    return true;
+    void NodeGraph::processWithCache(const std::vector<BaseNode*>& processingOrder) {
+        std::vector<char> cacheable;
+        std::vector<uint64_t> keys = computeCacheKeys(processingOrder, cacheable);
+
+        // Nodes outside the processing order are in cycles and never processed
+        std::vector<char> done(m_nodes.size(), 1);
+        for (BaseNode* node : processingOrder) {
+            done[node->m_graphIndex] = 0;
+        }
+
+        // Load a node from the cache, or process it after its producers
+        std::function<void(BaseNode*)> materialize = [&](BaseNode* node) {
+            const int index = node->m_graphIndex;
+            if (done[index]) {
+                return;
+            }
+            done[index] = 1;
+
+            // Nodes without inputs are cheap to run and would only copy their input into the cache
+            const int outputCount = node->getOutputCount();
+            const bool cached = cacheable[index] && node->getInputCount() > 0 && outputCount > 0;
+            std::vector<PortValue> values;
+            if (cached && m_resultCache->load(keys[index], values) && static_cast<int>(values.size()) == outputCount) {
+                for (int i = 0; i < outputCount; ++i) {
+                    node->setOutputValue(i, values[i]);
+                }
+                return;
+            }
+
+            for (int i = 0; i < node->getInputCount(); ++i) {
+                BaseNode* producer = node->getInputConnection(i).first;
+                if (indexOf(producer) != -1) {
+                    materialize(producer);
                 }
             }
+
+            if (!node->isReady()) {
+                std::cerr << "NodeGraph::processGraph: Node " << node->getName() << " (ID: " << node->getId() << ") is not ready to process." << std::endl;
+                return;
+            }
+
+            // Outputs of an earlier run must not be stored under this key if processing fails
+            if (cached) {
+                node->m_outputValues.clear();
+            }
+            node->process();
+
+            // Failed nodes leave their outputs empty and are not stored
+            if (cached) {
+                values.clear();
+                bool produced = false;
+                for (int i = 0; i < outputCount; ++i) {
+                    values.push_back(node->getOutputPortValue(i));
+                    produced = produced || !values.back().empty();
+                }
+                if (produced) {
+                    m_resultCache->store(keys[index], values);
+                }
+            }
+        };
+
+        // Start from the nodes without consumers and pull in what they read
+        for (BaseNode* node : processingOrder) {
+            bool consumed = false;
+            for (int i = 0; i < node->getOutputCount() && !consumed; ++i) {
+                consumed = !node->getConnectedNodes(i).empty();
+            }
+            if (!consumed) {
+                materialize(node);
+            }
         }
 
-        return false;
+        // Nodes upstream of stored results were skipped; clear their outputs
+        // rather than leave those of another run readable
+        for (BaseNode* node : processingOrder) {
+            if (!done[node->m_graphIndex]) {
+                node->m_outputValues.clear();
+            }
+        }
     }
 
-    bool NodeGraph::containsCycles() const {
-        std::unordered_map<int, bool> visited;
-        std::unordered_map<int, bool> recursionStack;
+    int NodeGraph::indexOf(const BaseNode* node) const {
+        if (!node) {
+            return -1;
+        }
 
-        // Initialize all nodes as not visited
-        for (BaseNode* node : m_nodes) {
-            visited[node->getId()] = false;
-            recursionStack[node->getId()] = false;
+        int index = node->m_graphIndex;
+        if (index < 0 || index >= static_cast<int>(m_nodes.size()) || m_nodes[index] != node) {
+            return -1;
         }
+        return index;
+    }
+
+    bool NodeGraph::containsCycles() const {
+        std::vector<char> visited(m_nodes.size(), 0);
+        std::vector<char> recursionStack(m_nodes.size(), 0);
 
         // Check for cycles starting from each node
-        for (BaseNode* node : m_nodes) {
-            int nodeId = node->getId();
-            if (!visited[nodeId]) {
-                if (detectCycle(nodeId, visited, recursionStack)) {
+        for (int index = 0; index < static_cast<int>(m_nodes.size()); ++index) {
+            if (!visited[index]) {
+                if (detectCycle(index, visited, recursionStack)) {
                     return true;
                 }
             }
@@ -316,37 +769,36 @@ namespace image_processor {
         return false;
     }
 
-    bool NodeGraph::detectCycle(int nodeId, std::unordered_map<int, bool>& visited, std::unordered_map<int, bool>& recursionStack) const {
-        BaseNode* node = getNode(nodeId);
-        if (!node) {
-            return false;
-        }
+    bool NodeGraph::detectCycle(int nodeIndex, std::vector<char>& visited, std::vector<char>& recursionStack) const {
+        BaseNode* node = m_nodes[nodeIndex];
 
-        visited[nodeId] = true;
-        recursionStack[nodeId] = true;
+        visited[nodeIndex] = 1;
+        recursionStack[nodeIndex] = 1;
 
         // Check all outgoing connections
         for (int i = 0; i < node->getOutputCount(); ++i) {
             auto connections = node->getConnectedNodes(i);
             for (const auto& connection : connections) {
-                BaseNode* targetNode = connection.first;
-                int targetNodeId = targetNode->getId();
+                int targetIndex = indexOf(connection.first);
+                if (targetIndex == -1) {
+                    continue;
+                }
 
                 // If the target node is not visited, recursively check it
-                if (!visited[targetNodeId]) {
-                    if (detectCycle(targetNodeId, visited, recursionStack)) {
+                if (!visited[targetIndex]) {
+                    if (detectCycle(targetIndex, visited, recursionStack)) {
                         return true;
                     }
                 }
                 // If the target node is in the recursion stack, there's a cycle
-                else if (recursionStack[targetNodeId]) {
+                else if (recursionStack[targetIndex]) {
                     return true;
                 }
             }
         }
 
         // Remove the node from the recursion stack
-        recursionStack[nodeId] = false;
+        recursionStack[nodeIndex] = 0;
         return false;
     }
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "base_node.h"
+#include <cstdint>
 #include <vector>
 #include <memory>
 #include <string>
@@ -8,11 +9,21 @@
 
 namespace image_processor {
 
+    class ResultCache;
+
     /**
      * @brief Class for managing a graph of connected processing nodes
      *
      * This class manages a collection of nodes and their connections,
      * allowing for the creation of complex image processing pipelines.
+     *
+     * Node IDs are allocated atomically, so separate graphs can be built and
+     * modified on different threads at the same time. A single graph is not
+     * synchronized and must only be mutated by one thread at a time.
+     *
+     * Besides its global ID, every node in a graph has a dense graph index
+     * (BaseNode::getGraphIndex) in the range [0, getNodeCount()), which can be
+     * used to index per-node arrays.
      */
     class NodeGraph {
     public:
@@ -26,6 +37,24 @@ namespace image_processor {
          */
         ~NodeGraph();
 
+        // Graphs own their nodes; use clone() to copy a graph
+        NodeGraph(const NodeGraph&) = delete;
+        NodeGraph& operator=(const NodeGraph&) = delete;
+
+        /**
+         * @brief Create an independent copy of the graph
+         *
+         * Every node is copied with BaseNode::clone and the connections are
+         * recreated between the copies. Parameters and immutable data such as
+         * kernels and input images are shared; output values are not copied.
+         * Each copy can then be processed on its own thread, so several frames
+         * can run through the same pipeline in parallel.
+         *
+         * @param idMap Optional map that receives original node ID -> copied node ID
+         * @return The copy, or nullptr if a node could not be cloned
+         */
+        std::unique_ptr<NodeGraph> clone(std::unordered_map<int, int>* idMap = nullptr) const;
+
         /**
          * @brief Add a node to the graph
          * @param node Pointer to the node to add
@@ -47,6 +76,13 @@ namespace image_processor {
          */
         BaseNode* getNode(int nodeId) const;
 
+        /**
+         * @brief Get a node by its dense graph index
+         * @param index The graph index of the node (0 to getNodeCount() - 1)
+         * @return Pointer to the node, or nullptr if the index is out of range
+         */
+        BaseNode* getNodeByIndex(int index) const;
+
         /**
          * @brief Get all nodes in the graph
          * @return Vector of pointers to all nodes
@@ -55,6 +91,10 @@ namespace image_processor {
 
         /**
          * @brief Connect two nodes
+         *
+         * The output and input port types must be compatible
+         * (see arePortTypesCompatible).
+         *
          * @param sourceNodeId The ID of the source node
          * @param outputIndex The index of the output on the source node
          * @param targetNodeId The ID of the target node
@@ -78,9 +118,70 @@ namespace image_processor {
          *
          * This method processes all nodes in the graph in the correct order,
          * starting from input nodes and following the connections to output nodes.
+         * When output nodes ask for a region only, every node computes only the
+         * part of its image that region depends on (see BaseNode::getRequestedRegion).
+         * Nodes that do not depend on each other, such as several consumers of
+         * one node, are processed concurrently on up to cv::getNumThreads()
+         * threads (with a result cache, nodes are processed one at a time).
          */
         void processGraph();
 
+        /**
+         * @brief Process images that do not fit in memory, a strip of rows at a time
+         *
+         * The input nodes read their images from files and the output nodes
+         * write theirs to files, a band of rows at a time, so memory use grows
+         * with the width of the images and the strip height only. Each strip
+         * is computed as a region (see BaseNode::getRegionMargin) from just
+         * the input rows it depends on, and the files hold the same pixels as
+         * processing the whole images would give, except for the outputs of
+         * nodes that compute regions only approximately
+         * (BaseNode::isRegionExact, such as the recursive Gaussian, the
+         * bilateral grid and Canny), which are reported on std::cerr and
+         * may differ, most visibly at strip boundaries. Graphs with a node that
+         * needs the whole image, such as a histogram equalization or the
+         * blend image of a BlendNode, cannot be streamed; neither can graphs
+         * with sources other than input nodes.
+         *
+         * Files are read with ImageStripReader and written with
+         * ImageStripWriter (raw image files and TIFF). Afterwards the input
+         * nodes hold their last strip and the output nodes their last rows.
+         * A result cache set on the graph is not used while streaming.
+         *
+         * @param inputPaths File of every input node, keyed by node
+         * @param outputPaths Files to write, keyed by output node
+         * @param stripRows Number of output rows computed at a time
+         * @return True if every output file was written, false otherwise
+         */
+        bool processStreaming(const std::unordered_map<BaseNode*, std::string>& inputPaths,
+            const std::unordered_map<BaseNode*, std::string>& outputPaths, int stripRows);
+
+        /**
+         * @brief Reuse node outputs stored by earlier runs
+         *
+         * With a cache, processGraph keys every node by a hash of its type and
+         * parameters, the requested region and the keys of its producers, down
+         * to the content of the input images. It starts from the nodes without
+         * consumers and works upstream only as far as it finds no stored
+         * result, so after a change to a downstream parameter the upstream
+         * nodes are neither processed nor loaded. Computed outputs are stored
+         * for later runs. Nodes without inputs are always processed, and
+         * nodes that are not cacheable (BaseNode::isCacheable) make everything
+         * downstream of them uncacheable. Nodes that were skipped because
+         * everything downstream of them was loaded have empty outputs after
+         * the run.
+         *
+         * @param cache The cache, or nullptr to process every node (the graph
+         *        does not take ownership; clones share the cache)
+         */
+        void setResultCache(ResultCache* cache);
+
+        /**
+         * @brief Get the result cache
+         * @return The cache, or nullptr if none is set
+         */
+        ResultCache* getResultCache() const;
+
         /**
          * @brief Clear the graph
          *
@@ -103,7 +204,11 @@ namespace image_processor {
 
         /**
          * @brief Find nodes by type
-         * @param typeName The name of the node type to find
+         *
+         * Uses an index maintained by addNode/removeNode, so the lookup does
+         * not scan the graph.
+         *
+         * @param typeName The stable type identifier (BaseNode::getTypeName, e.g. "BlurNode")
          * @return Vector of pointers to nodes of the specified type
          */
         std::vector<BaseNode*> findNodesByType(const std::string& typeName) const;
@@ -131,6 +236,7 @@ namespace image_processor {
          * @brief Validate the graph
          *
          * Checks if the graph is valid (no cycles, all required inputs connected, etc.)
+         * Optional inputs may be left unconnected.
          *
          * @return True if the graph is valid, false otherwise
          */
@@ -138,6 +244,8 @@ namespace image_processor {
 
     private:
         std::vector<BaseNode*> m_nodes;  // All nodes in the graph
+        std::unordered_map<std::string, std::vector<BaseNode*>> m_nodesByType;  // Nodes grouped by type identifier
+        ResultCache* m_resultCache;      // Cache of node outputs across runs, not owned
 
         /**
          * @brief Get the processing order for the nodes
@@ -149,12 +257,38 @@ namespace image_processor {
         std::vector<BaseNode*> getProcessingOrder() const;
 
         /**
-         * @brief Check if a node has unprocessed dependencies
-         * @param node The node to check
-         * @param processedNodes Set of nodes that have already been processed
-         * @return True if the node has unprocessed dependencies, false otherwise
+         * @brief Set the region each node has to compute for its consumers
+         *
+         * Walks the nodes from the sinks back to the sources. A node needs the
+         * union of the regions its consumers request, each grown by the margin
+         * of the consumer for the connected input, and the whole image as soon
+         * as one consumer needs it.
+         *
+         * @param processingOrder Nodes in processing order
+         */
+        void propagateRequestedRegions(const std::vector<BaseNode*>& processingOrder);
+
+        /**
+         * @brief Compute the result cache key of every node
+         * @param processingOrder Nodes in processing order
+         * @param cacheable Receives per graph index whether the outputs of the node may be cached
+         * @return The keys, indexed by graph index
+         */
+        std::vector<uint64_t> computeCacheKeys(const std::vector<BaseNode*>& processingOrder,
+            std::vector<char>& cacheable) const;
+
+        /**
+         * @brief Process the graph from the sinks upstream, reusing cached results
+         * @param processingOrder Nodes in processing order
+         */
+        void processWithCache(const std::vector<BaseNode*>& processingOrder);
+
+        /**
+         * @brief Get the graph index of a node if it belongs to this graph
+         * @param node The node to look up
+         * @return The graph index, or -1 if the node is not part of this graph
          */
-        bool hasUnprocessedDependencies(BaseNode* node, const std::unordered_map<int, bool>& processedNodes) const;
+        int indexOf(const BaseNode* node) const;
 
         /**
          * @brief Check if the graph contains cycles
@@ -164,12 +298,12 @@ namespace image_processor {
 
         /**
          * @brief Detect cycles using depth-first search
-         * @param nodeId The ID of the current node
-         * @param visited Map of visited nodes
-         * @param recursionStack Map of nodes in the current recursion stack
+         * @param nodeIndex The graph index of the current node
+         * @param visited Visited flags, indexed by graph index
+         * @param recursionStack Flags of nodes in the current recursion stack, indexed by graph index
          * @return True if a cycle was detected, false otherwise
          */
-        bool detectCycle(int nodeId, std::unordered_map<int, bool>& visited, std::unordered_map<int, bool>& recursionStack) const;
+        bool detectCycle(int nodeIndex, std::vector<char>& visited, std::vector<char>& recursionStack) const;
     };
 
 }
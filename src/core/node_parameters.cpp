@@ -0,0 +1,100 @@
+#include "node_parameters.h"
+#include <cmath>
+#include <limits>
+
+namespace image_processor {
+
+    bool parameterToDouble(const ParameterValue& value, double& result) {
+        if (const double* d = std::get_if<double>(&value)) {
+            result = *d;
+            return true;
+        }
+        if (const int* i = std::get_if<int>(&value)) {
+            result = *i;
+            return true;
+        }
+        if (const bool* b = std::get_if<bool>(&value)) {
+            result = *b ? 1.0 : 0.0;
+            return true;
+        }
+        return false;
+    }
+
+    bool parameterToInt(const ParameterValue& value, int& result) {
+        if (const int* i = std::get_if<int>(&value)) {
+            result = *i;
+            return true;
+        }
+        if (const double* d = std::get_if<double>(&value)) {
+            // Only accept doubles that carry an integral value in the range of int
+            if (std::floor(*d) != *d || *d < std::numeric_limits<int>::min() || *d > std::numeric_limits<int>::max()) {
+                return false;
+            }
+            result = static_cast<int>(*d);
+            return true;
+        }
+        if (const bool* b = std::get_if<bool>(&value)) {
+            result = *b ? 1 : 0;
+            return true;
+        }
+        return false;
+    }
+
+    bool parameterToBool(const ParameterValue& value, bool& result) {
+        if (const bool* b = std::get_if<bool>(&value)) {
+            result = *b;
+            return true;
+        }
+        if (const int* i = std::get_if<int>(&value)) {
+            result = *i != 0;
+            return true;
+        }
+        return false;
+    }
+
+    bool parameterToString(const ParameterValue& value, std::string& result) {
+        if (const std::string* s = std::get_if<std::string>(&value)) {
+            result = *s;
+            return true;
+        }
+        return false;
+    }
+
+    bool parameterToMat(const ParameterValue& value, cv::Mat& result) {
+        if (const cv::Mat* m = std::get_if<cv::Mat>(&value)) {
+            if (m->empty()) {
+                return false;
+            }
+            result = *m;
+            return true;
+        }
+        return false;
+    }
+
+    bool parameterToEnum(const ParameterValue& value, const char* const* names, int count, int& result) {
+        if (const std::string* s = std::get_if<std::string>(&value)) {
+            for (int i = 0; i < count; ++i) {
+                if (*s == names[i]) {
+                    result = i;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        int ordinal = 0;
+        if (parameterToInt(value, ordinal) && ordinal >= 0 && ordinal < count) {
+            result = ordinal;
+            return true;
+        }
+        return false;
+    }
+
+    std::string enumToString(int ordinal, const char* const* names, int count) {
+        if (ordinal < 0 || ordinal >= count) {
+            return "";
+        }
+        return names[ordinal];
+    }
+
+}
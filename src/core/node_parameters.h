@@ -0,0 +1,83 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <map>
+#include <string>
+#include <variant>
+
+namespace image_processor {
+
+    /**
+     * @brief Value of a single node parameter
+     *
+     * Enumerations are stored as their symbolic name (e.g. "GAUSSIAN") so that
+     * graph descriptions stay readable and independent of enum ordering.
+     * Matrices are used for custom convolution kernels.
+     */
+    using ParameterValue = std::variant<int, double, bool, std::string, cv::Mat>;
+
+    /**
+     * @brief Named parameters of a node, ordered by name
+     */
+    using ParameterMap = std::map<std::string, ParameterValue>;
+
+    /**
+     * @brief Read a parameter as a double (accepts int, double and bool values)
+     * @param value The parameter value
+     * @param result Receives the converted value
+     * @return True if the value could be converted, false otherwise
+     */
+    bool parameterToDouble(const ParameterValue& value, double& result);
+
+    /**
+     * @brief Read a parameter as an int (accepts int, integral double and bool values)
+     * @param value The parameter value
+     * @param result Receives the converted value
+     * @return True if the value could be converted, false otherwise
+     */
+    bool parameterToInt(const ParameterValue& value, int& result);
+
+    /**
+     * @brief Read a parameter as a bool (accepts bool and int values)
+     * @param value The parameter value
+     * @param result Receives the converted value
+     * @return True if the value could be converted, false otherwise
+     */
+    bool parameterToBool(const ParameterValue& value, bool& result);
+
+    /**
+     * @brief Read a parameter as a string
+     * @param value The parameter value
+     * @param result Receives the string
+     * @return True if the value holds a string, false otherwise
+     */
+    bool parameterToString(const ParameterValue& value, std::string& result);
+
+    /**
+     * @brief Read a parameter as a matrix
+     * @param value The parameter value
+     * @param result Receives the matrix (shares data with the parameter)
+     * @return True if the value holds a non-empty matrix, false otherwise
+     */
+    bool parameterToMat(const ParameterValue& value, cv::Mat& result);
+
+    /**
+     * @brief Read an enumeration parameter given by name or by ordinal
+     * @param value The parameter value
+     * @param names Symbolic names of the enumerators, in declaration order
+     * @param count Number of entries in names
+     * @param result Receives the ordinal of the enumerator
+     * @return True if the value names a known enumerator, false otherwise
+     */
+    bool parameterToEnum(const ParameterValue& value, const char* const* names, int count, int& result);
+
+    /**
+     * @brief Get the symbolic name of an enumerator
+     * @param ordinal The enumerator ordinal
+     * @param names Symbolic names of the enumerators, in declaration order
+     * @param count Number of entries in names
+     * @return The name, or an empty string if the ordinal is out of range
+     */
+    std::string enumToString(int ordinal, const char* const* names, int count);
+
+}
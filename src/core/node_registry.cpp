@@ -0,0 +1,86 @@
+#include "node_registry.h"
+#include <algorithm>
+#include <iostream>
+
+namespace image_processor {
+
+    NodeRegistry& NodeRegistry::instance() {
+        static NodeRegistry registry;
+        return registry;
+    }
+
+    bool NodeRegistry::registerType(const NodeTypeInfo& info) {
+        if (info.typeName.empty() || !info.factory) {
+            std::cerr << "NodeRegistry::registerType: Type name and factory are required." << std::endl;
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_types.count(info.typeName)) {
+            std::cerr << "NodeRegistry::registerType: Type " << info.typeName << " is already registered." << std::endl;
+            return false;
+        }
+
+        m_types[info.typeName] = info;
+        return true;
+    }
+
+    bool NodeRegistry::hasType(const std::string& typeName) const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_types.count(typeName) != 0;
+    }
+
+    const NodeTypeInfo* NodeRegistry::getTypeInfo(const std::string& typeName) const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_types.find(typeName);
+        if (it == m_types.end()) {
+            return nullptr;
+        }
+
+        // Records are never removed, so the pointer stays valid
+        return &it->second;
+    }
+
+    std::vector<std::string> NodeRegistry::getTypeNames() const {
+        std::vector<std::string> result;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (const auto& type : m_types) {
+                result.push_back(type.first);
+            }
+        }
+
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    BaseNode* NodeRegistry::createNode(const std::string& typeName, const std::string& name) const {
+        const NodeTypeInfo* info = getTypeInfo(typeName);
+        if (!info) {
+            std::cerr << "NodeRegistry::createNode: Unknown node type " << typeName << "." << std::endl;
+            return nullptr;
+        }
+
+        return info->factory(name.empty() ? info->displayName : name);
+    }
+
+    BaseNode* NodeRegistry::cloneNode(const BaseNode& node) const {
+        BaseNode* copy = createNode(node.getTypeName(), node.getName());
+        if (!copy) {
+            return nullptr;
+        }
+
+        if (!copy->setParameters(node.getParameters())) {
+            std::cerr << "NodeRegistry::cloneNode: Failed to copy parameters of node " << node.getName() << "." << std::endl;
+            delete copy;
+            return nullptr;
+        }
+
+        return copy;
+    }
+
+    NodeTypeRegistrar::NodeTypeRegistrar(const NodeTypeInfo& info) {
+        NodeRegistry::instance().registerType(info);
+    }
+
+}
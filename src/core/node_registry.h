@@ -0,0 +1,137 @@
+#pragma once
+
+#include "base_node.h"
+#include "node_parameters.h"
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace image_processor {
+
+    /**
+     * @brief Kind of value a node parameter holds
+     */
+    enum class ParameterType {
+        INT,        // Integer value
+        DOUBLE,     // Floating point value
+        BOOL,       // Boolean flag
+        STRING,     // Free-form text (e.g. a file path)
+        ENUM,       // One of a fixed set of symbolic names
+        MATRIX      // Single-channel matrix (e.g. a convolution kernel)
+    };
+
+    /**
+     * @brief Description of a single node parameter
+     */
+    struct ParameterSchema {
+        std::string name;                     // Parameter name used by get/setParameter
+        ParameterType type;                   // Kind of value
+        ParameterValue defaultValue;          // Value a freshly created node has
+        std::string description;              // Human readable description
+        double minValue;                      // Lower bound for numeric parameters
+        double maxValue;                      // Upper bound for numeric parameters (ignored if <= minValue)
+        std::vector<std::string> enumValues;  // Allowed names for ENUM parameters
+
+        ParameterSchema(const std::string& name, ParameterType type, const ParameterValue& defaultValue,
+            const std::string& description, double minValue = 0.0, double maxValue = 0.0,
+            const std::vector<std::string>& enumValues = {})
+            : name(name), type(type), defaultValue(defaultValue), description(description),
+            minValue(minValue), maxValue(maxValue), enumValues(enumValues) {
+        }
+    };
+
+    /**
+     * @brief Factory function creating a node with the given display name
+     */
+    using NodeFactory = std::function<BaseNode*(const std::string& name)>;
+
+    /**
+     * @brief Registration record of a node type
+     */
+    struct NodeTypeInfo {
+        std::string typeName;                    // Stable type identifier (BaseNode::getTypeName)
+        std::string displayName;                 // Default display name for new nodes
+        NodeFactory factory;                     // Creates a node of this type
+        std::vector<ParameterSchema> parameters; // Parameters accepted by setParameter
+    };
+
+    /**
+     * @brief Registry of all node types available for dynamic graph construction
+     *
+     * Every node class registers its type name, factory and parameter schema
+     * from its own translation unit using NodeTypeRegistrar. Graph files and
+     * other runtime tooling create, clone and inspect nodes through the
+     * registry instead of naming C++ classes.
+     */
+    class NodeRegistry {
+    public:
+        /**
+         * @brief Get the process-wide registry
+         * @return The registry instance
+         */
+        static NodeRegistry& instance();
+
+        /**
+         * @brief Register a node type
+         * @param info The registration record
+         * @return True if the type was registered, false if the name is empty or already taken
+         */
+        bool registerType(const NodeTypeInfo& info);
+
+        /**
+         * @brief Check if a node type is registered
+         * @param typeName The stable type identifier
+         * @return True if the type is registered, false otherwise
+         */
+        bool hasType(const std::string& typeName) const;
+
+        /**
+         * @brief Get the registration record of a node type
+         * @param typeName The stable type identifier
+         * @return Pointer to the record, or nullptr if the type is unknown
+         */
+        const NodeTypeInfo* getTypeInfo(const std::string& typeName) const;
+
+        /**
+         * @brief Get the identifiers of all registered node types
+         * @return Vector of type identifiers, sorted by name
+         */
+        std::vector<std::string> getTypeNames() const;
+
+        /**
+         * @brief Create a node of a registered type
+         * @param typeName The stable type identifier
+         * @param name The display name (the type's default name if empty)
+         * @return The new node, or nullptr if the type is unknown
+         */
+        BaseNode* createNode(const std::string& typeName, const std::string& name = "") const;
+
+        /**
+         * @brief Create an unconnected copy of a node with the same type, name and parameters
+         * @param node The node to copy
+         * @return The new node, or nullptr if the type is unknown or a parameter was rejected
+         */
+        BaseNode* cloneNode(const BaseNode& node) const;
+
+    private:
+        NodeRegistry() = default;
+        NodeRegistry(const NodeRegistry&) = delete;
+        NodeRegistry& operator=(const NodeRegistry&) = delete;
+
+        mutable std::mutex m_mutex;                             // Guards m_types
+        std::unordered_map<std::string, NodeTypeInfo> m_types;  // Registered types by identifier
+    };
+
+    /**
+     * @brief Helper that registers a node type during static initialization
+     *
+     * Declare one static instance per node type in the node's source file.
+     */
+    class NodeTypeRegistrar {
+    public:
+        explicit NodeTypeRegistrar(const NodeTypeInfo& info);
+    };
+
+}
@@ -1,8 +1,23 @@
 #include "output_node.h"
+#include "node_registry.h"
+#include "raw_image_file.h"
 #include <iostream>
 
 namespace image_processor {
 
+    // Register the node type for graph files and dynamic construction
+    static NodeTypeRegistrar s_outputNodeRegistrar({
+        "OutputNode",
+        "Output",
+        [](const std::string& name) -> BaseNode* { return new OutputNode(name); },
+        {
+            { "x", ParameterType::INT, 0, "Left edge of the region of the input to keep", 0.0 },
+            { "y", ParameterType::INT, 0, "Top edge of the region of the input to keep", 0.0 },
+            { "width", ParameterType::INT, 0, "Width of the region to keep, 0 with height 0 for the whole image", 0.0 },
+            { "height", ParameterType::INT, 0, "Height of the region to keep, 0 with width 0 for the whole image", 0.0 }
+        }
+    });
+
     OutputNode::OutputNode(const std::string& name)
         : BaseNode(name) {
     }
@@ -25,7 +40,19 @@ namespace image_processor {
             return;
         }
 
-        m_image = inputImage.clone();
+        if (m_region.empty()) {
+            m_image = inputImage.clone();
+            return;
+        }
+
+        // Pixels outside the region may not have been computed
+        cv::Rect region = m_region & cv::Rect(0, 0, inputImage.cols, inputImage.rows);
+        if (region.empty()) {
+            std::cerr << "OutputNode::process: Region lies outside the image." << std::endl;
+            m_image = cv::Mat();
+            return;
+        }
+        m_image = inputImage(region).clone();
     }
 
     int OutputNode::getInputCount() const {
@@ -47,13 +74,69 @@ namespace image_processor {
         return ""; // No outputs
     }
 
+    std::string OutputNode::getTypeName() const {
+        return "OutputNode";
+    }
+
+    int OutputNode::getRegionMargin(int inputIndex) const {
+        return 0;
+    }
+
+    cv::Rect OutputNode::getSinkRegion() const {
+        return m_region;
+    }
+
+    ParameterMap OutputNode::getParameters() const {
+        ParameterMap parameters;
+        parameters["x"] = m_region.x;
+        parameters["y"] = m_region.y;
+        parameters["width"] = m_region.width;
+        parameters["height"] = m_region.height;
+        return parameters;
+    }
+
+    bool OutputNode::setParameter(const std::string& name, const ParameterValue& value) {
+        int intValue = 0;
+        if (!parameterToInt(value, intValue) || intValue < 0) {
+            return false;
+        }
+
+        if (name == "x") {
+            m_region.x = intValue;
+            return true;
+        }
+        if (name == "y") {
+            m_region.y = intValue;
+            return true;
+        }
+        if (name == "width") {
+            m_region.width = intValue;
+            return true;
+        }
+        if (name == "height") {
+            m_region.height = intValue;
+            return true;
+        }
+        return false;
+    }
+
+    void OutputNode::setRegion(const cv::Rect& region) {
+        m_region = region;
+    }
+
+    cv::Rect OutputNode::getRegion() const {
+        return m_region;
+    }
+
     bool OutputNode::saveImage(const std::string& filePath) const {
         if (!hasValidImage()) {
             std::cerr << "OutputNode::saveImage: No valid image to save." << std::endl;
             return false;
         }
 
-        bool success = cv::imwrite(filePath, m_image);
+        bool success = RawImageFile::hasRawExtension(filePath)
+            ? RawImageFile::save(filePath, m_image)
+            : cv::imwrite(filePath, m_image);
         if (!success) {
             std::cerr << "OutputNode::saveImage: Failed to save image to " << filePath << std::endl;
         }
@@ -58,9 +58,60 @@ namespace image_processor {
          */
         virtual std::string getOutputName(int index) const override;
 
+        /**
+         * @brief Get the stable type identifier of this node
+         * @return Always returns "OutputNode"
+         */
+        virtual std::string getTypeName() const override;
+
+        /**
+         * @brief Get the margin of the input read around the region
+         * @param inputIndex The input index
+         * @return Always returns 0 as the image is cropped without filtering
+         */
+        virtual int getRegionMargin(int inputIndex) const override;
+
+        /**
+         * @brief Get the region this node requests from the graph
+         * @return The region set with setRegion
+         */
+        virtual cv::Rect getSinkRegion() const override;
+
+        /**
+         * @brief Get the region as parameters
+         * @return Map with the "x", "y", "width" and "height" of the region
+         */
+        virtual ParameterMap getParameters() const override;
+
+        /**
+         * @brief Set one coordinate of the region by name
+         * @param name "x", "y", "width" or "height"
+         * @param value The new coordinate, not negative
+         * @return True if the parameter was recognised and applied, false otherwise
+         */
+        virtual bool setParameter(const std::string& name, const ParameterValue& value) override;
+
+        /**
+         * @brief Keep only a region of the input image, such as a preview viewport
+         *
+         * The graph then computes only the pixels the region depends on, and
+         * the node stores the region cropped from its input. The region is
+         * also exposed as parameters, so clones and graph files keep it.
+         *
+         * @param region The region in input image coordinates (empty for the whole image)
+         */
+        void setRegion(const cv::Rect& region);
+
+        /**
+         * @brief Get the region of the input image that is kept
+         * @return The region, empty for the whole image
+         */
+        cv::Rect getRegion() const;
+
         /**
          * @brief Save the current image to a file
-         * @param filePath The path where the image should be saved
+         * @param filePath The path where the image should be saved; the ".ipr"
+         *        extension writes a raw image file (see RawImageFile)
          * @return True if the image was saved successfully, false otherwise
          */
         bool saveImage(const std::string& filePath) const;
@@ -84,7 +135,8 @@ namespace image_processor {
         virtual bool isReady() const override;
 
     private:
-        cv::Mat m_image;  // The output image
+        cv::Mat m_image;    // The output image
+        cv::Rect m_region;  // Region of the input to keep, empty for all
     };
 
 }
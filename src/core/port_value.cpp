@@ -0,0 +1,77 @@
+#include "port_value.h"
+
+namespace image_processor {
+
+    const char* portTypeToString(PortType type) {
+        switch (type) {
+        case PortType::IMAGE:
+            return "Image";
+        case PortType::SCALAR:
+            return "Scalar";
+        case PortType::HISTOGRAM:
+            return "Histogram";
+        case PortType::KERNEL:
+            return "Kernel";
+        case PortType::MASK:
+            return "Mask";
+        case PortType::VECTOR:
+            return "Vector";
+        }
+        return "Unknown";
+    }
+
+    bool arePortTypesCompatible(PortType outputType, PortType inputType) {
+        if (outputType == inputType) {
+            return true;
+        }
+
+        bool outputIsImage = outputType == PortType::IMAGE || outputType == PortType::MASK;
+        bool inputIsImage = inputType == PortType::IMAGE || inputType == PortType::MASK;
+        return outputIsImage && inputIsImage;
+    }
+
+    PortValue::PortValue()
+        : m_type(PortType::IMAGE) {
+    }
+
+    PortValue::PortValue(const cv::Mat& mat, PortType type)
+        : m_type(type), m_value(mat) {
+    }
+
+    PortValue::PortValue(double scalar)
+        : m_type(PortType::SCALAR), m_value(scalar) {
+    }
+
+    PortType PortValue::getType() const {
+        return m_type;
+    }
+
+    bool PortValue::empty() const {
+        if (std::holds_alternative<std::monostate>(m_value)) {
+            return true;
+        }
+        if (const cv::Mat* mat = std::get_if<cv::Mat>(&m_value)) {
+            return mat->empty();
+        }
+        return false;
+    }
+
+    bool PortValue::isScalar() const {
+        return std::holds_alternative<double>(m_value);
+    }
+
+    double PortValue::getScalar(double defaultValue) const {
+        if (const double* scalar = std::get_if<double>(&m_value)) {
+            return *scalar;
+        }
+        return defaultValue;
+    }
+
+    cv::Mat PortValue::getMat() const {
+        if (const cv::Mat* mat = std::get_if<cv::Mat>(&m_value)) {
+            return *mat;
+        }
+        return cv::Mat();
+    }
+
+}
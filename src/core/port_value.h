@@ -0,0 +1,103 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <variant>
+
+namespace image_processor {
+
+    /**
+     * @brief Kind of data carried by a node port
+     */
+    enum class PortType {
+        IMAGE,      // Image of any depth and channel count
+        SCALAR,     // Single number (e.g. a computed threshold)
+        HISTOGRAM,  // Single-row CV_32F matrix of bin counts
+        KERNEL,     // Single-channel convolution kernel
+        MASK,       // Single-channel 8-bit mask
+        VECTOR      // Single-row CV_64F matrix of numbers (e.g. several thresholds)
+    };
+
+    /**
+     * @brief Get the display name of a port type
+     * @param type The port type
+     * @return The name (e.g. "Image")
+     */
+    const char* portTypeToString(PortType type);
+
+    /**
+     * @brief Check if an output of one type may feed an input of another
+     *
+     * Types must match, except that images and masks are interchangeable
+     * since a mask is stored as an ordinary 8-bit image.
+     *
+     * @param outputType The type of the producing output
+     * @param inputType The type of the consuming input
+     * @return True if the connection is allowed, false otherwise
+     */
+    bool arePortTypesCompatible(PortType outputType, PortType inputType);
+
+    /**
+     * @brief Value produced by a node output
+     *
+     * Scalars are stored inline so that passing small results between nodes
+     * does not allocate a cv::Mat. Matrix-based values share their data with
+     * the producer, like any cv::Mat copy.
+     */
+    class PortValue {
+    public:
+        /**
+         * @brief Construct an empty value
+         */
+        PortValue();
+
+        /**
+         * @brief Construct a matrix-based value
+         * @param mat The matrix (data is shared, not copied)
+         * @param type The port type of the matrix (default: IMAGE)
+         */
+        PortValue(const cv::Mat& mat, PortType type = PortType::IMAGE);
+
+        /**
+         * @brief Construct a scalar value
+         * @param scalar The scalar
+         */
+        explicit PortValue(double scalar);
+
+        /**
+         * @brief Get the port type of the value
+         * @return The port type
+         */
+        PortType getType() const;
+
+        /**
+         * @brief Check if the value holds nothing (or an empty matrix)
+         * @return True if the value is empty, false otherwise
+         */
+        bool empty() const;
+
+        /**
+         * @brief Check if the value holds a scalar
+         * @return True if the value is a scalar, false otherwise
+         */
+        bool isScalar() const;
+
+        /**
+         * @brief Get the scalar value
+         * @param defaultValue Value returned if this is not a scalar
+         * @return The scalar, or defaultValue
+         */
+        double getScalar(double defaultValue = 0.0) const;
+
+        /**
+         * @brief Get the matrix of a matrix-based value
+         * @return The matrix, or an empty matrix for scalar and empty values
+         */
+        cv::Mat getMat() const;
+
+    private:
+        PortType m_type;                                        // Port type of the value
+        std::variant<std::monostate, double, cv::Mat> m_value;  // Stored value
+    };
+
+}
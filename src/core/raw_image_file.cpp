@@ -0,0 +1,279 @@
+#include "raw_image_file.h"
+#include "mapped_file.h"
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace image_processor {
+
+    // Identification of the raw image format
+    static const char RAW_IMAGE_MAGIC[4] = { 'I', 'P', 'R', 'I' };
+    static const uint32_t RAW_IMAGE_VERSION = 1;
+
+    // Extension of raw image files
+    static const char* const RAW_IMAGE_EXTENSION = ".ipr";
+
+    // Alignment of the pixel data in the file, so the rows start on a page of the mapping
+    static const uint64_t RAW_IMAGE_DATA_ALIGNMENT = 4096;
+
+    struct RawImageHeader {
+        char magic[4];
+        uint32_t version;
+        int32_t rows;
+        int32_t cols;
+        int32_t type;         // OpenCV type, including the channel count
+        uint32_t reserved;
+        uint64_t step;        // Bytes from one row to the next
+        uint64_t dataOffset;  // Position of the first row in the file
+    };
+
+    // Read and check the header of a raw image file
+    static bool readHeader(std::istream& file, const std::string& filePath, RawImageHeader& header, const char* caller) {
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+            std::memcmp(header.magic, RAW_IMAGE_MAGIC, sizeof(RAW_IMAGE_MAGIC)) != 0) {
+            std::cerr << caller << ": " << filePath << " is not a raw image file." << std::endl;
+            return false;
+        }
+        if (header.version != RAW_IMAGE_VERSION) {
+            std::cerr << caller << ": " << filePath << " has unsupported version " << header.version << "." << std::endl;
+            return false;
+        }
+
+        const int type = header.type;
+        if (header.rows <= 0 || header.cols <= 0 || type != CV_MAT_TYPE(type) || CV_MAT_DEPTH(type) > CV_16F ||
+            header.step < static_cast<uint64_t>(header.cols) * CV_ELEM_SIZE(type) || header.step % CV_ELEM_SIZE1(type) != 0 ||
+            header.dataOffset < sizeof(header)) {
+            std::cerr << caller << ": " << filePath << " has an invalid header." << std::endl;
+            return false;
+        }
+
+        // Compare by division, as step and dataOffset come from the file and the product can wrap
+        std::error_code error;
+        const uint64_t fileSize = std::filesystem::file_size(filePath, error);
+        if (error || fileSize < header.dataOffset ||
+            header.step > (fileSize - header.dataOffset) / static_cast<uint64_t>(header.rows)) {
+            std::cerr << caller << ": " << filePath << " is truncated." << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // Reads the rows of a raw image file with plain file reads
+    class RawStripReader : public ImageStripReader {
+    public:
+        bool open(const std::string& filePath) {
+            m_file.open(filePath, std::ios::binary);
+            if (!m_file) {
+                std::cerr << "RawImageFile::openStrips: Failed to open " << filePath << "." << std::endl;
+                return false;
+            }
+            m_filePath = filePath;
+            return readHeader(m_file, filePath, m_header, "RawImageFile::openStrips");
+        }
+
+        cv::Size getSize() const override {
+            return cv::Size(m_header.cols, m_header.rows);
+        }
+
+        int getType() const override {
+            return m_header.type;
+        }
+
+        bool readRows(int firstRow, int rowCount, cv::Mat& rows) override {
+            if (firstRow < 0 || rowCount <= 0 || firstRow + rowCount > m_header.rows) {
+                std::cerr << "RawStripReader::readRows: Rows " << firstRow << " to " << firstRow + rowCount
+                    << " are not in " << m_filePath << "." << std::endl;
+                return false;
+            }
+
+            rows.create(rowCount, m_header.cols, m_header.type);
+            const uint64_t rowBytes = static_cast<uint64_t>(m_header.cols) * rows.elemSize();
+            m_file.clear();
+            m_file.seekg(static_cast<std::streamoff>(m_header.dataOffset + m_header.step * firstRow));
+            if (m_header.step == rowBytes && rows.isContinuous()) {
+                m_file.read(reinterpret_cast<char*>(rows.data), static_cast<std::streamsize>(rowBytes * rowCount));
+            }
+            else {
+                for (int y = 0; y < rowCount && m_file; ++y) {
+                    m_file.seekg(static_cast<std::streamoff>(m_header.dataOffset + m_header.step * (firstRow + y)));
+                    m_file.read(reinterpret_cast<char*>(rows.ptr(y)), static_cast<std::streamsize>(rowBytes));
+                }
+            }
+            if (!m_file) {
+                std::cerr << "RawStripReader::readRows: Failed to read " << m_filePath << "." << std::endl;
+                return false;
+            }
+            return true;
+        }
+
+    private:
+        std::ifstream m_file;     // The open file
+        std::string m_filePath;   // Path of the file, for messages
+        RawImageHeader m_header;  // Header of the file
+    };
+
+    // Writes the rows of a raw image file as they arrive, behind a header written up front
+    class RawStripWriter : public ImageStripWriter {
+    public:
+        RawStripWriter()
+            : m_rowsWritten(0), m_finished(false) {
+            std::memset(&m_header, 0, sizeof(m_header));
+        }
+
+        ~RawStripWriter() override {
+            if (!m_finished && !m_temporaryPath.empty()) {
+                m_file.close();
+                std::error_code error;
+                std::filesystem::remove(m_temporaryPath, error);
+            }
+        }
+
+        bool create(const std::string& filePath, cv::Size size, int type) {
+            // Rows are stored without padding, so a mapped image is continuous
+            std::memcpy(m_header.magic, RAW_IMAGE_MAGIC, sizeof(RAW_IMAGE_MAGIC));
+            m_header.version = RAW_IMAGE_VERSION;
+            m_header.rows = size.height;
+            m_header.cols = size.width;
+            m_header.type = type;
+            m_header.step = static_cast<uint64_t>(size.width) * CV_ELEM_SIZE(type);
+            m_header.dataOffset = (sizeof(m_header) + RAW_IMAGE_DATA_ALIGNMENT - 1) / RAW_IMAGE_DATA_ALIGNMENT * RAW_IMAGE_DATA_ALIGNMENT;
+
+            m_filePath = filePath;
+            m_temporaryPath = temporaryPathFor(filePath);
+            m_file.open(m_temporaryPath, std::ios::binary | std::ios::trunc);
+            m_file.write(reinterpret_cast<const char*>(&m_header), sizeof(m_header));
+            m_file.seekp(static_cast<std::streamoff>(m_header.dataOffset));
+            if (!m_file) {
+                std::cerr << "RawImageFile::createStrips: Failed to create " << m_temporaryPath.string() << "." << std::endl;
+                return false;
+            }
+            return true;
+        }
+
+        bool writeRows(const cv::Mat& rows) override {
+            if (m_finished) {
+                std::cerr << "RawStripWriter::writeRows: " << m_filePath << " is already finished." << std::endl;
+                return false;
+            }
+            if (rows.type() != m_header.type || rows.cols != m_header.cols || rows.dims > 2) {
+                std::cerr << "RawStripWriter::writeRows: Rows do not have the width and type of " << m_filePath << "." << std::endl;
+                return false;
+            }
+            if (m_rowsWritten + rows.rows > m_header.rows) {
+                std::cerr << "RawStripWriter::writeRows: Rows extend past the bottom of " << m_filePath << "." << std::endl;
+                return false;
+            }
+
+            if (rows.isContinuous()) {
+                m_file.write(reinterpret_cast<const char*>(rows.data), static_cast<std::streamsize>(m_header.step * rows.rows));
+            }
+            else {
+                for (int y = 0; y < rows.rows && m_file; ++y) {
+                    m_file.write(reinterpret_cast<const char*>(rows.ptr(y)), static_cast<std::streamsize>(m_header.step));
+                }
+            }
+            if (!m_file) {
+                std::cerr << "RawStripWriter::writeRows: Failed to write " << m_temporaryPath.string() << "." << std::endl;
+                return false;
+            }
+            m_rowsWritten += rows.rows;
+            return true;
+        }
+
+        bool finish() override {
+            if (m_finished) {
+                return true;
+            }
+            if (m_rowsWritten != m_header.rows) {
+                std::cerr << "RawStripWriter::finish: Only " << m_rowsWritten << " of " << m_header.rows
+                    << " rows of " << m_filePath << " were written." << std::endl;
+                return false;
+            }
+
+            m_file.close();
+            if (!m_file) {
+                std::cerr << "RawStripWriter::finish: Failed to write " << m_temporaryPath.string() << "." << std::endl;
+                return false;
+            }
+            std::error_code error;
+            std::filesystem::rename(m_temporaryPath, m_filePath, error);
+            if (error) {
+                std::cerr << "RawStripWriter::finish: Failed to rename " << m_temporaryPath.string() << " to " << m_filePath << "." << std::endl;
+                return false;
+            }
+            m_finished = true;
+            return true;
+        }
+
+    private:
+        std::string m_filePath;                 // Path the file appears under once finished
+        std::filesystem::path m_temporaryPath;  // Path the file is written under
+        std::ofstream m_file;                   // The file being written
+        RawImageHeader m_header;                // Header of the file
+        int m_rowsWritten;                      // Rows written so far
+        bool m_finished;                        // Whether the file is complete
+    };
+
+    bool RawImageFile::hasRawExtension(const std::string& filePath) {
+        return std::filesystem::path(filePath).extension() == RAW_IMAGE_EXTENSION;
+    }
+
+    bool RawImageFile::isRawImage(const std::string& filePath) {
+        std::ifstream file(filePath, std::ios::binary);
+        char magic[sizeof(RAW_IMAGE_MAGIC)];
+        return file.read(magic, sizeof(magic)) && std::memcmp(magic, RAW_IMAGE_MAGIC, sizeof(magic)) == 0;
+    }
+
+    bool RawImageFile::save(const std::string& filePath, const cv::Mat& image) {
+        if (image.empty()) {
+            std::cerr << "RawImageFile::save: Cannot save empty image." << std::endl;
+            return false;
+        }
+        if (image.dims > 2) {
+            std::cerr << "RawImageFile::save: Only two-dimensional images can be saved." << std::endl;
+            return false;
+        }
+
+        RawStripWriter writer;
+        return writer.create(filePath, image.size(), image.type()) && writer.writeRows(image) && writer.finish();
+    }
+
+    bool RawImageFile::map(const std::string& filePath, cv::Mat& image) {
+        RawImageHeader header;
+        {
+            std::ifstream file(filePath, std::ios::binary);
+            if (!file) {
+                std::cerr << "RawImageFile::map: Failed to open " << filePath << "." << std::endl;
+                return false;
+            }
+            if (!readHeader(file, filePath, header, "RawImageFile::map")) {
+                return false;
+            }
+        }
+
+        if (!mapImageFile(filePath, header.dataOffset, header.rows, header.cols, header.type, header.step, image)) {
+            std::cerr << "RawImageFile::map: Failed to map " << filePath << "." << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    std::unique_ptr<ImageStripReader> RawImageFile::openStrips(const std::string& filePath) {
+        std::unique_ptr<RawStripReader> reader(new RawStripReader());
+        if (!reader->open(filePath)) {
+            return nullptr;
+        }
+        return reader;
+    }
+
+    std::unique_ptr<ImageStripWriter> RawImageFile::createStrips(const std::string& filePath, cv::Size size, int type) {
+        std::unique_ptr<RawStripWriter> writer(new RawStripWriter());
+        if (!writer->create(filePath, size, type)) {
+            return nullptr;
+        }
+        return writer;
+    }
+
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "image_strips.h"
+#include <opencv2/opencv.hpp>
+#include <memory>
+#include <string>
+
+namespace image_processor {
+
+    /**
+     * @brief Reads and writes images in an uncompressed, memory-mappable format
+     *
+     * Meant for intermediates handed from one process to the next, where
+     * encoding PNG or JPEG costs far more than the processing itself. A file
+     * holds a small header (size, OpenCV type and row stride, in host byte
+     * order behind the "IPRI" magic) followed by the pixel rows, starting at
+     * a page boundary.
+     *
+     * Opening a file maps it into memory instead of reading it: the returned
+     * cv::Mat points into the mapping and unmaps it when its last reference
+     * is released, so even very large images open immediately and pages are
+     * read only as they are used. The mapping is copy-on-write, so writing to
+     * the image never modifies the file.
+     *
+     * Files are written under a temporary name and renamed, so a reader never
+     * sees a partial file and an image that is already open keeps its data
+     * when the file is replaced. Files can also be read and written a band
+     * of rows at a time (openStrips, createStrips).
+     */
+    class RawImageFile {
+    public:
+        /**
+         * @brief Check whether a path has the extension of raw image files (".ipr")
+         * @param filePath The path
+         * @return True if the path should be written as a raw image file
+         */
+        static bool hasRawExtension(const std::string& filePath);
+
+        /**
+         * @brief Check whether a file is a raw image file, regardless of its extension
+         * @param filePath The path of the file
+         * @return True if the file starts with the magic of the format
+         */
+        static bool isRawImage(const std::string& filePath);
+
+        /**
+         * @brief Write an image
+         * @param filePath The path of the file, replaced if it exists
+         * @param image The image (any type, need not be continuous)
+         * @return True if the file was written, false otherwise
+         */
+        static bool save(const std::string& filePath, const cv::Mat& image);
+
+        /**
+         * @brief Open an image by mapping its file into memory
+         * @param filePath The path of the file
+         * @param image Receives the image, which shares the mapped pages
+         * @return True if the file was mapped, false otherwise
+         */
+        static bool map(const std::string& filePath, cv::Mat& image);
+
+        /**
+         * @brief Open a file to read it a band of rows at a time
+         * @param filePath The path of the file
+         * @return The reader, or nullptr if the file is not a valid raw image file
+         */
+        static std::unique_ptr<ImageStripReader> openStrips(const std::string& filePath);
+
+        /**
+         * @brief Create a file to write it a band of rows at a time
+         * @param filePath The path of the file, replaced once the writer finishes
+         * @param size The size of the whole image
+         * @param type The OpenCV type of the image
+         * @return The writer, or nullptr if the file cannot be created
+         */
+        static std::unique_ptr<ImageStripWriter> createStrips(const std::string& filePath, cv::Size size, int type);
+    };
+
+}
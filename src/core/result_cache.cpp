@@ -0,0 +1,483 @@
+#include "result_cache.h"
+#include "image_strips.h"
+#include "mapped_file.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <type_traits>
+#ifdef IMAGE_PROCESSOR_WITH_LZ4
+#include <lz4.h>
+#endif
+
+namespace image_processor {
+
+    // Identification of the cache file format
+    static const char CACHE_MAGIC[4] = { 'I', 'P', 'R', 'C' };
+    static const uint32_t CACHE_VERSION = 2;
+
+    // Extension of complete cache files
+    static const char* const CACHE_EXTENSION = ".ipc";
+
+    // Alignment of the output data in a cache file, so it can be memory mapped
+    static const uint64_t CACHE_DATA_ALIGNMENT = 4096;
+
+    // Kinds of stored port values
+    static const uint32_t CACHE_VALUE_EMPTY = 0;
+    static const uint32_t CACHE_VALUE_SCALAR = 1;
+    static const uint32_t CACHE_VALUE_MAT = 2;
+
+    struct CacheFileHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t outputCount;
+        uint32_t reserved;
+        uint64_t key;          // Key the entry was stored under
+    };
+
+    struct CacheValueHeader {
+        uint32_t portType;
+        uint32_t kind;         // CACHE_VALUE_EMPTY, CACHE_VALUE_SCALAR or CACHE_VALUE_MAT
+        double scalar;
+        int32_t rows;
+        int32_t cols;
+        int32_t type;
+        uint32_t compressed;   // 1 if the data is LZ4 compressed
+        uint64_t offset;       // Position of the data in the file
+        uint64_t storedBytes;  // Size of the data in the file
+        uint64_t rawBytes;     // Size of the pixel data
+    };
+
+    // Whether a stored value is consistent with a file of the given size. Files
+    // may come from other processes, so this is checked before allocating.
+    static bool isValidEntry(const CacheValueHeader& entry, uint64_t fileSize) {
+        if (entry.portType > static_cast<uint32_t>(PortType::VECTOR)) {
+            return false;
+        }
+        if (entry.kind == CACHE_VALUE_EMPTY || entry.kind == CACHE_VALUE_SCALAR) {
+            return true;
+        }
+        if (entry.kind != CACHE_VALUE_MAT || entry.rows <= 0 || entry.cols <= 0 ||
+            entry.type < 0 || entry.type != CV_MAT_TYPE(entry.type) || CV_MAT_DEPTH(entry.type) > CV_16F) {
+            return false;
+        }
+
+        const uint64_t pixels = static_cast<uint64_t>(entry.rows) * static_cast<uint64_t>(entry.cols);
+        const uint64_t elemSize = CV_ELEM_SIZE(entry.type);
+        if (pixels > std::numeric_limits<uint64_t>::max() / elemSize || entry.rawBytes != pixels * elemSize) {
+            return false;
+        }
+        if (entry.compressed) {
+            // LZ4 sizes are ints
+            const uint64_t maxSize = static_cast<uint64_t>(std::numeric_limits<int>::max());
+            if (entry.rawBytes > maxSize || entry.storedBytes > maxSize) {
+                return false;
+            }
+        }
+        else if (entry.storedBytes != entry.rawBytes) {
+            return false;
+        }
+        return entry.storedBytes <= fileSize && entry.offset <= fileSize - entry.storedBytes;
+    }
+
+    // Mixing constants of MurmurHash3 (x64)
+    static const uint64_t HASH_C1 = 0x87c37b91114253d5ULL;
+    static const uint64_t HASH_C2 = 0x4cf5ad432745937fULL;
+
+    static uint64_t rotateLeft(uint64_t value, int bits) {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    static uint64_t mixWord(uint64_t state, uint64_t word) {
+        word *= HASH_C1;
+        word = rotateLeft(word, 31);
+        word *= HASH_C2;
+        state ^= word;
+        return rotateLeft(state, 27) * 5 + 0x52dce729;
+    }
+
+    ContentHasher::ContentHasher()
+        : m_state(0x9e3779b97f4a7c15ULL), m_length(0) {
+    }
+
+    void ContentHasher::add(const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        size_t position = 0;
+        for (; position + 8 <= size; position += 8) {
+            uint64_t word;
+            std::memcpy(&word, bytes + position, 8);
+            m_state = mixWord(m_state, word);
+        }
+        if (position < size) {
+            uint64_t word = 0;
+            std::memcpy(&word, bytes + position, size - position);
+            m_state = mixWord(m_state, word);
+        }
+        m_length += size;
+    }
+
+    void ContentHasher::add(uint64_t value) {
+        add(&value, sizeof(value));
+    }
+
+    void ContentHasher::add(const std::string& value) {
+        add(static_cast<uint64_t>(value.size()));
+        add(value.data(), value.size());
+    }
+
+    void ContentHasher::add(const cv::Mat& image) {
+        add(static_cast<uint64_t>(image.type()));
+        add(static_cast<uint64_t>(image.rows));
+        add(static_cast<uint64_t>(image.cols));
+        const size_t rowBytes = image.cols * image.elemSize();
+        for (int y = 0; y < image.rows; ++y) {
+            add(image.ptr(y), rowBytes);
+        }
+    }
+
+    void ContentHasher::add(const ParameterValue& value) {
+        add(static_cast<uint64_t>(value.index()));
+        std::visit([this](const auto& v) {
+            using T = std::decay_t<decltype(v)>;
+            if constexpr (std::is_same_v<T, int> || std::is_same_v<T, bool>) {
+                add(static_cast<uint64_t>(static_cast<int64_t>(v)));
+            }
+            else if constexpr (std::is_same_v<T, double>) {
+                add(&v, sizeof(v));
+            }
+            else {
+                add(v);
+            }
+        }, value);
+    }
+
+    uint64_t ContentHasher::digest() const {
+        // Finalizer of MurmurHash3, so every input bit affects every output bit
+        uint64_t hash = m_state ^ m_length;
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 33;
+        hash *= 0xc4ceb9fe1a85ec53ULL;
+        hash ^= hash >> 33;
+        return hash;
+    }
+
+    ResultCache::ResultCache(const std::string& directory, uint64_t maxBytes)
+        : m_directory(directory), m_maxBytes(maxBytes), m_sizeBytes(0), m_compression(false), m_valid(false) {
+        std::error_code error;
+        std::filesystem::create_directories(m_directory, error);
+        if (error || !std::filesystem::is_directory(m_directory, error)) {
+            std::cerr << "ResultCache::ResultCache: Cannot use cache directory " << directory << "." << std::endl;
+            return;
+        }
+        m_valid = true;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        trim();
+    }
+
+    bool ResultCache::isValid() const {
+        return m_valid;
+    }
+
+    bool ResultCache::load(uint64_t key, std::vector<PortValue>& values) {
+        if (!m_valid) {
+            return false;
+        }
+
+        // Entries are replaced by renaming, so reading needs no lock
+        const std::filesystem::path path = entryPath(key);
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            return false;
+        }
+
+        CacheFileHeader header;
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+            std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || header.version != CACHE_VERSION) {
+            std::cerr << "ResultCache::load: Ignoring invalid cache file " << path.string() << "." << std::endl;
+            return false;
+        }
+
+        if (header.key != key) {
+            std::cerr << "ResultCache::load: Ignoring cache file " << path.string() << " stored for another key." << std::endl;
+            return false;
+        }
+
+        // The headers of all outputs must fit in the file
+        std::error_code error;
+        const uint64_t fileSize = std::filesystem::file_size(path, error);
+        if (error || fileSize < sizeof(header) ||
+            header.outputCount > (fileSize - sizeof(header)) / sizeof(CacheValueHeader)) {
+            std::cerr << "ResultCache::load: Ignoring truncated cache file " << path.string() << "." << std::endl;
+            return false;
+        }
+
+        std::vector<CacheValueHeader> entries(header.outputCount);
+        if (!file.read(reinterpret_cast<char*>(entries.data()), entries.size() * sizeof(CacheValueHeader))) {
+            std::cerr << "ResultCache::load: Ignoring truncated cache file " << path.string() << "." << std::endl;
+            return false;
+        }
+
+        for (const CacheValueHeader& entry : entries) {
+            if (!isValidEntry(entry, fileSize)) {
+                std::cerr << "ResultCache::load: Ignoring inconsistent cache file " << path.string() << "." << std::endl;
+                return false;
+            }
+        }
+
+        std::vector<PortValue> loaded;
+        for (const CacheValueHeader& entry : entries) {
+            const PortType portType = static_cast<PortType>(entry.portType);
+            if (entry.kind == CACHE_VALUE_EMPTY) {
+                loaded.push_back(PortValue());
+                continue;
+            }
+            if (entry.kind == CACHE_VALUE_SCALAR) {
+                loaded.push_back(PortValue(entry.scalar));
+                continue;
+            }
+
+            // Uncompressed outputs are mapped rather than read, so only the rows used are paged in
+            cv::Mat mat;
+            if (!entry.compressed) {
+                const uint64_t step = static_cast<uint64_t>(entry.cols) * CV_ELEM_SIZE(entry.type);
+                if (!mapImageFile(path.string(), entry.offset, entry.rows, entry.cols, entry.type, step, mat)) {
+                    std::cerr << "ResultCache::load: Failed to map cache file " << path.string() << "." << std::endl;
+                    return false;
+                }
+            }
+            else {
+#ifdef IMAGE_PROCESSOR_WITH_LZ4
+                mat.create(entry.rows, entry.cols, entry.type);
+                std::vector<char> stored(entry.storedBytes);
+                file.seekg(static_cast<std::streamoff>(entry.offset));
+                if (!file.read(stored.data(), stored.size()) ||
+                    LZ4_decompress_safe(stored.data(), reinterpret_cast<char*>(mat.data),
+                        static_cast<int>(entry.storedBytes), static_cast<int>(entry.rawBytes)) != static_cast<int>(entry.rawBytes)) {
+                    std::cerr << "ResultCache::load: Ignoring corrupt cache file " << path.string() << "." << std::endl;
+                    return false;
+                }
+#else
+                std::cerr << "ResultCache::load: Cache file " << path.string() << " is compressed, but LZ4 support is not built in." << std::endl;
+                return false;
+#endif
+            }
+            loaded.push_back(PortValue(mat, portType));
+        }
+
+        // The modification time orders the entries for eviction
+        std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), error);
+
+        values = std::move(loaded);
+        return true;
+    }
+
+    bool ResultCache::store(uint64_t key, const std::vector<PortValue>& values) {
+        if (!m_valid) {
+            return false;
+        }
+
+        // Lay out the data of every output at a page boundary after the headers
+        std::vector<CacheValueHeader> entries(values.size());
+        std::vector<cv::Mat> mats(values.size());
+        std::vector<std::vector<char>> compressed(values.size());
+        uint64_t offset = sizeof(CacheFileHeader) + values.size() * sizeof(CacheValueHeader);
+        for (size_t i = 0; i < values.size(); ++i) {
+            CacheValueHeader& entry = entries[i];
+            std::memset(&entry, 0, sizeof(entry));
+            entry.portType = static_cast<uint32_t>(values[i].getType());
+
+            if (values[i].isScalar()) {
+                entry.kind = CACHE_VALUE_SCALAR;
+                entry.scalar = values[i].getScalar();
+                continue;
+            }
+            cv::Mat mat = values[i].getMat();
+            if (mat.empty()) {
+                entry.kind = CACHE_VALUE_EMPTY;
+                continue;
+            }
+            if (!mat.isContinuous()) {
+                mat = mat.clone();
+            }
+
+            entry.kind = CACHE_VALUE_MAT;
+            entry.rows = mat.rows;
+            entry.cols = mat.cols;
+            entry.type = mat.type();
+            entry.rawBytes = mat.total() * mat.elemSize();
+            entry.storedBytes = entry.rawBytes;
+#ifdef IMAGE_PROCESSOR_WITH_LZ4
+            if (m_compression && entry.rawBytes <= static_cast<uint64_t>(LZ4_MAX_INPUT_SIZE)) {
+                // Keep the compressed form only when it is smaller
+                const int rawSize = static_cast<int>(entry.rawBytes);
+                compressed[i].resize(LZ4_compressBound(rawSize));
+                int size = LZ4_compress_default(reinterpret_cast<const char*>(mat.data), compressed[i].data(),
+                    rawSize, static_cast<int>(compressed[i].size()));
+                if (size > 0 && size < rawSize) {
+                    compressed[i].resize(size);
+                    entry.compressed = 1;
+                    entry.storedBytes = size;
+                }
+                else {
+                    compressed[i].clear();
+                }
+            }
+#endif
+            offset = (offset + CACHE_DATA_ALIGNMENT - 1) / CACHE_DATA_ALIGNMENT * CACHE_DATA_ALIGNMENT;
+            entry.offset = offset;
+            offset += entry.storedBytes;
+            mats[i] = mat;
+        }
+
+        CacheFileHeader header;
+        std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+        header.version = CACHE_VERSION;
+        header.outputCount = static_cast<uint32_t>(values.size());
+        header.reserved = 0;
+        header.key = key;
+
+        // Write under a name of this process and thread and rename, so readers never see a partial file
+        const std::filesystem::path path = entryPath(key);
+        const std::filesystem::path temporaryPath = temporaryPathFor(path);
+        {
+            std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(CacheValueHeader));
+            for (size_t i = 0; i < values.size(); ++i) {
+                if (entries[i].kind != CACHE_VALUE_MAT) {
+                    continue;
+                }
+                file.seekp(static_cast<std::streamoff>(entries[i].offset));
+                if (entries[i].compressed) {
+                    file.write(compressed[i].data(), compressed[i].size());
+                }
+                else {
+                    file.write(reinterpret_cast<const char*>(mats[i].data), entries[i].rawBytes);
+                }
+            }
+            if (!file) {
+                std::cerr << "ResultCache::store: Failed to write cache file " << temporaryPath.string() << "." << std::endl;
+                file.close();
+                std::error_code error;
+                std::filesystem::remove(temporaryPath, error);
+                return false;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::error_code error;
+        const uint64_t previousSize = std::filesystem::exists(path, error) ? std::filesystem::file_size(path, error) : 0;
+        std::filesystem::rename(temporaryPath, path, error);
+        if (error) {
+            std::cerr << "ResultCache::store: Failed to rename cache file to " << path.string() << "." << std::endl;
+            std::filesystem::remove(temporaryPath, error);
+            return false;
+        }
+
+        m_sizeBytes = m_sizeBytes - std::min(m_sizeBytes, previousSize) + offset;
+        if (m_sizeBytes > m_maxBytes) {
+            trim();
+        }
+        return true;
+    }
+
+    void ResultCache::clear() {
+        if (!m_valid) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::error_code error;
+        for (const auto& file : std::filesystem::directory_iterator(m_directory, error)) {
+            if (file.path().extension() == CACHE_EXTENSION) {
+                std::filesystem::remove(file.path(), error);
+            }
+        }
+        m_sizeBytes = 0;
+    }
+
+    bool ResultCache::setCompression(bool enabled) {
+#ifdef IMAGE_PROCESSOR_WITH_LZ4
+        m_compression = enabled;
+        return true;
+#else
+        if (enabled) {
+            std::cerr << "ResultCache::setCompression: LZ4 support is not built in." << std::endl;
+            return false;
+        }
+        m_compression = false;
+        return true;
+#endif
+    }
+
+    bool ResultCache::isCompressionEnabled() const {
+        return m_compression;
+    }
+
+    void ResultCache::setMaxBytes(uint64_t maxBytes) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_maxBytes = maxBytes;
+        if (m_valid && m_sizeBytes > m_maxBytes) {
+            trim();
+        }
+    }
+
+    uint64_t ResultCache::getMaxBytes() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_maxBytes;
+    }
+
+    uint64_t ResultCache::getSizeBytes() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_sizeBytes;
+    }
+
+    std::filesystem::path ResultCache::entryPath(uint64_t key) const {
+        char name[17];
+        std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(key));
+        return m_directory / (std::string(name) + CACHE_EXTENSION);
+    }
+
+    void ResultCache::trim() {
+        struct CacheFile {
+            std::filesystem::path path;
+            std::filesystem::file_time_type lastUse;
+            uint64_t size;
+        };
+
+        // Rescan the directory, since other processes may share it
+        std::vector<CacheFile> files;
+        uint64_t total = 0;
+        std::error_code error;
+        for (const auto& file : std::filesystem::directory_iterator(m_directory, error)) {
+            if (file.path().extension() != CACHE_EXTENSION) {
+                continue;
+            }
+            std::error_code fileError;
+            CacheFile entry = { file.path(), file.last_write_time(fileError), file.file_size(fileError) };
+            if (!fileError) {
+                files.push_back(entry);
+                total += entry.size;
+            }
+        }
+
+        // Delete the least recently used files first
+        std::sort(files.begin(), files.end(),
+            [](const CacheFile& a, const CacheFile& b) { return a.lastUse < b.lastUse; });
+        for (const CacheFile& file : files) {
+            if (total <= m_maxBytes) {
+                break;
+            }
+            if (std::filesystem::remove(file.path, error)) {
+                total -= file.size;
+            }
+        }
+
+        m_sizeBytes = total;
+    }
+
+}
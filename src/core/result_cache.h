@@ -0,0 +1,182 @@
+#pragma once
+
+#include "node_parameters.h"
+#include "port_value.h"
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace image_processor {
+
+    // Version of the results computed by the nodes of this build, mixed into
+    // every cache key. Increase it whenever a node computes different outputs
+    // for the same inputs and parameters, so that persistent caches written
+    // by older builds are not served after an upgrade.
+    static const uint64_t RESULT_CACHE_ALGORITHM_VERSION = 1;
+
+    /**
+     * @brief 64-bit hash of node types, parameters and image content
+     *
+     * Builds the keys of the result cache. Values are mixed in the order
+     * they are added, so the same sequence always gives the same digest on
+     * every run and machine of the same byte order.
+     */
+    class ContentHasher {
+    public:
+        /**
+         * @brief Constructor
+         */
+        ContentHasher();
+
+        /**
+         * @brief Add raw bytes
+         * @param data Pointer to the bytes
+         * @param size Number of bytes
+         */
+        void add(const void* data, size_t size);
+
+        /**
+         * @brief Add a number
+         * @param value The value
+         */
+        void add(uint64_t value);
+
+        /**
+         * @brief Add a string, including its length
+         * @param value The string
+         */
+        void add(const std::string& value);
+
+        /**
+         * @brief Add the type, size and pixels of an image
+         * @param image The image (need not be continuous)
+         */
+        void add(const cv::Mat& image);
+
+        /**
+         * @brief Add a parameter value, including its type
+         * @param value The parameter value
+         */
+        void add(const ParameterValue& value);
+
+        /**
+         * @brief Get the hash of everything added so far
+         * @return The 64-bit digest
+         */
+        uint64_t digest() const;
+
+    private:
+        uint64_t m_state;   // Running hash
+        uint64_t m_length;  // Number of bytes added
+    };
+
+    /**
+     * @brief On-disk cache of node outputs, shared across runs and processes
+     *
+     * Entries are keyed by a ContentHasher digest of the upstream subgraph
+     * (see NodeGraph::setResultCache) and stored as one file each. The file
+     * holds a small header and the raw pixel data of every output, each
+     * starting at a page boundary. Loading maps uncompressed outputs
+     * copy-on-write instead of reading them. With LZ4 compression enabled
+     * (builds with IMAGE_PROCESSOR_WITH_LZ4) outputs are compressed instead
+     * when that makes them smaller, and are decompressed when loaded. The
+     * header repeats the key, and files whose key does not match their name
+     * are ignored.
+     *
+     * The cache keeps its files within a size budget by deleting the least
+     * recently used ones; loading an entry marks it as used. Files are
+     * written under a temporary name and renamed, so a crashed or concurrent
+     * writer never leaves a partial entry behind.
+     */
+    class ResultCache {
+    public:
+        /**
+         * @brief Constructor
+         * @param directory Directory of the cache files, created if needed
+         * @param maxBytes Size budget of the cache files
+         */
+        ResultCache(const std::string& directory, uint64_t maxBytes);
+
+        /**
+         * @brief Check whether the cache directory could be created
+         * @return True if entries can be stored and loaded
+         */
+        bool isValid() const;
+
+        /**
+         * @brief Load the outputs stored under a key
+         * @param key The entry key
+         * @param values Receives one value per output; uncompressed images share the mapped pages
+         * @return True if the entry was found and read, false otherwise
+         */
+        bool load(uint64_t key, std::vector<PortValue>& values);
+
+        /**
+         * @brief Store outputs under a key, replacing an existing entry
+         * @param key The entry key
+         * @param values One value per output
+         * @return True if the entry was written, false otherwise
+         */
+        bool store(uint64_t key, const std::vector<PortValue>& values);
+
+        /**
+         * @brief Delete every entry
+         */
+        void clear();
+
+        /**
+         * @brief Enable LZ4 compression of stored outputs
+         * @param enabled True to compress new entries
+         * @return True if the setting was applied, false if the build has no LZ4 support
+         */
+        bool setCompression(bool enabled);
+
+        /**
+         * @brief Check whether new entries are compressed
+         * @return True if LZ4 compression is enabled
+         */
+        bool isCompressionEnabled() const;
+
+        /**
+         * @brief Set the size budget, deleting entries that no longer fit
+         * @param maxBytes The new budget in bytes
+         */
+        void setMaxBytes(uint64_t maxBytes);
+
+        /**
+         * @brief Get the size budget
+         * @return The budget in bytes
+         */
+        uint64_t getMaxBytes() const;
+
+        /**
+         * @brief Get the total size of the cache files
+         * @return The size in bytes
+         */
+        uint64_t getSizeBytes() const;
+
+    private:
+        std::filesystem::path m_directory;  // Directory of the cache files
+        uint64_t m_maxBytes;                // Size budget
+        uint64_t m_sizeBytes;               // Total size of the cache files
+        bool m_compression;                 // Whether new entries are compressed
+        bool m_valid;                       // Whether the directory is usable
+        mutable std::mutex m_mutex;         // Guards the size bookkeeping and eviction
+
+        /**
+         * @brief Get the file of an entry
+         * @param key The entry key
+         * @return The path of the file
+         */
+        std::filesystem::path entryPath(uint64_t key) const;
+
+        /**
+         * @brief Delete least recently used entries until the cache fits its budget
+         */
+        void trim();
+    };
+
+}
@@ -0,0 +1,426 @@
+#include "tiff_image_file.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <vector>
+#ifdef IMAGE_PROCESSOR_WITH_TIFF
+#include <tiffio.h>
+#endif
+
+namespace image_processor {
+
+    // Signatures of little- and big-endian TIFF (42) and BigTIFF (43) files
+    static const unsigned char TIFF_SIGNATURES[4][4] = {
+        { 'I', 'I', 42, 0 }, { 'M', 'M', 0, 42 }, { 'I', 'I', 43, 0 }, { 'M', 'M', 0, 43 }
+    };
+
+#ifdef IMAGE_PROCESSOR_WITH_TIFF
+    // Width and height of the tiles of written files
+    static const int TIFF_TILE_SIZE = 256;
+
+    // Size above which files are written as BigTIFF, leaving room for the tags
+    static const uint64_t TIFF_CLASSIC_MAX_BYTES = 0xF0000000ULL;
+
+    // OpenCV depth of TIFF samples, or -1 if OpenCV has none
+    static int sampleDepth(uint16_t bitsPerSample, uint16_t sampleFormat) {
+        switch (sampleFormat) {
+        case SAMPLEFORMAT_UINT:
+            return bitsPerSample == 8 ? CV_8U : bitsPerSample == 16 ? CV_16U : -1;
+        case SAMPLEFORMAT_INT:
+            return bitsPerSample == 8 ? CV_8S : bitsPerSample == 16 ? CV_16S : bitsPerSample == 32 ? CV_32S : -1;
+        case SAMPLEFORMAT_IEEEFP:
+            return bitsPerSample == 16 ? CV_16F : bitsPerSample == 32 ? CV_32F : bitsPerSample == 64 ? CV_64F : -1;
+        default:
+            return -1;
+        }
+    }
+
+    // Swap red and blue of color images, which OpenCV keeps in BGR(A) order
+    static cv::Mat swapRedBlue(const cv::Mat& image) {
+        if (image.channels() != 3 && image.channels() != 4) {
+            return image;
+        }
+        cv::Mat swapped(image.size(), image.type());
+        const int fromTo[] = { 0, 2, 1, 1, 2, 0, 3, 3 };
+        cv::mixChannels(&image, 1, &swapped, 1, fromTo, image.channels());
+        return swapped;
+    }
+
+    // Decodes the strip or tile row that holds the requested rows, one at a time
+    class TiffStripReader : public ImageStripReader {
+    public:
+        TiffStripReader()
+            : m_tiff(nullptr), m_type(0), m_bandRows(0), m_tileCols(0), m_bandIndex(-1), m_swapRedBlue(false) {
+        }
+
+        ~TiffStripReader() override {
+            if (m_tiff != nullptr) {
+                TIFFClose(m_tiff);
+            }
+        }
+
+        bool open(const std::string& filePath) {
+            m_filePath = filePath;
+            m_tiff = TIFFOpen(filePath.c_str(), "r");
+            if (m_tiff == nullptr) {
+                std::cerr << "TiffImageFile::openStrips: Failed to open " << filePath << "." << std::endl;
+                return false;
+            }
+
+            uint32_t width = 0;
+            uint32_t height = 0;
+            uint16_t samplesPerPixel = 1;
+            uint16_t bitsPerSample = 1;
+            uint16_t sampleFormat = SAMPLEFORMAT_UINT;
+            uint16_t planarConfig = PLANARCONFIG_CONTIG;
+            uint16_t photometric = PHOTOMETRIC_MINISBLACK;
+            uint16_t compression = COMPRESSION_NONE;
+            TIFFGetField(m_tiff, TIFFTAG_IMAGEWIDTH, &width);
+            TIFFGetField(m_tiff, TIFFTAG_IMAGELENGTH, &height);
+            TIFFGetFieldDefaulted(m_tiff, TIFFTAG_SAMPLESPERPIXEL, &samplesPerPixel);
+            TIFFGetFieldDefaulted(m_tiff, TIFFTAG_BITSPERSAMPLE, &bitsPerSample);
+            TIFFGetFieldDefaulted(m_tiff, TIFFTAG_SAMPLEFORMAT, &sampleFormat);
+            TIFFGetFieldDefaulted(m_tiff, TIFFTAG_PLANARCONFIG, &planarConfig);
+            TIFFGetField(m_tiff, TIFFTAG_PHOTOMETRIC, &photometric);
+            TIFFGetFieldDefaulted(m_tiff, TIFFTAG_COMPRESSION, &compression);
+
+            if (width == 0 || height == 0 ||
+                width > static_cast<uint32_t>(std::numeric_limits<int>::max()) ||
+                height > static_cast<uint32_t>(std::numeric_limits<int>::max())) {
+                std::cerr << "TiffImageFile::openStrips: " << filePath << " has an invalid size." << std::endl;
+                return false;
+            }
+            if (planarConfig != PLANARCONFIG_CONTIG) {
+                std::cerr << "TiffImageFile::openStrips: " << filePath << " stores its channels in separate planes." << std::endl;
+                return false;
+            }
+            // Let libtiff convert JPEG compressed YCbCr to RGB
+            if (photometric == PHOTOMETRIC_YCBCR && compression == COMPRESSION_JPEG) {
+                TIFFSetField(m_tiff, TIFFTAG_JPEGCOLORMODE, JPEGCOLORMODE_RGB);
+                photometric = PHOTOMETRIC_RGB;
+            }
+            if (photometric != PHOTOMETRIC_MINISBLACK && photometric != PHOTOMETRIC_RGB) {
+                std::cerr << "TiffImageFile::openStrips: " << filePath << " has an unsupported color model." << std::endl;
+                return false;
+            }
+            const int depth = sampleDepth(bitsPerSample, sampleFormat);
+            if (depth < 0 || samplesPerPixel < 1 || samplesPerPixel > CV_CN_MAX) {
+                std::cerr << "TiffImageFile::openStrips: " << filePath << " has samples OpenCV cannot hold." << std::endl;
+                return false;
+            }
+
+            m_size = cv::Size(static_cast<int>(width), static_cast<int>(height));
+            m_type = CV_MAKETYPE(depth, samplesPerPixel);
+            m_swapRedBlue = photometric == PHOTOMETRIC_RGB;
+
+            if (TIFFIsTiled(m_tiff)) {
+                uint32_t tileWidth = 0;
+                uint32_t tileLength = 0;
+                TIFFGetField(m_tiff, TIFFTAG_TILEWIDTH, &tileWidth);
+                TIFFGetField(m_tiff, TIFFTAG_TILELENGTH, &tileLength);
+                if (tileWidth == 0 || tileLength == 0) {
+                    std::cerr << "TiffImageFile::openStrips: " << filePath << " has an invalid tile size." << std::endl;
+                    return false;
+                }
+                m_tileCols = static_cast<int>(tileWidth);
+                m_bandRows = static_cast<int>(tileLength);
+                m_tile.create(m_bandRows, m_tileCols, m_type);
+                if (TIFFTileSize(m_tiff) != static_cast<tmsize_t>(m_tile.total() * m_tile.elemSize())) {
+                    std::cerr << "TiffImageFile::openStrips: " << filePath << " has tiles of an unexpected size." << std::endl;
+                    return false;
+                }
+            }
+            else {
+                uint32_t rowsPerStrip = height;
+                TIFFGetFieldDefaulted(m_tiff, TIFFTAG_ROWSPERSTRIP, &rowsPerStrip);
+                m_bandRows = static_cast<int>(std::min(std::max(rowsPerStrip, 1u), height));
+            }
+            m_band.create(m_bandRows, m_size.width, m_type);
+            return true;
+        }
+
+        cv::Size getSize() const override {
+            return m_size;
+        }
+
+        int getType() const override {
+            return m_type;
+        }
+
+        bool readRows(int firstRow, int rowCount, cv::Mat& rows) override {
+            if (firstRow < 0 || rowCount <= 0 || firstRow + rowCount > m_size.height) {
+                std::cerr << "TiffStripReader::readRows: Rows " << firstRow << " to " << firstRow + rowCount
+                    << " are not in " << m_filePath << "." << std::endl;
+                return false;
+            }
+
+            rows.create(rowCount, m_size.width, m_type);
+            for (int y = firstRow; y < firstRow + rowCount;) {
+                const int band = y / m_bandRows;
+                if (band != m_bandIndex && !decodeBand(band)) {
+                    return false;
+                }
+                const int bandTop = band * m_bandRows;
+                const int count = std::min(firstRow + rowCount, bandTop + m_bandRows) - y;
+                cv::Mat target = rows.rowRange(y - firstRow, y - firstRow + count);
+                m_band.rowRange(y - bandTop, y - bandTop + count).copyTo(target);
+                y += count;
+            }
+            return true;
+        }
+
+    private:
+        TIFF* m_tiff;            // The open file
+        std::string m_filePath;  // Path of the file, for messages
+        cv::Size m_size;         // Size of the image
+        int m_type;              // OpenCV type of the image
+        int m_bandRows;          // Rows per strip or tile
+        int m_tileCols;          // Columns per tile, 0 for striped files
+        int m_bandIndex;         // Strip or tile row held in m_band, -1 for none
+        bool m_swapRedBlue;      // Whether the file holds RGB(A)
+        cv::Mat m_band;          // Last decoded strip or tile row, the full width of the image
+        cv::Mat m_tile;          // Decoding buffer of a single tile
+
+        bool decodeBand(int band) {
+            m_bandIndex = -1;
+            const int bandTop = band * m_bandRows;
+            const int rowCount = std::min(m_bandRows, m_size.height - bandTop);
+
+            if (m_tileCols == 0) {
+                const tmsize_t size = static_cast<tmsize_t>(rowCount) * m_size.width * m_band.elemSize();
+                if (TIFFReadEncodedStrip(m_tiff, static_cast<uint32_t>(band), m_band.data, size) < 0) {
+                    std::cerr << "TiffStripReader::readRows: Failed to decode strip " << band << " of " << m_filePath << "." << std::endl;
+                    return false;
+                }
+            }
+            else {
+                for (int x = 0; x < m_size.width; x += m_tileCols) {
+                    if (TIFFReadTile(m_tiff, m_tile.data, static_cast<uint32_t>(x), static_cast<uint32_t>(bandTop), 0, 0) < 0) {
+                        std::cerr << "TiffStripReader::readRows: Failed to decode tile at (" << x << ", " << bandTop
+                            << ") of " << m_filePath << "." << std::endl;
+                        return false;
+                    }
+                    const int colCount = std::min(m_tileCols, m_size.width - x);
+                    cv::Mat target = m_band(cv::Rect(x, 0, colCount, rowCount));
+                    m_tile(cv::Rect(0, 0, colCount, rowCount)).copyTo(target);
+                }
+            }
+
+            if (m_swapRedBlue) {
+                cv::Mat target = m_band.rowRange(0, rowCount);
+                swapRedBlue(m_band.rowRange(0, rowCount)).copyTo(target);
+            }
+            m_bandIndex = band;
+            return true;
+        }
+    };
+
+    // Collects rows until a tile row is complete and writes it tile by tile
+    class TiffStripWriter : public ImageStripWriter {
+    public:
+        TiffStripWriter()
+            : m_tiff(nullptr), m_type(0), m_rowsWritten(0), m_bandRows(0), m_finished(false) {
+        }
+
+        ~TiffStripWriter() override {
+            if (m_tiff != nullptr) {
+                TIFFClose(m_tiff);
+            }
+            if (!m_finished && !m_temporaryPath.empty()) {
+                std::error_code error;
+                std::filesystem::remove(m_temporaryPath, error);
+            }
+        }
+
+        bool create(const std::string& filePath, cv::Size size, int type) {
+            const int depth = CV_MAT_DEPTH(type);
+            const int channels = CV_MAT_CN(type);
+            uint16_t sampleFormat = SAMPLEFORMAT_UINT;
+            if (depth == CV_8S || depth == CV_16S || depth == CV_32S) {
+                sampleFormat = SAMPLEFORMAT_INT;
+            }
+            else if (depth == CV_16F || depth == CV_32F || depth == CV_64F) {
+                sampleFormat = SAMPLEFORMAT_IEEEFP;
+            }
+            const uint16_t bitsPerSample = static_cast<uint16_t>(CV_ELEM_SIZE1(type) * 8);
+            const bool color = channels == 3 || channels == 4;
+
+            m_filePath = filePath;
+            m_size = size;
+            m_type = type;
+            m_temporaryPath = temporaryPathFor(filePath);
+
+            const uint64_t bytes = static_cast<uint64_t>(size.width) * size.height * CV_ELEM_SIZE(type);
+            m_tiff = TIFFOpen(m_temporaryPath.string().c_str(), bytes > TIFF_CLASSIC_MAX_BYTES ? "w8" : "w");
+            if (m_tiff == nullptr) {
+                std::cerr << "TiffImageFile::createStrips: Failed to create " << m_temporaryPath.string() << "." << std::endl;
+                return false;
+            }
+
+            TIFFSetField(m_tiff, TIFFTAG_IMAGEWIDTH, static_cast<uint32_t>(size.width));
+            TIFFSetField(m_tiff, TIFFTAG_IMAGELENGTH, static_cast<uint32_t>(size.height));
+            TIFFSetField(m_tiff, TIFFTAG_SAMPLESPERPIXEL, channels);
+            TIFFSetField(m_tiff, TIFFTAG_BITSPERSAMPLE, bitsPerSample);
+            TIFFSetField(m_tiff, TIFFTAG_SAMPLEFORMAT, sampleFormat);
+            TIFFSetField(m_tiff, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
+            TIFFSetField(m_tiff, TIFFTAG_PHOTOMETRIC, color ? PHOTOMETRIC_RGB : PHOTOMETRIC_MINISBLACK);
+            TIFFSetField(m_tiff, TIFFTAG_COMPRESSION, COMPRESSION_NONE);
+            TIFFSetField(m_tiff, TIFFTAG_TILEWIDTH, static_cast<uint32_t>(TIFF_TILE_SIZE));
+            TIFFSetField(m_tiff, TIFFTAG_TILELENGTH, static_cast<uint32_t>(TIFF_TILE_SIZE));
+
+            // Channels beyond gray or RGB; the fourth channel of BGRA and the second of gray are alpha
+            const int extraSamples = channels - (color ? 3 : 1);
+            if (extraSamples > 0) {
+                std::vector<uint16_t> kinds(extraSamples, EXTRASAMPLE_UNSPECIFIED);
+                if (channels == 2 || channels == 4) {
+                    kinds[0] = EXTRASAMPLE_UNASSALPHA;
+                }
+                TIFFSetField(m_tiff, TIFFTAG_EXTRASAMPLES, static_cast<uint16_t>(extraSamples), kinds.data());
+            }
+
+            m_band.create(TIFF_TILE_SIZE, size.width, type);
+            m_tile.create(TIFF_TILE_SIZE, TIFF_TILE_SIZE, type);
+            return true;
+        }
+
+        bool writeRows(const cv::Mat& rows) override {
+            if (m_finished) {
+                std::cerr << "TiffStripWriter::writeRows: " << m_filePath << " is already finished." << std::endl;
+                return false;
+            }
+            if (rows.type() != m_type || rows.cols != m_size.width || rows.dims > 2) {
+                std::cerr << "TiffStripWriter::writeRows: Rows do not have the width and type of " << m_filePath << "." << std::endl;
+                return false;
+            }
+            if (m_rowsWritten + rows.rows > m_size.height) {
+                std::cerr << "TiffStripWriter::writeRows: Rows extend past the bottom of " << m_filePath << "." << std::endl;
+                return false;
+            }
+
+            for (int y = 0; y < rows.rows;) {
+                const int count = std::min(rows.rows - y, TIFF_TILE_SIZE - m_bandRows);
+                cv::Mat target = m_band.rowRange(m_bandRows, m_bandRows + count);
+                rows.rowRange(y, y + count).copyTo(target);
+                m_bandRows += count;
+                m_rowsWritten += count;
+                y += count;
+
+                if ((m_bandRows == TIFF_TILE_SIZE || m_rowsWritten == m_size.height) && !writeBand()) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        bool finish() override {
+            if (m_finished) {
+                return true;
+            }
+            if (m_rowsWritten != m_size.height) {
+                std::cerr << "TiffStripWriter::finish: Only " << m_rowsWritten << " of " << m_size.height
+                    << " rows of " << m_filePath << " were written." << std::endl;
+                return false;
+            }
+
+            // Closing writes the directory of the file
+            TIFFClose(m_tiff);
+            m_tiff = nullptr;
+            std::error_code error;
+            std::filesystem::rename(m_temporaryPath, m_filePath, error);
+            if (error) {
+                std::cerr << "TiffStripWriter::finish: Failed to rename " << m_temporaryPath.string() << " to " << m_filePath << "." << std::endl;
+                return false;
+            }
+            m_finished = true;
+            return true;
+        }
+
+    private:
+        TIFF* m_tiff;                           // The file being written
+        std::string m_filePath;                 // Path the file appears under once finished
+        std::filesystem::path m_temporaryPath;  // Path the file is written under
+        cv::Size m_size;                        // Size of the image
+        int m_type;                             // OpenCV type of the image
+        int m_rowsWritten;                      // Rows received so far
+        int m_bandRows;                         // Rows of the current tile row held in m_band
+        bool m_finished;                        // Whether the file is complete
+        cv::Mat m_band;                         // Rows of the current tile row, the full width of the image
+        cv::Mat m_tile;                         // Encoding buffer of a single tile, zero beyond the image
+
+        bool writeBand() {
+            const int bandTop = m_rowsWritten - m_bandRows;
+            const cv::Mat band = swapRedBlue(m_band.rowRange(0, m_bandRows));
+            for (int x = 0; x < m_size.width; x += TIFF_TILE_SIZE) {
+                const int colCount = std::min(TIFF_TILE_SIZE, m_size.width - x);
+                if (colCount < TIFF_TILE_SIZE || m_bandRows < TIFF_TILE_SIZE) {
+                    m_tile.setTo(cv::Scalar::all(0));
+                }
+                cv::Mat target = m_tile(cv::Rect(0, 0, colCount, m_bandRows));
+                band(cv::Rect(x, 0, colCount, m_bandRows)).copyTo(target);
+                if (TIFFWriteTile(m_tiff, m_tile.data, static_cast<uint32_t>(x), static_cast<uint32_t>(bandTop), 0, 0) < 0) {
+                    std::cerr << "TiffStripWriter::writeRows: Failed to write tile at (" << x << ", " << bandTop
+                        << ") of " << m_temporaryPath.string() << "." << std::endl;
+                    return false;
+                }
+            }
+            m_bandRows = 0;
+            return true;
+        }
+    };
+#endif
+
+    bool TiffImageFile::hasTiffExtension(const std::string& filePath) {
+        std::string extension = std::filesystem::path(filePath).extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(),
+            [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return extension == ".tif" || extension == ".tiff";
+    }
+
+    bool TiffImageFile::isTiff(const std::string& filePath) {
+        std::ifstream file(filePath, std::ios::binary);
+        unsigned char signature[4];
+        if (!file.read(reinterpret_cast<char*>(signature), sizeof(signature))) {
+            return false;
+        }
+        for (const auto& candidate : TIFF_SIGNATURES) {
+            if (std::memcmp(signature, candidate, sizeof(signature)) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::unique_ptr<ImageStripReader> TiffImageFile::openStrips(const std::string& filePath) {
+#ifdef IMAGE_PROCESSOR_WITH_TIFF
+        std::unique_ptr<TiffStripReader> reader(new TiffStripReader());
+        if (!reader->open(filePath)) {
+            return nullptr;
+        }
+        return reader;
+#else
+        std::cerr << "TiffImageFile::openStrips: Cannot read " << filePath << ", TIFF support is not built in." << std::endl;
+        return nullptr;
+#endif
+    }
+
+    std::unique_ptr<ImageStripWriter> TiffImageFile::createStrips(const std::string& filePath, cv::Size size, int type) {
+#ifdef IMAGE_PROCESSOR_WITH_TIFF
+        std::unique_ptr<TiffStripWriter> writer(new TiffStripWriter());
+        if (!writer->create(filePath, size, type)) {
+            return nullptr;
+        }
+        return writer;
+#else
+        (void)size;
+        (void)type;
+        std::cerr << "TiffImageFile::createStrips: Cannot write " << filePath << ", TIFF support is not built in." << std::endl;
+        return nullptr;
+#endif
+    }
+
+}
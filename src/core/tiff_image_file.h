@@ -0,0 +1,54 @@
+#pragma once
+
+#include "image_strips.h"
+#include <opencv2/opencv.hpp>
+#include <memory>
+#include <string>
+
+namespace image_processor {
+
+    /**
+     * @brief Reads and writes TIFF files a band of rows at a time
+     *
+     * Uses libtiff directly, since cv::imread and cv::imwrite only handle
+     * whole images; builds without IMAGE_PROCESSOR_WITH_TIFF recognize TIFF
+     * files but cannot open them. Striped and tiled files with interleaved
+     * samples of any OpenCV depth can be read, in any compression libtiff
+     * supports. Files are written uncompressed in 256x256 tiles, as BigTIFF
+     * when they may not fit in 4 GiB. Like cv::imread and cv::imwrite,
+     * color images are BGR(A) in memory and RGB(A) in the file.
+     */
+    class TiffImageFile {
+    public:
+        /**
+         * @brief Check whether a path has a TIFF extension (".tif" or ".tiff")
+         * @param filePath The path
+         * @return True if the path should be written as a TIFF file
+         */
+        static bool hasTiffExtension(const std::string& filePath);
+
+        /**
+         * @brief Check whether a file is a TIFF file, regardless of its extension
+         * @param filePath The path of the file
+         * @return True if the file starts with a TIFF or BigTIFF signature
+         */
+        static bool isTiff(const std::string& filePath);
+
+        /**
+         * @brief Open a file to read it a band of rows at a time
+         * @param filePath The path of the file
+         * @return The reader, or nullptr if the file cannot be read by strips
+         */
+        static std::unique_ptr<ImageStripReader> openStrips(const std::string& filePath);
+
+        /**
+         * @brief Create a tiled file to write it a band of rows at a time
+         * @param filePath The path of the file, replaced once the writer finishes
+         * @param size The size of the whole image
+         * @param type The OpenCV type of the image
+         * @return The writer, or nullptr if the file cannot be created
+         */
+        static std::unique_ptr<ImageStripWriter> createStrips(const std::string& filePath, cv::Size size, int type);
+    };
+
+}
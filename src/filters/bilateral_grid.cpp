@@ -0,0 +1,334 @@
+#include "bilateral_grid.h"
+#include "row_bands.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+namespace image_processor {
+
+    // Empty cells around the data so the grid blur and trilinear
+    // interpolation never read outside the grid
+    static const int GRID_PADDING = 3;
+
+    // Grid blur taps for a Gaussian with a variance of 2/3 cell^2. Trilinear
+    // splatting and slicing each add 1/6 cell^2, so the effective kernel has
+    // a variance of exactly one cell^2 (sigma = cell size) in every dimension.
+    static const float GRID_BLUR_WEIGHTS[3] = { 0.48914f, 0.23107f, 0.02436f };
+
+    // Fewest range cells the grid keeps before the exact filter is used instead
+    static const int GRID_MIN_RANGE_CELLS = 8;
+
+    // Fewest grid rows splatted by one parallel band
+    static const int GRID_MIN_BAND_CELL_ROWS = 2;
+
+    /**
+     * @brief Dense 3D grid of homogeneous values (channel sums and a weight)
+     */
+    struct BilateralGrid {
+        int width = 0;
+        int height = 0;
+        int depth = 0;
+        int stride = 0;           // Floats per cell (channels + weight)
+        std::vector<float> data;
+
+        void create(int w, int h, int d, int s) {
+            width = w;
+            height = h;
+            depth = d;
+            stride = s;
+            data.assign(static_cast<size_t>(w) * h * d * s, 0.0f);
+        }
+
+        float* cell(int x, int y, int z) {
+            return &data[((static_cast<size_t>(z) * height + y) * width + x) * stride];
+        }
+
+        const float* cell(int x, int y, int z) const {
+            return &data[((static_cast<size_t>(z) * height + y) * width + x) * stride];
+        }
+    };
+
+    /**
+     * @brief Blur the grid along one axis with GRID_BLUR_WEIGHTS
+     * @param axisStep Distance in floats between neighbouring cells along the axis
+     * @param axisLength Number of cells along the axis
+     */
+    static void blurGridAxis(BilateralGrid& grid, size_t axisStep, int axisLength) {
+        const size_t cellCount = grid.data.size() / grid.stride;
+        const std::ptrdiff_t step = static_cast<std::ptrdiff_t>(axisStep);
+        std::vector<float> source(grid.data);
+
+        cv::parallel_for_(cv::Range(0, static_cast<int>(cellCount)), [&](const cv::Range& range) {
+            for (int index = range.start; index < range.end; ++index) {
+                size_t offset = static_cast<size_t>(index) * grid.stride;
+                int position = static_cast<int>((offset / axisStep) % axisLength);
+
+                // Padding cells are empty and never receive data, so they can be skipped
+                if (position < 2 || position >= axisLength - 2) {
+                    continue;
+                }
+
+                float* out = &grid.data[offset];
+                const float* center = &source[offset];
+                for (int k = 0; k < grid.stride; ++k) {
+                    out[k] = GRID_BLUR_WEIGHTS[0] * center[k]
+                        + GRID_BLUR_WEIGHTS[1] * (center[k - step] + center[k + step])
+                        + GRID_BLUR_WEIGHTS[2] * (center[k - 2 * step] + center[k + 2 * step]);
+                }
+            }
+        }, static_cast<double>(cv::getNumThreads()));
+    }
+
+    // cv::bilateralFilter takes 1 or 3 channels only: 4-channel images filter
+    // their color and keep alpha, 2-channel images filter each channel
+    static void exactBilateralFilter(const cv::Mat& image, cv::Mat& filtered, double sigmaColor, double sigmaSpace) {
+        const int channels = image.channels();
+        if (channels == 1 || channels == 3) {
+            cv::bilateralFilter(image, filtered, -1, sigmaColor, sigmaSpace);
+            return;
+        }
+
+        std::vector<cv::Mat> planes;
+        cv::split(image, planes);
+        std::vector<cv::Mat> filteredPlanes;
+        if (channels == 4) {
+            cv::Mat color;
+            cv::Mat filteredColor;
+            cv::merge(std::vector<cv::Mat>(planes.begin(), planes.begin() + 3), color);
+            cv::bilateralFilter(color, filteredColor, -1, sigmaColor, sigmaSpace);
+            cv::split(filteredColor, filteredPlanes);
+            filteredPlanes.push_back(planes[3]);
+        }
+        else {
+            for (const cv::Mat& plane : planes) {
+                cv::Mat filteredPlane;
+                cv::bilateralFilter(plane, filteredPlane, -1, sigmaColor, sigmaSpace);
+                filteredPlanes.push_back(filteredPlane);
+            }
+        }
+        cv::merge(filteredPlanes, filtered);
+    }
+
+    bool bilateralGridFilter(const cv::Mat& src, cv::Mat& dst, double sigmaSpace, double sigmaColor) {
+        if (src.empty()) {
+            std::cerr << "bilateralGridFilter: Source image is empty." << std::endl;
+            return false;
+        }
+
+        int depth = src.depth();
+        int channels = src.channels();
+        if ((depth != CV_8U && depth != CV_16U && depth != CV_32F) || channels > 4) {
+            std::cerr << "bilateralGridFilter: Unsupported image type." << std::endl;
+            return false;
+        }
+
+        if (!(sigmaSpace > 0.0) || !std::isfinite(sigmaSpace) || !(sigmaColor > 0.0)) {
+            std::cerr << "bilateralGridFilter: Sigma values must be positive and sigmaSpace finite." << std::endl;
+            return false;
+        }
+
+        cv::Mat image;
+        src.convertTo(image, CV_32F);
+
+        // Range guide: the image itself, or its luminance for color images.
+        // Pixels with a non-finite sample get a NaN guide and are passed
+        // through unfiltered; the range spans the finite guide values only.
+        const bool checkFinite = depth == CV_32F;
+        const float notFinite = std::numeric_limits<float>::quiet_NaN();
+        double minValue = std::numeric_limits<double>::max();
+        double maxValue = std::numeric_limits<double>::lowest();
+        cv::Mat guide(src.rows, src.cols, CV_32FC1);
+        for (int y = 0; y < src.rows; ++y) {
+            const float* in = image.ptr<float>(y);
+            float* out = guide.ptr<float>(y);
+            for (int x = 0; x < src.cols; ++x) {
+                const float* pixel = in + x * channels;
+                if (channels >= 3) {
+                    out[x] = 0.114f * pixel[0] + 0.587f * pixel[1] + 0.299f * pixel[2];
+                }
+                else {
+                    out[x] = pixel[0];
+                }
+
+                if (checkFinite && (!std::isfinite(out[x]) || !std::all_of(pixel, pixel + channels, [](float v) { return std::isfinite(v); }))) {
+                    out[x] = notFinite;
+                    continue;
+                }
+                minValue = std::min(minValue, static_cast<double>(out[x]));
+                maxValue = std::max(maxValue, static_cast<double>(out[x]));
+            }
+        }
+        if (minValue > maxValue) {
+            minValue = maxValue = 0.0;
+        }
+
+        int gridWidth = static_cast<int>((src.cols - 1) / sigmaSpace) + 1 + 2 * GRID_PADDING;
+        int gridHeight = static_cast<int>((src.rows - 1) / sigmaSpace) + 1 + 2 * GRID_PADDING;
+
+        // The grid may hold up to twice as many cells as the image has
+        // pixels. Range cells beyond that budget are merged, widening the
+        // range kernel, rather than given up for the exact filter.
+        const double planeCells = static_cast<double>(gridWidth) * gridHeight;
+        const double rangeBudget = std::floor(2.0 * src.total() / planeCells) - 1 - 2 * GRID_PADDING;
+        const double rangeCells = (maxValue - minValue) / sigmaColor;
+        double rangeCellSize = sigmaColor;
+        if (rangeCells > rangeBudget) {
+            if (rangeBudget < GRID_MIN_RANGE_CELLS) {
+                // Only a small sigmaSpace leaves so few range cells, and the
+                // exact filter is cheap for it
+                if (depth != CV_16U && (channels == 1 || channels == 3)) {
+                    cv::bilateralFilter(src, dst, -1, sigmaColor, sigmaSpace);
+                }
+                else {
+                    cv::Mat filtered;
+                    exactBilateralFilter(image, filtered, sigmaColor, sigmaSpace);
+                    filtered.convertTo(dst, src.type());
+                }
+                return true;
+            }
+            rangeCellSize = (maxValue - minValue) / rangeBudget;
+        }
+        int gridDepth = static_cast<int>(std::min(rangeCells, rangeBudget)) + 1 + 2 * GRID_PADDING;
+
+        // Map the guide to range coordinates in the grid once for the splat
+        // and the slice; the difference is taken in double so that wide
+        // 32F ranges do not overflow
+        const double invRange = 1.0 / rangeCellSize;
+        const double maxCoordinate = (maxValue - minValue) * invRange + GRID_PADDING;
+        cv::parallel_for_(cv::Range(0, src.rows), [&](const cv::Range& range) {
+            for (int y = range.start; y < range.end; ++y) {
+                float* row = guide.ptr<float>(y);
+                for (int x = 0; x < src.cols; ++x) {
+                    if (std::isnan(row[x])) {
+                        continue;
+                    }
+                    double coordinate = (row[x] - minValue) * invRange + GRID_PADDING;
+                    row[x] = static_cast<float>(std::min(std::max(coordinate, static_cast<double>(GRID_PADDING)), maxCoordinate));
+                }
+            }
+        });
+
+        const int stride = channels + 1;
+        const float invSpace = static_cast<float>(1.0 / sigmaSpace);
+
+        BilateralGrid grid;
+        grid.create(gridWidth, gridHeight, gridDepth, stride);
+
+        // Splat every pixel into its 8 surrounding cells. Each band owns a
+        // range of grid rows and splats the pixel rows that reach them, so
+        // the bands share one grid without a reduction; pixel rows between
+        // two bands are read by both, each writing its own grid row.
+        const int firstCellRow = GRID_PADDING;
+        const int cellRows = gridHeight - 2 * GRID_PADDING + 1;
+        parallelForRowBands(cellRows, GRID_MIN_BAND_CELL_ROWS, [&](int bandBegin, int bandEnd) {
+            const int cellBegin = firstCellRow + bandBegin;
+            const int cellEnd = firstCellRow + bandEnd;
+            const double firstRow = (cellBegin - 1 - GRID_PADDING) * sigmaSpace - 1.0;
+            const int rowStart = static_cast<int>(std::min(std::max(firstRow, 0.0), static_cast<double>(src.rows)));
+
+            for (int y = rowStart; y < src.rows; ++y) {
+                float gy = y * invSpace + GRID_PADDING;
+                int y0 = static_cast<int>(gy);
+                if (y0 + 1 < cellBegin) {
+                    continue;
+                }
+                if (y0 >= cellEnd) {
+                    break;
+                }
+                float fy = gy - y0;
+                const int dyBegin = y0 < cellBegin ? 1 : 0;
+                const int dyEnd = y0 + 1 < cellEnd ? 2 : 1;
+
+                const float* in = image.ptr<float>(y);
+                const float* guideRow = guide.ptr<float>(y);
+                for (int x = 0; x < src.cols; ++x) {
+                    float gz = guideRow[x];
+                    if (std::isnan(gz)) {
+                        continue;
+                    }
+                    float gx = x * invSpace + GRID_PADDING;
+                    int x0 = static_cast<int>(gx);
+                    int z0 = static_cast<int>(gz);
+                    float fx = gx - x0;
+                    float fz = gz - z0;
+                    const float* pixel = in + x * channels;
+
+                    for (int dy = dyBegin; dy < dyEnd; ++dy) {
+                        for (int corner = 0; corner < 4; ++corner) {
+                            int dx = corner & 1;
+                            int dz = corner >> 1;
+                            float weight = (dx ? fx : 1.0f - fx) * (dy ? fy : 1.0f - fy) * (dz ? fz : 1.0f - fz);
+                            float* cell = grid.cell(x0 + dx, y0 + dy, z0 + dz);
+                            for (int c = 0; c < channels; ++c) {
+                                cell[c] += weight * pixel[c];
+                            }
+                            cell[channels] += weight;
+                        }
+                    }
+                }
+            }
+        });
+
+        // Separable blur along x, y and the range axis
+        blurGridAxis(grid, static_cast<size_t>(stride), gridWidth);
+        blurGridAxis(grid, static_cast<size_t>(stride) * gridWidth, gridHeight);
+        blurGridAxis(grid, static_cast<size_t>(stride) * gridWidth * gridHeight, gridDepth);
+
+        // Slice the grid at every pixel with trilinear interpolation
+        cv::Mat result(src.rows, src.cols, CV_MAKETYPE(CV_32F, channels));
+        cv::parallel_for_(cv::Range(0, src.rows), [&](const cv::Range& range) {
+            std::vector<float> value(stride);
+            for (int y = range.start; y < range.end; ++y) {
+                const float* in = image.ptr<float>(y);
+                const float* guideRow = guide.ptr<float>(y);
+                float* out = result.ptr<float>(y);
+                float gy = y * invSpace + GRID_PADDING;
+                int y0 = static_cast<int>(gy);
+                float fy = gy - y0;
+
+                for (int x = 0; x < src.cols; ++x) {
+                    float gz = guideRow[x];
+                    if (std::isnan(gz)) {
+                        std::copy(in + x * channels, in + (x + 1) * channels, out + x * channels);
+                        continue;
+                    }
+                    float gx = x * invSpace + GRID_PADDING;
+                    int x0 = static_cast<int>(gx);
+                    int z0 = static_cast<int>(gz);
+                    float fx = gx - x0;
+                    float fz = gz - z0;
+
+                    std::fill(value.begin(), value.end(), 0.0f);
+                    for (int corner = 0; corner < 8; ++corner) {
+                        int dx = corner & 1;
+                        int dy = (corner >> 1) & 1;
+                        int dz = corner >> 2;
+                        float weight = (dx ? fx : 1.0f - fx) * (dy ? fy : 1.0f - fy) * (dz ? fz : 1.0f - fz);
+                        const float* cell = grid.cell(x0 + dx, y0 + dy, z0 + dz);
+                        for (int k = 0; k < stride; ++k) {
+                            value[k] += weight * cell[k];
+                        }
+                    }
+
+                    // Every pixel splats into the cells it slices, so the weight is positive
+                    float* pixel = out + x * channels;
+                    if (value[channels] > 0.0f) {
+                        for (int c = 0; c < channels; ++c) {
+                            pixel[c] = value[c] / value[channels];
+                        }
+                    }
+                    else {
+                        std::copy(in + x * channels, in + (x + 1) * channels, pixel);
+                    }
+                }
+            }
+        });
+
+        result.convertTo(dst, src.type());
+        return true;
+    }
+
+}
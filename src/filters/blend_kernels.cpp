@@ -0,0 +1,158 @@
+#include "blend_kernels.h"
+#include "pixel_kernels.h"
+#include "row_bands.h"
+#include "simd_kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <type_traits>
+
+namespace image_processor {
+
+    // Blend operators on normalized samples; a is the base, b the blend sample
+    struct NormalBlendOp {
+        float operator()(float a, float b, float alpha) const {
+            return a + (b - a) * alpha;
+        }
+    };
+
+    struct AddBlendOp {
+        float operator()(float a, float b, float alpha) const {
+            return a + b * alpha;
+        }
+    };
+
+    struct MultiplyBlendOp {
+        float operator()(float a, float b, float alpha) const {
+            return a * (b * alpha + (1.0f - alpha));
+        }
+    };
+
+    struct ScreenBlendOp {
+        float operator()(float a, float b, float alpha) const {
+            return 1.0f - (1.0f - a) * (1.0f - b * alpha);
+        }
+    };
+
+    struct OverlayBlendOp {
+        float operator()(float a, float b, float alpha) const {
+            float faded = b * alpha + 0.5f * (1.0f - alpha);
+            return a < 0.5f ? 2.0f * a * faded : 1.0f - 2.0f * (1.0f - a) * (1.0f - faded);
+        }
+    };
+
+    struct DarkenBlendOp {
+        float operator()(float a, float b, float alpha) const {
+            return std::min(a, a + (b - a) * alpha);
+        }
+    };
+
+    struct LightenBlendOp {
+        float operator()(float a, float b, float alpha) const {
+            return std::max(a, a + (b - a) * alpha);
+        }
+    };
+
+    struct DifferenceBlendOp {
+        float operator()(float a, float b, float alpha) const {
+            return std::abs((b - a) * alpha);
+        }
+    };
+
+    template <typename T, int CN, typename Op>
+    static void blendRows(const cv::Mat& base, const cv::Mat& blend, cv::Mat& dst, float alpha, int rowBegin, int rowEnd) {
+        // The normal blend of 8-bit images has vector variants picked at run time
+        if constexpr (std::is_same<T, uchar>::value && std::is_same<Op, NormalBlendOp>::value) {
+            for (int y = rowBegin; y < rowEnd; ++y) {
+                blendNormalRow8u(base.ptr<uchar>(y), blend.ptr<uchar>(y), dst.ptr<uchar>(y), base.cols * CN, alpha);
+            }
+        }
+        else {
+            const float scale = 1.0f / PixelTraits<T>::maxValue;
+            const Op op;
+            for (int y = rowBegin; y < rowEnd; ++y) {
+                const T* a = base.ptr<T>(y);
+                const T* b = blend.ptr<T>(y);
+                T* out = dst.ptr<T>(y);
+                for (int x = 0; x < base.cols; ++x) {
+                    for (int c = 0; c < CN; ++c) {
+                        const int i = x * CN + c;
+                        out[i] = cv::saturate_cast<T>(op(a[i] * scale, b[i] * scale, alpha) * PixelTraits<T>::maxValue);
+                    }
+                }
+            }
+        }
+    }
+
+    template <typename T, int CN, typename Op>
+    static void blendImage(const cv::Mat& base, const cv::Mat& blend, cv::Mat& dst, float alpha) {
+        parallelForRowBands(base.rows, DEFAULT_MIN_BAND_ROWS, [&](int rowBegin, int rowEnd) {
+            blendRows<T, CN, Op>(base, blend, dst, alpha, rowBegin, rowEnd);
+        });
+    }
+
+    template <typename T, int CN>
+    static void blendWithMode(const cv::Mat& base, const cv::Mat& blend, cv::Mat& dst, BlendMode mode, float alpha) {
+        switch (mode) {
+        case BlendMode::ADD:
+            blendImage<T, CN, AddBlendOp>(base, blend, dst, alpha);
+            break;
+        case BlendMode::MULTIPLY:
+            blendImage<T, CN, MultiplyBlendOp>(base, blend, dst, alpha);
+            break;
+        case BlendMode::SCREEN:
+            blendImage<T, CN, ScreenBlendOp>(base, blend, dst, alpha);
+            break;
+        case BlendMode::OVERLAY:
+            blendImage<T, CN, OverlayBlendOp>(base, blend, dst, alpha);
+            break;
+        case BlendMode::DARKEN:
+            blendImage<T, CN, DarkenBlendOp>(base, blend, dst, alpha);
+            break;
+        case BlendMode::LIGHTEN:
+            blendImage<T, CN, LightenBlendOp>(base, blend, dst, alpha);
+            break;
+        case BlendMode::DIFFERENCE:
+            blendImage<T, CN, DifferenceBlendOp>(base, blend, dst, alpha);
+            break;
+        default:
+            blendImage<T, CN, NormalBlendOp>(base, blend, dst, alpha);
+            break;
+        }
+    }
+
+    bool blendImages(const cv::Mat& base, const cv::Mat& blend, cv::Mat& dst, BlendMode mode, double alpha) {
+        if (base.empty() || blend.empty()) {
+            std::cerr << "blendImages: Source image is empty." << std::endl;
+            return false;
+        }
+
+        if (base.size() != blend.size() || base.type() != blend.type()) {
+            std::cerr << "blendImages: Images must have the same size and type." << std::endl;
+            return false;
+        }
+
+        if (!isKernelTypeSupported(base.type())) {
+            std::cerr << "blendImages: Images must be 8U, 16U, 16F or 32F with 1, 3 or 4 channels." << std::endl;
+            return false;
+        }
+
+        if (mode == BlendMode::MULTIBAND) {
+            std::cerr << "blendImages: Multi-band blending needs image pyramids, use multiBandBlend." << std::endl;
+            return false;
+        }
+
+        cv::Mat result(base.rows, base.cols, base.type());
+        const float weight = static_cast<float>(std::min(std::max(alpha, 0.0), 1.0));
+        dispatchPixelType(base.type(), [&](auto depthTag, auto channelTag) {
+            using T = typename decltype(depthTag)::type;
+            constexpr int CN = decltype(channelTag)::value;
+            blendWithMode<T, CN>(base, blend, result, mode, weight);
+        });
+
+        dst = result;
+        return true;
+    }
+
+}
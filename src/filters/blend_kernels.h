@@ -0,0 +1,42 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+namespace image_processor {
+
+    /**
+     * @brief Enumeration of available blending modes
+     */
+    enum class BlendMode {
+        NORMAL,     // Simple alpha blending
+        ADD,        // Addition blending
+        MULTIPLY,   // Multiplication blending
+        SCREEN,     // Screen blending
+        OVERLAY,    // Overlay blending
+        DARKEN,     // Darken blending
+        LIGHTEN,    // Lighten blending
+        DIFFERENCE, // Difference blending
+        MULTIBAND   // Laplacian pyramid blending through a mask (see multiBandBlend in pyramid.h)
+    };
+
+    /**
+     * @brief Blend two images of the same size and type
+     *
+     * Each mode has its own inner loop, compiled for every supported depth
+     * and channel count (8U, 16U, 16F, 32F with 1, 3 or 4 channels), so no type
+     * or mode is tested per pixel. Samples are normalized by the full
+     * intensity of the depth, blended in single precision and rounded back.
+     * Alpha fades the blend image towards the neutral value of each mode,
+     * so an alpha of 0 returns the base image for every mode but DIFFERENCE.
+     * MULTIBAND works on pyramids and is not handled here.
+     *
+     * @param base Base image
+     * @param blend Blend image, with the size and type of base
+     * @param dst Destination image, allocated with the size and type of base
+     * @param mode Blending mode
+     * @param alpha Strength of the blend image (0 to 1)
+     * @return True if the images were blended, false if the arguments are invalid
+     */
+    bool blendImages(const cv::Mat& base, const cv::Mat& blend, cv::Mat& dst, BlendMode mode, double alpha);
+
+}
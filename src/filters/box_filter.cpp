@@ -0,0 +1,187 @@
+#include "box_filter.h"
+#include "row_bands.h"
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace image_processor {
+
+    /**
+     * @brief Box filter one row band with running sums in ACC precision
+     *
+     * Horizontal sums of the rows in the vertical window are kept in a ring
+     * buffer; moving down one row removes the oldest row sum from the column
+     * sums and adds the newest.
+     */
+    template <typename T, typename ACC>
+    static void boxFilterBand(const cv::Mat& src, cv::Mat& dst, int radius, int borderType,
+        double scale, int rowBegin, int rowEnd) {
+        const int channels = src.channels();
+        const int width = src.cols;
+        const int height = src.rows;
+        const int rowLength = width * channels;
+        const int diameter = 2 * radius + 1;
+
+        // Source column of every window position, -1 for constant border pixels
+        std::vector<int> columnIndex(width + 2 * radius);
+        for (int i = 0; i < width + 2 * radius; ++i) {
+            columnIndex[i] = cv::borderInterpolate(i - radius, width, borderType);
+        }
+
+        std::vector<ACC> ring(static_cast<size_t>(diameter) * rowLength);
+        std::vector<ACC> columnSum(rowLength, 0);
+
+        auto horizontalSums = [&](int y, ACC* out) {
+            int sourceRow = cv::borderInterpolate(y, height, borderType);
+            if (sourceRow < 0) {
+                std::fill(out, out + rowLength, ACC(0));
+                return;
+            }
+
+            const T* row = src.ptr<T>(sourceRow);
+            auto sample = [&](int position, int channel) -> ACC {
+                int x = columnIndex[position];
+                return x >= 0 ? static_cast<ACC>(row[x * channels + channel]) : ACC(0);
+            };
+
+            for (int c = 0; c < channels; ++c) {
+                ACC sum = 0;
+                for (int i = 0; i < diameter; ++i) {
+                    sum += sample(i, c);
+                }
+                out[c] = sum;
+
+                for (int x = 1; x < width; ++x) {
+                    sum += sample(x + 2 * radius, c) - sample(x - 1, c);
+                    out[x * channels + c] = sum;
+                }
+            }
+        };
+
+        // Fill the window for the first row of the band
+        for (int j = 0; j < diameter; ++j) {
+            ACC* slot = &ring[static_cast<size_t>(j) * rowLength];
+            horizontalSums(rowBegin - radius + j, slot);
+            for (int i = 0; i < rowLength; ++i) {
+                columnSum[i] += slot[i];
+            }
+        }
+
+        for (int y = rowBegin; y < rowEnd; ++y) {
+            if (y > rowBegin) {
+                // The slot of the row leaving the window receives the row entering it
+                ACC* slot = &ring[static_cast<size_t>((y - rowBegin - 1) % diameter) * rowLength];
+                for (int i = 0; i < rowLength; ++i) {
+                    columnSum[i] -= slot[i];
+                }
+                horizontalSums(y + radius, slot);
+                for (int i = 0; i < rowLength; ++i) {
+                    columnSum[i] += slot[i];
+                }
+            }
+
+            T* out = dst.ptr<T>(y);
+            for (int i = 0; i < rowLength; ++i) {
+                out[i] = cv::saturate_cast<T>(static_cast<double>(columnSum[i]) * scale);
+            }
+        }
+    }
+
+    template <typename T, typename ACC>
+    static void boxFilterImage(const cv::Mat& src, cv::Mat& dst, int radius, int borderType, double scale) {
+        // Each band recomputes the row sums of its window, so keep bands
+        // taller than the kernel
+        const int diameter = 2 * radius + 1;
+        parallelForRowBands(src.rows, std::max(diameter, DEFAULT_MIN_BAND_ROWS), [&](int rowBegin, int rowEnd) {
+            boxFilterBand<T, ACC>(src, dst, radius, borderType, scale, rowBegin, rowEnd);
+        });
+    }
+
+    static bool validateBoxArguments(const cv::Mat& src, int kernelSize, int borderType, const char* caller) {
+        if (src.empty()) {
+            std::cerr << caller << ": Source image is empty." << std::endl;
+            return false;
+        }
+
+        int depth = src.depth();
+        if (depth != CV_8U && depth != CV_16U && depth != CV_16S && depth != CV_32F && depth != CV_64F) {
+            std::cerr << caller << ": Unsupported image depth." << std::endl;
+            return false;
+        }
+
+        if (kernelSize < 1 || kernelSize % 2 == 0) {
+            std::cerr << caller << ": Kernel size must be positive and odd." << std::endl;
+            return false;
+        }
+
+        int border = borderType & ~cv::BORDER_ISOLATED;
+        if (border != cv::BORDER_CONSTANT && border != cv::BORDER_REPLICATE && border != cv::BORDER_REFLECT &&
+            border != cv::BORDER_REFLECT_101 && border != cv::BORDER_WRAP) {
+            std::cerr << caller << ": Unsupported border type." << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    bool fastBoxFilter(const cv::Mat& src, cv::Mat& dst, int kernelSize, int borderType, bool normalize) {
+        if (!validateBoxArguments(src, kernelSize, borderType, "fastBoxFilter")) {
+            return false;
+        }
+
+        borderType &= ~cv::BORDER_ISOLATED;
+        const int radius = kernelSize / 2;
+        const double scale = normalize ? 1.0 / (static_cast<double>(kernelSize) * kernelSize) : 1.0;
+
+        cv::Mat result(src.rows, src.cols, src.type());
+
+        switch (src.depth()) {
+        case CV_8U:
+            boxFilterImage<uchar, int64_t>(src, result, radius, borderType, scale);
+            break;
+        case CV_16U:
+            boxFilterImage<ushort, int64_t>(src, result, radius, borderType, scale);
+            break;
+        case CV_16S:
+            boxFilterImage<short, int64_t>(src, result, radius, borderType, scale);
+            break;
+        case CV_32F:
+            boxFilterImage<float, double>(src, result, radius, borderType, scale);
+            break;
+        default:
+            boxFilterImage<double, double>(src, result, radius, borderType, scale);
+            break;
+        }
+
+        dst = result;
+        return true;
+    }
+
+    bool stackedBoxFilter(const cv::Mat& src, cv::Mat& dst, int kernelSize, int passes, int borderType) {
+        if (!validateBoxArguments(src, kernelSize, borderType, "stackedBoxFilter")) {
+            return false;
+        }
+
+        if (passes < 1) {
+            std::cerr << "stackedBoxFilter: At least one pass is required." << std::endl;
+            return false;
+        }
+
+        if (passes == 1) {
+            return fastBoxFilter(src, dst, kernelSize, borderType, true);
+        }
+
+        int workingDepth = src.depth() == CV_64F ? CV_64F : CV_32F;
+        cv::Mat image;
+        src.convertTo(image, workingDepth);
+
+        for (int pass = 0; pass < passes; ++pass) {
+            fastBoxFilter(image, image, kernelSize, borderType, true);
+        }
+
+        image.convertTo(dst, src.type());
+        return true;
+    }
+
+}
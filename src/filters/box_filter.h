@@ -0,0 +1,44 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+namespace image_processor {
+
+    /**
+     * @brief Box filter with a per-pixel cost independent of the kernel size
+     *
+     * Each row is summed with a sliding window, and the row sums are then
+     * slid down the columns, so every output pixel costs a few additions
+     * regardless of the kernel size. Integer images are summed exactly in
+     * integer arithmetic. The image is processed in parallel row bands.
+     *
+     * @param src Source image (8U, 16U, 16S, 32F or 64F, any number of channels)
+     * @param dst Destination image, allocated with the size and type of src
+     * @param kernelSize Width and height of the box (odd, at least 1)
+     * @param borderType Border mode (BORDER_CONSTANT, BORDER_REPLICATE,
+     *        BORDER_REFLECT, BORDER_REFLECT_101 or BORDER_WRAP)
+     * @param normalize Divide by the box area (true) or return plain sums (false)
+     * @return True if the image was filtered, false if the arguments are invalid
+     */
+    bool fastBoxFilter(const cv::Mat& src, cv::Mat& dst, int kernelSize,
+        int borderType = cv::BORDER_DEFAULT, bool normalize = true);
+
+    /**
+     * @brief Repeated normalized box filter, a cheap approximation of a Gaussian
+     *
+     * Applying a box of size k n times gives a kernel with a variance of
+     * n * (k * k - 1) / 12; three passes are already visually close to a
+     * Gaussian. Intermediate passes are kept in floating point so rounding
+     * does not accumulate.
+     *
+     * @param src Source image (8U, 16U, 16S, 32F or 64F, any number of channels)
+     * @param dst Destination image, allocated with the size and type of src
+     * @param kernelSize Width and height of the box (odd, at least 1)
+     * @param passes Number of box passes (at least 1)
+     * @param borderType Border mode, as for fastBoxFilter
+     * @return True if the image was filtered, false if the arguments are invalid
+     */
+    bool stackedBoxFilter(const cv::Mat& src, cv::Mat& dst, int kernelSize, int passes,
+        int borderType = cv::BORDER_DEFAULT);
+
+}
@@ -0,0 +1,275 @@
+#include "canny_detector.h"
+#include "row_bands.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace image_processor {
+
+    // tan(22.5 degrees) in 15-bit fixed point, as in cv::Canny
+    static const int CANNY_SHIFT = 15;
+    static const int CANNY_TG22 = 13573;
+    static const float CANNY_TG22_FLOAT = 0.41421356f;
+
+    // Edge map values
+    static const uchar CANNY_WEAK = 0;   // Local maximum between the thresholds
+    static const uchar CANNY_NONE = 1;   // Not an edge
+    static const uchar CANNY_EDGE = 2;   // Edge pixel
+
+    /**
+     * @brief Direction of the gradient, rounded to 45 degrees
+     * @return 0 horizontal, 1 vertical, 2 diagonal with opposite signs, 3 diagonal with equal signs
+     */
+    static inline int gradientSector(short dx, short dy) {
+        int xs = std::abs(static_cast<int>(dx));
+        int ys = std::abs(static_cast<int>(dy)) << CANNY_SHIFT;
+        int tg22x = xs * CANNY_TG22;
+        if (ys < tg22x) {
+            return 0;
+        }
+        int tg67x = tg22x + (xs << (CANNY_SHIFT + 1));
+        if (ys > tg67x) {
+            return 1;
+        }
+        return (dx ^ dy) < 0 ? 2 : 3;
+    }
+
+    static inline int gradientSector(float dx, float dy) {
+        float xs = std::abs(dx);
+        float ys = std::abs(dy);
+        float tg22x = xs * CANNY_TG22_FLOAT;
+        if (ys < tg22x) {
+            return 0;
+        }
+        if (ys > tg22x + 2.0f * xs) {
+            return 1;
+        }
+        return (dx < 0) != (dy < 0) ? 2 : 3;
+    }
+
+    bool CannyDetector::isSupported(const cv::Mat& src, int apertureSize) {
+        int channels = src.channels();
+        return !src.empty() && src.depth() == CV_8U && (channels == 1 || channels == 3 || channels == 4) &&
+            (apertureSize == 3 || apertureSize == 5 || apertureSize == 7);
+    }
+
+    int CannyDetector::bandBegin(int band) const {
+        return rowBandStart(m_dx.rows, band, m_bandCount);
+    }
+
+    template <typename T, typename M>
+    void CannyDetector::suppressBand(int rowBegin, int rowEnd, M low, M high, bool L2gradient,
+        std::vector<M>& magnitude, std::vector<uchar*>& stack) {
+        const int width = m_dx.cols;
+        const int rows = m_dx.rows;
+        const int paddedWidth = width + 2;
+
+        // Ring of three magnitude rows with a zero on each side; row r lives in slot (r - rowBegin + 1) % 3
+        magnitude.assign(3 * static_cast<size_t>(paddedWidth), M(0));
+        auto slot = [&](int r) { return &magnitude[static_cast<size_t>((r - rowBegin + 1) % 3) * paddedWidth] + 1; };
+        auto computeRow = [&](int r) {
+            M* out = slot(r);
+            if (r < 0 || r >= rows) {
+                std::fill(out, out + width, M(0));
+                return;
+            }
+
+            const T* dx = m_dx.ptr<T>(r);
+            const T* dy = m_dy.ptr<T>(r);
+            if (L2gradient) {
+                for (int x = 0; x < width; ++x) {
+                    out[x] = static_cast<M>(dx[x]) * static_cast<M>(dx[x]) + static_cast<M>(dy[x]) * static_cast<M>(dy[x]);
+                }
+            }
+            else {
+                for (int x = 0; x < width; ++x) {
+                    out[x] = std::abs(static_cast<M>(dx[x])) + std::abs(static_cast<M>(dy[x]));
+                }
+            }
+        };
+
+        computeRow(rowBegin - 1);
+        computeRow(rowBegin);
+
+        for (int y = rowBegin; y < rowEnd; ++y) {
+            computeRow(y + 1);
+            const M* previous = slot(y - 1);
+            const M* current = slot(y);
+            const M* next = slot(y + 1);
+            const T* dx = m_dx.ptr<T>(y);
+            const T* dy = m_dy.ptr<T>(y);
+            uchar* map = m_map.ptr<uchar>(y + 1) + 1;
+
+            for (int x = 0; x < width; ++x) {
+                M m = current[x];
+                uchar code = CANNY_NONE;
+
+                if (m > low) {
+                    // Keep only local maxima across the edge, with the same tie-breaking as cv::Canny
+                    bool maximum;
+                    switch (gradientSector(dx[x], dy[x])) {
+                    case 0:
+                        maximum = m > current[x - 1] && m >= current[x + 1];
+                        break;
+                    case 1:
+                        maximum = m > previous[x] && m >= next[x];
+                        break;
+                    case 2:
+                        maximum = m > previous[x + 1] && m > next[x - 1];
+                        break;
+                    default:
+                        maximum = m > previous[x - 1] && m > next[x + 1];
+                        break;
+                    }
+
+                    if (maximum) {
+                        code = m > high ? CANNY_EDGE : CANNY_WEAK;
+                    }
+                }
+
+                map[x] = code;
+                if (code == CANNY_EDGE) {
+                    stack.push_back(map + x);
+                }
+            }
+        }
+    }
+
+    void CannyDetector::traceEdges(std::vector<uchar*>& stack, int rowBegin, int rowEnd) {
+        // Map rows are contiguous, so a row range is a pointer range; the
+        // border columns are never weak, so steps across them stop there
+        const std::ptrdiff_t step = static_cast<std::ptrdiff_t>(m_map.step);
+        const uchar* first = m_map.ptr<uchar>(rowBegin + 1);
+        const uchar* last = m_map.ptr<uchar>(rowEnd + 1);
+        const std::ptrdiff_t offsets[8] = { -step - 1, -step, -step + 1, -1, 1, step - 1, step, step + 1 };
+
+        while (!stack.empty()) {
+            uchar* pixel = stack.back();
+            stack.pop_back();
+
+            for (std::ptrdiff_t offset : offsets) {
+                uchar* neighbour = pixel + offset;
+                if (neighbour >= first && neighbour < last && *neighbour == CANNY_WEAK) {
+                    *neighbour = CANNY_EDGE;
+                    stack.push_back(neighbour);
+                }
+            }
+        }
+    }
+
+    bool CannyDetector::detect(const cv::Mat& src, cv::Mat& edges, double lowThreshold, double highThreshold,
+        int apertureSize, bool L2gradient) {
+        if (!isSupported(src, apertureSize)) {
+            std::cerr << "CannyDetector::detect: Source must be an 8-bit image with 1, 3 or 4 channels "
+                << "and the aperture size 3, 5 or 7." << std::endl;
+            return false;
+        }
+
+        if (lowThreshold > highThreshold) {
+            std::swap(lowThreshold, highThreshold);
+        }
+
+        cv::Mat gray = src;
+        if (src.channels() > 1) {
+            cv::cvtColor(src, m_gray, cv::COLOR_BGR2GRAY);
+            gray = m_gray;
+        }
+
+        const int rows = gray.rows;
+        const int cols = gray.cols;
+
+        // A 7x7 Sobel can exceed the CV_16S range, so its gradients are kept in floating point
+        const int gradientDepth = apertureSize == 7 ? CV_32F : CV_16S;
+        m_dx.create(rows, cols, gradientDepth);
+        m_dy.create(rows, cols, gradientDepth);
+        m_map.create(rows + 2, cols + 2, CV_8U);
+
+        std::memset(m_map.ptr<uchar>(0), CANNY_NONE, cols + 2);
+        std::memset(m_map.ptr<uchar>(rows + 1), CANNY_NONE, cols + 2);
+        for (int y = 1; y <= rows; ++y) {
+            m_map.ptr<uchar>(y)[0] = CANNY_NONE;
+            m_map.ptr<uchar>(y)[cols + 1] = CANNY_NONE;
+        }
+
+        m_bandCount = rowBandCount(rows, DEFAULT_MIN_BAND_ROWS);
+        if (static_cast<int>(m_bands.size()) < m_bandCount) {
+            m_bands.resize(m_bandCount);
+        }
+
+        // Gradients of each band, written into the shared buffers; the rows
+        // next to a band are read from the image, so bands do not add borders
+        parallelForBands(rows, m_bandCount, [&](int, int rowBegin, int rowEnd) {
+            cv::Mat dx = m_dx.rowRange(rowBegin, rowEnd);
+            cv::Mat dy = m_dy.rowRange(rowBegin, rowEnd);
+            cv::Sobel(gray.rowRange(rowBegin, rowEnd), dx, gradientDepth, 1, 0, apertureSize, 1, 0, cv::BORDER_REPLICATE);
+            cv::Sobel(gray.rowRange(rowBegin, rowEnd), dy, gradientDepth, 0, 1, apertureSize, 1, 0, cv::BORDER_REPLICATE);
+        });
+
+        // Thresholds are compared with the magnitude, or with its square for the L2 norm
+        double low = lowThreshold;
+        double high = highThreshold;
+        if (L2gradient) {
+            if (gradientDepth == CV_16S) {
+                low = std::min(32767.0, low);
+                high = std::min(32767.0, high);
+            }
+            low = low > 0 ? low * low : low;
+            high = high > 0 ? high * high : high;
+        }
+
+        // Non-maximum suppression, then hysteresis within each band
+        parallelForBands(rows, m_bandCount, [&](int band, int rowBegin, int rowEnd) {
+            BandScratch& scratch = m_bands[band];
+            scratch.stack.clear();
+
+            if (gradientDepth == CV_16S) {
+                suppressBand<short, int>(rowBegin, rowEnd, static_cast<int>(std::floor(low)),
+                    static_cast<int>(std::floor(high)), L2gradient, scratch.intMagnitude, scratch.stack);
+            }
+            else {
+                suppressBand<float, float>(rowBegin, rowEnd, static_cast<float>(low), static_cast<float>(high),
+                    L2gradient, scratch.floatMagnitude, scratch.stack);
+            }
+
+            traceEdges(scratch.stack, rowBegin, rowEnd);
+        });
+
+        // Edges that reach a band boundary next to a weak pixel continue across it
+        std::vector<uchar*>& stack = m_bands[0].stack;
+        stack.clear();
+        for (int band = 1; band < m_bandCount; ++band) {
+            int boundary = bandBegin(band);
+            uchar* above = m_map.ptr<uchar>(boundary) + 1;
+            uchar* below = m_map.ptr<uchar>(boundary + 1) + 1;
+            for (int x = 0; x < cols; ++x) {
+                if (above[x] == CANNY_EDGE &&
+                    (below[x - 1] == CANNY_WEAK || below[x] == CANNY_WEAK || below[x + 1] == CANNY_WEAK)) {
+                    stack.push_back(above + x);
+                }
+                if (below[x] == CANNY_EDGE &&
+                    (above[x - 1] == CANNY_WEAK || above[x] == CANNY_WEAK || above[x + 1] == CANNY_WEAK)) {
+                    stack.push_back(below + x);
+                }
+            }
+        }
+        traceEdges(stack, 0, rows);
+
+        edges.create(rows, cols, CV_8UC1);
+        parallelForBands(rows, m_bandCount, [&](int, int rowBegin, int rowEnd) {
+            for (int y = rowBegin; y < rowEnd; ++y) {
+                const uchar* map = m_map.ptr<uchar>(y + 1) + 1;
+                uchar* out = edges.ptr<uchar>(y);
+                for (int x = 0; x < cols; ++x) {
+                    out[x] = map[x] == CANNY_EDGE ? 255 : 0;
+                }
+            }
+        });
+
+        return true;
+    }
+
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+namespace image_processor {
+
+    /**
+     * @brief Parallel Canny edge detector with reusable scratch buffers
+     *
+     * Follows cv::Canny step by step (Sobel gradients with replicated
+     * borders, non-maximum suppression in four directions, hysteresis over
+     * 8-connected pixels) and produces the same edge map for gray input and
+     * apertures of 3 and 5; color input is converted to gray first, and the
+     * 7x7 gradients are kept in floating point instead of CV_16S. The gray image,
+     * the gradients and the edge map are kept between calls, so processing a
+     * video stream of constant frame size allocates only the output.
+     *
+     * Gradients and non-maximum suppression run in parallel row bands.
+     * Hysteresis first grows edges within each band in parallel; strong pixels
+     * on a band boundary that touch a weak pixel of the neighbouring band then
+     * seed a final pass over the whole map, so edges crossing bands are traced
+     * exactly as in a sequential run.
+     *
+     * A detector is not safe to use from several threads at once.
+     */
+    class CannyDetector {
+    public:
+        /**
+         * @brief Check whether detect can process an image
+         * @param src The source image
+         * @param apertureSize Aperture size of the Sobel operator
+         * @return True for 8-bit images with 1, 3 or 4 channels and an aperture of 3, 5 or 7
+         */
+        static bool isSupported(const cv::Mat& src, int apertureSize);
+
+        /**
+         * @brief Detect edges in an image
+         * @param src Source image (8U, with 1 channel, or 3 or 4 channels in BGR order)
+         * @param edges Destination edge map, allocated as CV_8UC1 (255 on edges, 0 elsewhere)
+         * @param lowThreshold Threshold below which gradients are never edges
+         * @param highThreshold Threshold above which gradients always start edges
+         * @param apertureSize Aperture size of the Sobel operator (3, 5 or 7)
+         * @param L2gradient Use the L2 norm of the gradient instead of the L1 norm
+         * @return True if edges were detected, false if the arguments are invalid
+         */
+        bool detect(const cv::Mat& src, cv::Mat& edges, double lowThreshold, double highThreshold,
+            int apertureSize = 3, bool L2gradient = false);
+
+    private:
+        /**
+         * @brief Scratch buffers owned by one row band
+         */
+        struct BandScratch {
+            std::vector<int> intMagnitude;      // Ring of three magnitude rows for CV_16S gradients
+            std::vector<float> floatMagnitude;  // Ring of three magnitude rows for CV_32F gradients
+            std::vector<uchar*> stack;          // Edge pixels whose neighbours are still to be traced
+        };
+
+        template <typename T, typename M>
+        void suppressBand(int rowBegin, int rowEnd, M low, M high, bool L2gradient,
+            std::vector<M>& magnitude, std::vector<uchar*>& stack);
+
+        void traceEdges(std::vector<uchar*>& stack, int rowBegin, int rowEnd);
+
+        int bandBegin(int band) const;
+
+        cv::Mat m_gray;                       // Gray conversion of color input
+        cv::Mat m_dx;                         // Horizontal derivative
+        cv::Mat m_dy;                         // Vertical derivative
+        cv::Mat m_map;                        // Edge map with a one-pixel border (0 weak, 1 none, 2 edge)
+        std::vector<BandScratch> m_bands;     // Per-band scratch buffers
+        int m_bandCount = 0;                  // Number of bands of the current image
+    };
+
+}
@@ -0,0 +1,127 @@
+#include "cpu_dispatch.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+#ifdef IMAGE_PROCESSOR_X86
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace image_processor {
+
+    // Override set by setCpuIsaOverride, or -1 when none is set
+    static std::atomic<int> s_cpuIsaOverride(-1);
+
+    static const char* const CPU_ISA_NAMES[] = { "scalar", "sse4.2", "avx2", "avx512" };
+    static const int CPU_ISA_COUNT = sizeof(CPU_ISA_NAMES) / sizeof(CPU_ISA_NAMES[0]);
+
+#ifdef IMAGE_PROCESSOR_X86
+    static void readCpuid(uint32_t leaf, uint32_t subleaf, uint32_t registers[4]) {
+#if defined(_MSC_VER)
+        int values[4];
+        __cpuidex(values, static_cast<int>(leaf), static_cast<int>(subleaf));
+        for (int i = 0; i < 4; ++i) {
+            registers[i] = static_cast<uint32_t>(values[i]);
+        }
+#else
+        __cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+    }
+
+    static uint64_t readXcr0() {
+#if defined(_MSC_VER)
+        return _xgetbv(0);
+#else
+        uint32_t low = 0;
+        uint32_t high = 0;
+        __asm__ volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+        return (static_cast<uint64_t>(high) << 32) | low;
+#endif
+    }
+
+    static CpuIsa queryCpuIsa() {
+        uint32_t registers[4] = { 0, 0, 0, 0 };
+        readCpuid(0, 0, registers);
+        const uint32_t maxLeaf = registers[0];
+        if (maxLeaf < 1) {
+            return CpuIsa::SCALAR;
+        }
+
+        readCpuid(1, 0, registers);
+        const bool sse42 = (registers[2] & (1u << 20)) != 0;
+        const bool osxsave = (registers[2] & (1u << 27)) != 0;
+        const bool avx = (registers[2] & (1u << 28)) != 0;
+        const bool f16c = (registers[2] & (1u << 29)) != 0;
+        if (!sse42) {
+            return CpuIsa::SCALAR;
+        }
+        if (!osxsave || !avx || maxLeaf < 7) {
+            return CpuIsa::SSE42;
+        }
+
+        // The operating system must save the YMM (and for AVX-512 the ZMM and mask) registers
+        const uint64_t xcr0 = readXcr0();
+        const bool ymmState = (xcr0 & 0x6) == 0x6;
+        const bool zmmState = (xcr0 & 0xE6) == 0xE6;
+
+        readCpuid(7, 0, registers);
+        const bool avx2 = (registers[1] & (1u << 5)) != 0;
+        const bool avx512f = (registers[1] & (1u << 16)) != 0;
+        const bool avx512bw = (registers[1] & (1u << 30)) != 0;
+
+        if (!ymmState || !avx2 || !f16c) {
+            return CpuIsa::SSE42;
+        }
+        if (!zmmState || !avx512f || !avx512bw) {
+            return CpuIsa::AVX2;
+        }
+        return CpuIsa::AVX512;
+    }
+#else
+    static CpuIsa queryCpuIsa() {
+        return CpuIsa::SCALAR;
+    }
+#endif
+
+    CpuIsa detectCpuIsa() {
+        static const CpuIsa detected = queryCpuIsa();
+        return detected;
+    }
+
+    CpuIsa activeCpuIsa() {
+        int isaOverride = s_cpuIsaOverride.load(std::memory_order_relaxed);
+        if (isaOverride < 0) {
+            return detectCpuIsa();
+        }
+        return static_cast<CpuIsa>(isaOverride);
+    }
+
+    void setCpuIsaOverride(CpuIsa isa) {
+        int level = std::min(static_cast<int>(isa), static_cast<int>(detectCpuIsa()));
+        s_cpuIsaOverride.store(level, std::memory_order_relaxed);
+    }
+
+    void clearCpuIsaOverride() {
+        s_cpuIsaOverride.store(-1, std::memory_order_relaxed);
+    }
+
+    const char* cpuIsaName(CpuIsa isa) {
+        int index = static_cast<int>(isa);
+        return index >= 0 && index < CPU_ISA_COUNT ? CPU_ISA_NAMES[index] : "unknown";
+    }
+
+    bool parseCpuIsa(const std::string& name, CpuIsa& isa) {
+        for (int i = 0; i < CPU_ISA_COUNT; ++i) {
+            if (name == CPU_ISA_NAMES[i]) {
+                isa = static_cast<CpuIsa>(i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+}
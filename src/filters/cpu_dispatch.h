@@ -0,0 +1,69 @@
+#pragma once
+
+#include <string>
+
+// Defined when compiling for x86, where the SSE4.2, AVX2 and AVX-512 kernel variants exist
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define IMAGE_PROCESSOR_X86 1
+#endif
+
+namespace image_processor {
+
+    /**
+     * @brief Instruction set levels with their own kernel variants, in increasing order
+     */
+    enum class CpuIsa {
+        SCALAR,     // Portable C++ only
+        SSE42,      // SSE4.2
+        AVX2,       // AVX2 and F16C
+        AVX512      // AVX-512 F and BW
+    };
+
+    /**
+     * @brief Best instruction set supported by the processor and the operating system
+     *
+     * Reads CPUID (and XGETBV for the register state saved by the operating
+     * system) on the first call; later calls return the cached result.
+     * Always SCALAR on processors other than x86.
+     *
+     * @return The detected instruction set level
+     */
+    CpuIsa detectCpuIsa();
+
+    /**
+     * @brief Instruction set used by the dispatched kernels
+     * @return The override if one is set, otherwise the detected level
+     */
+    CpuIsa activeCpuIsa();
+
+    /**
+     * @brief Force the dispatched kernels to a lower instruction set (e.g. for testing)
+     *
+     * Levels above the detected one are clamped to it, so an override can
+     * never select instructions the processor does not have.
+     *
+     * @param isa The instruction set to use
+     */
+    void setCpuIsaOverride(CpuIsa isa);
+
+    /**
+     * @brief Return to the detected instruction set
+     */
+    void clearCpuIsaOverride();
+
+    /**
+     * @brief Get the name of an instruction set level
+     * @param isa The instruction set level
+     * @return "scalar", "sse4.2", "avx2" or "avx512"
+     */
+    const char* cpuIsaName(CpuIsa isa);
+
+    /**
+     * @brief Parse the name of an instruction set level
+     * @param name One of the names returned by cpuIsaName
+     * @param isa Receives the parsed level
+     * @return True if the name was recognised, false otherwise
+     */
+    bool parseCpuIsa(const std::string& name, CpuIsa& isa);
+
+}
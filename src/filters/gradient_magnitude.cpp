@@ -0,0 +1,102 @@
+#include "gradient_magnitude.h"
+#include "row_bands.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+namespace image_processor {
+
+    // Fixed-point BGR to gray coefficients, as used by cv::cvtColor for 8-bit images
+    static const int GRAY_SHIFT = 14;
+    static const int GRAY_BLUE = 1868;
+    static const int GRAY_GREEN = 9617;
+    static const int GRAY_RED = 4899;
+
+    /**
+     * @brief Load one source row as gray values, padded by one reflected pixel on each side
+     */
+    static void loadGrayRow(const cv::Mat& src, int y, int* row) {
+        const int width = src.cols;
+        const int channels = src.channels();
+        const uchar* pixels = src.ptr<uchar>(y);
+        int* gray = row + 1;
+
+        if (channels == 1) {
+            for (int x = 0; x < width; ++x) {
+                gray[x] = pixels[x];
+            }
+        }
+        else {
+            for (int x = 0; x < width; ++x) {
+                const uchar* pixel = pixels + x * channels;
+                gray[x] = (pixel[0] * GRAY_BLUE + pixel[1] * GRAY_GREEN + pixel[2] * GRAY_RED +
+                    (1 << (GRAY_SHIFT - 1))) >> GRAY_SHIFT;
+            }
+        }
+
+        row[0] = gray[cv::borderInterpolate(-1, width, cv::BORDER_REFLECT_101)];
+        row[width + 1] = gray[cv::borderInterpolate(width, width, cv::BORDER_REFLECT_101)];
+    }
+
+    static void gradientMagnitudeBand(const cv::Mat& src, cv::Mat& dst, int side, int center,
+        int rowBegin, int rowEnd) {
+        const int width = src.cols;
+        const int paddedWidth = width + 2;
+
+        // Ring of three gray rows; source row r lives in slot (r - rowBegin + 1) % 3
+        std::vector<int> ring(3 * static_cast<size_t>(paddedWidth));
+        auto slot = [&](int r) { return &ring[static_cast<size_t>((r - rowBegin + 1) % 3) * paddedWidth]; };
+        auto load = [&](int r) { loadGrayRow(src, cv::borderInterpolate(r, src.rows, cv::BORDER_REFLECT_101), slot(r)); };
+
+        load(rowBegin - 1);
+        load(rowBegin);
+
+        for (int y = rowBegin; y < rowEnd; ++y) {
+            load(y + 1);
+            const int* top = slot(y - 1) + 1;
+            const int* middle = slot(y) + 1;
+            const int* bottom = slot(y + 1) + 1;
+            uchar* out = dst.ptr<uchar>(y);
+
+            for (int x = 0; x < width; ++x) {
+                int gradX = side * (top[x + 1] - top[x - 1]) + center * (middle[x + 1] - middle[x - 1]) +
+                    side * (bottom[x + 1] - bottom[x - 1]);
+                int gradY = side * (bottom[x - 1] - top[x - 1]) + center * (bottom[x] - top[x]) +
+                    side * (bottom[x + 1] - top[x + 1]);
+
+                // convertScaleAbs saturates each magnitude, and addWeighted rounds
+                // the average half to even
+                int sum = std::min(std::abs(gradX), 255) + std::min(std::abs(gradY), 255);
+                int average = sum >> 1;
+                average += sum & average & 1;
+                out[x] = static_cast<uchar>(average);
+            }
+        }
+    }
+
+    bool isFusedGradientSupported(const cv::Mat& src) {
+        int channels = src.channels();
+        return !src.empty() && src.depth() == CV_8U && (channels == 1 || channels == 3 || channels == 4);
+    }
+
+    bool fusedGradientMagnitude(const cv::Mat& src, cv::Mat& dst, GradientOperator op) {
+        if (!isFusedGradientSupported(src)) {
+            std::cerr << "fusedGradientMagnitude: Source must be an 8-bit image with 1, 3 or 4 channels." << std::endl;
+            return false;
+        }
+
+        const int side = op == GradientOperator::SCHARR ? 3 : 1;
+        const int center = op == GradientOperator::SCHARR ? 10 : 2;
+
+        cv::Mat result(src.rows, src.cols, CV_8UC1);
+        parallelForRowBands(src.rows, DEFAULT_MIN_BAND_ROWS, [&](int rowBegin, int rowEnd) {
+            gradientMagnitudeBand(src, result, side, center, rowBegin, rowEnd);
+        });
+
+        dst = result;
+        return true;
+    }
+
+}
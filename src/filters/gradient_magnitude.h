@@ -0,0 +1,41 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+namespace image_processor {
+
+    /**
+     * @brief 3x3 derivative operators supported by the fused gradient kernel
+     */
+    enum class GradientOperator {
+        SOBEL,   // Sobel weights (1, 2, 1)
+        SCHARR   // Scharr weights (3, 10, 3)
+    };
+
+    /**
+     * @brief Check whether fusedGradientMagnitude can process an image
+     * @param src The source image
+     * @return True for 8-bit images with 1, 3 or 4 channels
+     */
+    bool isFusedGradientSupported(const cv::Mat& src);
+
+    /**
+     * @brief Gradient magnitude of an 8-bit image in a single pass
+     *
+     * Computes both 3x3 derivatives, their saturated absolute values and
+     * their average from a sliding window of three rows, without full-frame
+     * intermediates. The result is bit-exact with cv::Sobel or cv::Scharr
+     * into CV_16S, cv::convertScaleAbs on both, and
+     * cv::addWeighted(gradX, 0.5, gradY, 0.5, 0), with BORDER_REFLECT_101.
+     * Color images are converted to gray on the fly with the fixed-point
+     * coefficients of cv::cvtColor(COLOR_BGR2GRAY). Rows are processed in
+     * parallel bands.
+     *
+     * @param src Source image (8U, with 1 channel, or 3 or 4 channels in BGR order)
+     * @param dst Destination image, allocated as CV_8UC1 with the size of src
+     * @param op The derivative operator
+     * @return True if the image was filtered, false if the image is not supported
+     */
+    bool fusedGradientMagnitude(const cv::Mat& src, cv::Mat& dst, GradientOperator op);
+
+}
@@ -0,0 +1,366 @@
+#include "histogram.h"
+#include "row_bands.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+
+namespace image_processor {
+
+    // Largest number of classes accepted by multiOtsuThresholds
+    static const int MULTI_OTSU_MAX_LEVELS = 16;
+
+    // Larger histograms are merged to this many bins before the multi-level Otsu search
+    static const int MULTI_OTSU_MAX_BINS = 256;
+
+    template <typename T>
+    static inline int histogramBin(T value, int bins);
+
+    template <>
+    inline int histogramBin<uchar>(uchar value, int bins) {
+        return (value * bins) >> 8;
+    }
+
+    template <>
+    inline int histogramBin<ushort>(ushort value, int bins) {
+        return static_cast<int>((static_cast<int64_t>(value) * bins) >> 16);
+    }
+
+    template <>
+    inline int histogramBin<float>(float value, int bins) {
+        int bin = static_cast<int>(std::floor(value * bins));
+        return std::min(std::max(bin, 0), bins - 1);
+    }
+
+    template <typename T>
+    static void countBand(const cv::Mat& src, int rowBegin, int rowEnd, int bins, std::vector<uint32_t>& counts) {
+        counts.assign(bins, 0);
+        for (int y = rowBegin; y < rowEnd; ++y) {
+            const T* row = src.ptr<T>(y);
+            for (int x = 0; x < src.cols; ++x) {
+                ++counts[histogramBin<T>(row[x], bins)];
+            }
+        }
+    }
+
+    bool parallelHistogram(const cv::Mat& src, cv::Mat& hist, int bins) {
+        if (src.empty()) {
+            std::cerr << "parallelHistogram: Source image is empty." << std::endl;
+            return false;
+        }
+
+        int depth = src.depth();
+        if (src.channels() != 1 || (depth != CV_8U && depth != CV_16U && depth != CV_32F)) {
+            std::cerr << "parallelHistogram: Source must be a single-channel 8U, 16U or 32F image." << std::endl;
+            return false;
+        }
+
+        if (bins < 2 || bins > 65536) {
+            std::cerr << "parallelHistogram: Number of bins must be between 2 and 65536." << std::endl;
+            return false;
+        }
+
+        const int bandCount = rowBandCount(src.rows, DEFAULT_MIN_BAND_ROWS);
+        std::vector<std::vector<uint32_t>> partials(bandCount);
+
+        parallelForBands(src.rows, bandCount, [&](int band, int rowBegin, int rowEnd) {
+            if (depth == CV_8U) {
+                countBand<uchar>(src, rowBegin, rowEnd, bins, partials[band]);
+            }
+            else if (depth == CV_16U) {
+                countBand<ushort>(src, rowBegin, rowEnd, bins, partials[band]);
+            }
+            else {
+                countBand<float>(src, rowBegin, rowEnd, bins, partials[band]);
+            }
+        });
+
+        // Merge the partial histograms
+        cv::Mat result(1, bins, CV_32F);
+        float* out = result.ptr<float>(0);
+        for (int bin = 0; bin < bins; ++bin) {
+            uint64_t count = 0;
+            for (const auto& partial : partials) {
+                count += partial[bin];
+            }
+            out[bin] = static_cast<float>(count);
+        }
+
+        hist = result;
+        return true;
+    }
+
+    double histogramBinToThreshold(int bin, int bins, int depth) {
+        if (depth == CV_32F) {
+            return static_cast<double>(bin + 1) / bins;
+        }
+
+        // The first value in bin + 1 is ceil((bin + 1) * range / bins)
+        int64_t range = depth == CV_16U ? 65536 : 256;
+        int64_t firstAbove = ((bin + 1) * range + bins - 1) / bins;
+        return static_cast<double>(firstAbove - 1);
+    }
+
+    static std::vector<double> histogramCounts(const cv::Mat& hist) {
+        std::vector<double> counts(hist.total());
+        const float* data = hist.ptr<float>(0);
+        for (size_t i = 0; i < counts.size(); ++i) {
+            counts[i] = data[i];
+        }
+        return counts;
+    }
+
+    int otsuThreshold(const cv::Mat& hist) {
+        std::vector<double> h = histogramCounts(hist);
+        const int N = static_cast<int>(h.size());
+
+        double total = 0;
+        double mu = 0;
+        for (int i = 0; i < N; ++i) {
+            total += h[i];
+            mu += i * h[i];
+        }
+        if (total <= 0) {
+            return 0;
+        }
+
+        // Follows cv::threshold (getThreshVal_Otsu_8u) step by step
+        double scale = 1.0 / total;
+        mu *= scale;
+        double mu1 = 0;
+        double q1 = 0;
+        double maxSigma = 0;
+        int maxBin = 0;
+
+        for (int i = 0; i < N; ++i) {
+            double p = h[i] * scale;
+            mu1 *= q1;
+            q1 += p;
+            double q2 = 1.0 - q1;
+
+            if (std::min(q1, q2) < FLT_EPSILON || std::max(q1, q2) > 1.0 - FLT_EPSILON) {
+                continue;
+            }
+
+            mu1 = (mu1 + i * p) / q1;
+            double mu2 = (mu - q1 * mu1) / q2;
+            double sigma = q1 * q2 * (mu1 - mu2) * (mu1 - mu2);
+            if (sigma > maxSigma) {
+                maxSigma = sigma;
+                maxBin = i;
+            }
+        }
+
+        return maxBin;
+    }
+
+    std::vector<int> multiOtsuThresholds(const cv::Mat& hist, int levels) {
+        std::vector<double> counts = histogramCounts(hist);
+        const int64_t bins = static_cast<int64_t>(counts.size());
+
+        // The search is quadratic in the bin count, so larger histograms are
+        // merged first; merged bin k covers bins [first(k), first(k + 1))
+        const int N = static_cast<int>(std::min<int64_t>(bins, MULTI_OTSU_MAX_BINS));
+        auto first = [&](int k) {
+            return static_cast<int>(k * bins / N);
+        };
+        std::vector<double> h(N, 0.0);
+        for (int k = 0; k < N; ++k) {
+            for (int i = first(k); i < first(k + 1); ++i) {
+                h[k] += counts[i];
+            }
+        }
+        levels = std::min(std::max(levels, 2), std::min(MULTI_OTSU_MAX_LEVELS, N));
+
+        // Prefix sums of counts and of bin-weighted counts
+        std::vector<double> P(N + 1, 0.0);
+        std::vector<double> S(N + 1, 0.0);
+        for (int i = 0; i < N; ++i) {
+            P[i + 1] = P[i] + h[i];
+            S[i + 1] = S[i] + i * h[i];
+        }
+
+        // Maximizing the between-class variance is maximizing the sum of
+        // S^2 / P over the classes; a class covers bins [begin, end)
+        auto classScore = [&](int begin, int end) {
+            double count = P[end] - P[begin];
+            double sum = S[end] - S[begin];
+            return count > 0 ? sum * sum / count : 0.0;
+        };
+
+        const double unreachable = -std::numeric_limits<double>::infinity();
+        std::vector<double> previous(N + 1, unreachable);
+        std::vector<double> current(N + 1, unreachable);
+        std::vector<std::vector<int>> split(levels, std::vector<int>(N + 1, 0));
+
+        for (int end = 1; end <= N; ++end) {
+            previous[end] = classScore(0, end);
+        }
+
+        // best(c, end) = max over begin of best(c - 1, begin) + score(begin, end)
+        for (int c = 2; c <= levels; ++c) {
+            std::fill(current.begin(), current.end(), unreachable);
+            for (int end = c; end <= N; ++end) {
+                for (int begin = c - 1; begin < end; ++begin) {
+                    double score = previous[begin] + classScore(begin, end);
+                    if (score > current[end]) {
+                        current[end] = score;
+                        split[c - 1][end] = begin;
+                    }
+                }
+            }
+            std::swap(previous, current);
+        }
+
+        std::vector<int> thresholds(levels - 1);
+        int end = N;
+        for (int c = levels; c >= 2; --c) {
+            end = split[c - 1][end];
+            thresholds[c - 2] = first(end) - 1;
+        }
+        return thresholds;
+    }
+
+    int triangleThreshold(const cv::Mat& hist) {
+        std::vector<double> h = histogramCounts(hist);
+        const int N = static_cast<int>(h.size());
+
+        // Follows cv::threshold (getThreshVal_Triangle_8u) step by step
+        int leftBound = 0;
+        int rightBound = 0;
+        int maxBin = 0;
+        double maxCount = 0;
+
+        for (int i = 0; i < N; ++i) {
+            if (h[i] > 0) {
+                leftBound = i;
+                break;
+            }
+        }
+        if (leftBound > 0) {
+            leftBound--;
+        }
+
+        for (int i = N - 1; i > 0; --i) {
+            if (h[i] > 0) {
+                rightBound = i;
+                break;
+            }
+        }
+        if (rightBound < N - 1) {
+            rightBound++;
+        }
+
+        for (int i = 0; i < N; ++i) {
+            if (h[i] > maxCount) {
+                maxCount = h[i];
+                maxBin = i;
+            }
+        }
+
+        // Measure from the longer side of the peak
+        bool flipped = false;
+        if (maxBin - leftBound < rightBound - maxBin) {
+            flipped = true;
+            std::reverse(h.begin(), h.end());
+            leftBound = N - 1 - rightBound;
+            maxBin = N - 1 - maxBin;
+        }
+
+        int threshold = leftBound;
+        double a = maxCount;
+        double b = leftBound - maxBin;
+        double maxDistance = 0;
+        for (int i = leftBound + 1; i <= maxBin; ++i) {
+            double distance = a * i + b * h[i];
+            if (distance > maxDistance) {
+                maxDistance = distance;
+                threshold = i;
+            }
+        }
+        threshold--;
+
+        if (flipped) {
+            threshold = N - 1 - threshold;
+        }
+        return threshold;
+    }
+
+    int percentileThreshold(const cv::Mat& hist, double percentile) {
+        std::vector<double> h = histogramCounts(hist);
+        const int N = static_cast<int>(h.size());
+
+        double total = 0;
+        for (double count : h) {
+            total += count;
+        }
+
+        double target = std::min(std::max(percentile, 0.0), 100.0) * 0.01 * total;
+        double cumulative = 0;
+        for (int i = 0; i < N; ++i) {
+            cumulative += h[i];
+            if (cumulative >= target) {
+                return i;
+            }
+        }
+        return N - 1;
+    }
+
+    template <typename T>
+    static void quantizeImage(const cv::Mat& src, cv::Mat& dst, const std::vector<double>& thresholds, double maxValue) {
+        // Output value for every number of thresholds exceeded
+        std::vector<T> levels(thresholds.size() + 1);
+        for (size_t k = 0; k < levels.size(); ++k) {
+            levels[k] = cv::saturate_cast<T>(k * maxValue / thresholds.size());
+        }
+
+        cv::parallel_for_(cv::Range(0, src.rows), [&](const cv::Range& range) {
+            for (int y = range.start; y < range.end; ++y) {
+                const T* in = src.ptr<T>(y);
+                T* out = dst.ptr<T>(y);
+                for (int x = 0; x < src.cols; ++x) {
+                    size_t k = 0;
+                    while (k < thresholds.size() && in[x] > thresholds[k]) {
+                        ++k;
+                    }
+                    out[x] = levels[k];
+                }
+            }
+        });
+    }
+
+    bool applyMultiThreshold(const cv::Mat& src, cv::Mat& dst, const std::vector<double>& thresholds, double maxValue) {
+        if (src.empty()) {
+            std::cerr << "applyMultiThreshold: Source image is empty." << std::endl;
+            return false;
+        }
+
+        int depth = src.depth();
+        if (src.channels() != 1 || (depth != CV_8U && depth != CV_16U && depth != CV_32F)) {
+            std::cerr << "applyMultiThreshold: Source must be a single-channel 8U, 16U or 32F image." << std::endl;
+            return false;
+        }
+
+        if (thresholds.empty()) {
+            std::cerr << "applyMultiThreshold: At least one threshold is required." << std::endl;
+            return false;
+        }
+
+        cv::Mat result(src.rows, src.cols, src.type());
+        if (depth == CV_8U) {
+            quantizeImage<uchar>(src, result, thresholds, maxValue);
+        }
+        else if (depth == CV_16U) {
+            quantizeImage<ushort>(src, result, thresholds, maxValue);
+        }
+        else {
+            quantizeImage<float>(src, result, thresholds, maxValue);
+        }
+
+        dst = result;
+        return true;
+    }
+
+}
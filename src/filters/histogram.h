@@ -0,0 +1,93 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+namespace image_processor {
+
+    /**
+     * @brief Histogram of a single-channel image, computed in parallel
+     *
+     * The bins split the value range of the depth evenly: [0, 256) for 8U,
+     * [0, 65536) for 16U and [0, 1] for 32F (values outside are clamped to
+     * the first or last bin). Each row band counts into its own partial
+     * histogram, and the partial histograms are summed at the end, so threads
+     * never write to shared counters.
+     *
+     * @param src Source image (8U, 16U or 32F, single channel)
+     * @param hist Destination histogram, a 1 x bins CV_32F matrix of counts
+     * @param bins Number of bins (2 to 65536)
+     * @return True if the histogram was computed, false if the arguments are invalid
+     */
+    bool parallelHistogram(const cv::Mat& src, cv::Mat& hist, int bins = 256);
+
+    /**
+     * @brief Convert a bin index into a threshold for cv::threshold
+     *
+     * Pixels greater than the returned value fall into bins after the given one.
+     *
+     * @param bin The last bin of the lower class
+     * @param bins Number of bins of the histogram
+     * @param depth Depth of the image the histogram was computed from
+     * @return The threshold in the value range of the image
+     */
+    double histogramBinToThreshold(int bin, int bins, int depth);
+
+    /**
+     * @brief Otsu threshold of a histogram
+     *
+     * Same search and tie-breaking as cv::threshold with THRESH_OTSU, so a
+     * 256-bin histogram of an 8-bit image gives the same threshold.
+     *
+     * @param hist A 1 x bins CV_32F histogram
+     * @return The last bin of the lower class
+     */
+    int otsuThreshold(const cv::Mat& hist);
+
+    /**
+     * @brief Multi-level Otsu thresholds of a histogram
+     *
+     * Finds the class boundaries that maximize the between-class variance
+     * exactly, by dynamic programming over prefix sums. The cost is
+     * O(levels * bins^2), so histograms of more than 256 bins are merged
+     * to 256 bins first; the thresholds still index the given histogram.
+     *
+     * @param hist A 1 x bins CV_32F histogram
+     * @param levels Number of classes (2 to 16)
+     * @return The last bin of each class but the last, in increasing order
+     */
+    std::vector<int> multiOtsuThresholds(const cv::Mat& hist, int levels);
+
+    /**
+     * @brief Triangle threshold of a histogram
+     *
+     * Same algorithm as cv::threshold with THRESH_TRIANGLE, suited to
+     * histograms with one dominant peak.
+     *
+     * @param hist A 1 x bins CV_32F histogram
+     * @return The last bin of the lower class
+     */
+    int triangleThreshold(const cv::Mat& hist);
+
+    /**
+     * @brief Bin below which a given share of the pixels falls
+     * @param hist A 1 x bins CV_32F histogram
+     * @param percentile Share of the pixels in percent (0 to 100)
+     * @return The first bin at which the cumulative count reaches the percentile
+     */
+    int percentileThreshold(const cv::Mat& hist, double percentile);
+
+    /**
+     * @brief Quantize an image into evenly spaced levels at several thresholds
+     *
+     * Pixels above k of the thresholds get the value k * maxValue / thresholds.size().
+     *
+     * @param src Source image (8U, 16U or 32F, single channel)
+     * @param dst Destination image, allocated with the size and type of src
+     * @param thresholds Thresholds in the value range of src, in increasing order
+     * @param maxValue Value of the highest level
+     * @return True if the image was quantized, false if the arguments are invalid
+     */
+    bool applyMultiThreshold(const cv::Mat& src, cv::Mat& dst, const std::vector<double>& thresholds, double maxValue);
+
+}
@@ -0,0 +1,151 @@
+#include "local_threshold.h"
+#include "row_bands.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace image_processor {
+
+    // Smallest number of rows per parallel band; each band first sums the rows of one block
+    static const int LOCAL_THRESHOLD_MIN_BAND_ROWS = 32;
+
+    /**
+     * @brief Settings shared by all bands
+     */
+    struct LocalThresholdSettings {
+        LocalThresholdMethod method;
+        int radius;
+        double maxValue;
+        double C;
+        double k;
+        double R;
+    };
+
+    template <typename T, typename ACC>
+    static void localThresholdBand(const cv::Mat& src, cv::Mat& dst, const LocalThresholdSettings& settings,
+        int rowBegin, int rowEnd) {
+        const int width = src.cols;
+        const int height = src.rows;
+        const int radius = settings.radius;
+        const bool needSquares = settings.method != LocalThresholdMethod::MEAN;
+        const T high = cv::saturate_cast<T>(settings.maxValue);
+
+        // Sums over the block rows of every column, and their prefix sums along the row
+        std::vector<ACC> columnSum(width, 0);
+        std::vector<ACC> columnSquares(needSquares ? width : 0, 0);
+        std::vector<ACC> prefix(width + 1, 0);
+        std::vector<ACC> prefixSquares(needSquares ? width + 1 : 0, 0);
+
+        auto addRow = [&](int y, int sign) {
+            const T* row = src.ptr<T>(y);
+            for (int x = 0; x < width; ++x) {
+                ACC value = static_cast<ACC>(row[x]);
+                columnSum[x] += sign * value;
+                if (needSquares) {
+                    columnSquares[x] += sign * value * value;
+                }
+            }
+        };
+
+        for (int y = std::max(0, rowBegin - radius); y <= std::min(height - 1, rowBegin + radius); ++y) {
+            addRow(y, 1);
+        }
+
+        for (int y = rowBegin; y < rowEnd; ++y) {
+            if (y > rowBegin) {
+                if (y - radius - 1 >= 0) {
+                    addRow(y - radius - 1, -1);
+                }
+                if (y + radius < height) {
+                    addRow(y + radius, 1);
+                }
+            }
+
+            for (int x = 0; x < width; ++x) {
+                prefix[x + 1] = prefix[x] + columnSum[x];
+                if (needSquares) {
+                    prefixSquares[x + 1] = prefixSquares[x] + columnSquares[x];
+                }
+            }
+
+            const int blockRows = std::min(height - 1, y + radius) - std::max(0, y - radius) + 1;
+            const T* in = src.ptr<T>(y);
+            T* out = dst.ptr<T>(y);
+
+            for (int x = 0; x < width; ++x) {
+                int left = std::max(0, x - radius);
+                int right = std::min(width - 1, x + radius);
+                double count = static_cast<double>(right - left + 1) * blockRows;
+                double mean = static_cast<double>(prefix[right + 1] - prefix[left]) / count;
+
+                double threshold;
+                if (settings.method == LocalThresholdMethod::MEAN) {
+                    threshold = mean - settings.C;
+                }
+                else {
+                    double meanSquare = static_cast<double>(prefixSquares[right + 1] - prefixSquares[left]) / count;
+                    double deviation = std::sqrt(std::max(meanSquare - mean * mean, 0.0));
+                    threshold = settings.method == LocalThresholdMethod::NIBLACK
+                        ? mean + settings.k * deviation
+                        : mean * (1.0 + settings.k * (deviation / settings.R - 1.0));
+                }
+
+                out[x] = static_cast<double>(in[x]) > threshold ? high : T(0);
+            }
+        }
+    }
+
+    template <typename T, typename ACC>
+    static void localThresholdImage(const cv::Mat& src, cv::Mat& dst, const LocalThresholdSettings& settings) {
+        const int minBandRows = std::max(LOCAL_THRESHOLD_MIN_BAND_ROWS, 2 * settings.radius + 1);
+        parallelForRowBands(src.rows, minBandRows, [&](int rowBegin, int rowEnd) {
+            localThresholdBand<T, ACC>(src, dst, settings, rowBegin, rowEnd);
+        });
+    }
+
+    bool localAdaptiveThreshold(const cv::Mat& src, cv::Mat& dst, double maxValue, int blockSize,
+        LocalThresholdMethod method, double C, double k, double R) {
+        if (src.empty()) {
+            std::cerr << "localAdaptiveThreshold: Source image is empty." << std::endl;
+            return false;
+        }
+
+        if (src.channels() != 1 || (src.depth() != CV_8U && src.depth() != CV_16U && src.depth() != CV_32F)) {
+            std::cerr << "localAdaptiveThreshold: Source must be a single-channel 8U, 16U or 32F image." << std::endl;
+            return false;
+        }
+
+        if (blockSize < 3 || blockSize % 2 == 0) {
+            std::cerr << "localAdaptiveThreshold: Block size must be odd and at least 3." << std::endl;
+            return false;
+        }
+
+        if (method == LocalThresholdMethod::SAUVOLA && R <= 0.0) {
+            std::cerr << "localAdaptiveThreshold: R must be positive." << std::endl;
+            return false;
+        }
+
+        LocalThresholdSettings settings = { method, blockSize / 2, maxValue, C, k, R };
+
+        cv::Mat result(src.rows, src.cols, src.type());
+
+        // Integer sums are exact; 16-bit squares over large blocks still fit in 64 bits
+        switch (src.depth()) {
+        case CV_8U:
+            localThresholdImage<uchar, int64_t>(src, result, settings);
+            break;
+        case CV_16U:
+            localThresholdImage<ushort, int64_t>(src, result, settings);
+            break;
+        default:
+            localThresholdImage<float, double>(src, result, settings);
+            break;
+        }
+
+        dst = result;
+        return true;
+    }
+
+}
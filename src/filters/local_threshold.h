@@ -0,0 +1,46 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+namespace image_processor {
+
+    /**
+     * @brief Rules for the per-pixel threshold of localAdaptiveThreshold
+     *
+     * m and s are the mean and standard deviation of the block around the pixel.
+     */
+    enum class LocalThresholdMethod {
+        MEAN,     // T = m - C
+        NIBLACK,  // T = m + k * s
+        SAUVOLA   // T = m * (1 + k * (s / R - 1))
+    };
+
+    /**
+     * @brief Adaptive threshold with a per-pixel cost independent of the block size
+     *
+     * The block sums of I and I^2 are read from integral images: each row
+     * band keeps running column sums over the rows of the block, and a prefix
+     * sum of those along the row gives the sum over any block in that row in
+     * two lookups. Bands are processed in parallel, each in a single pass
+     * over its rows with memory proportional to the image width.
+     *
+     * Blocks are clipped at the image border, and the statistics are taken
+     * over the pixels inside the image. cv::adaptiveThreshold replicates the
+     * border instead, so the MEAN method matches ADAPTIVE_THRESH_MEAN_C only
+     * away from the border.
+     *
+     * @param src Source image (8U, 16U or 32F, single channel)
+     * @param dst Destination image, allocated with the size and type of src
+     * @param maxValue Value of pixels above their threshold; other pixels are 0
+     * @param blockSize Size of the square block (odd, at least 3)
+     * @param method Rule for the threshold
+     * @param C Constant subtracted from the mean (MEAN)
+     * @param k Weight of the standard deviation (NIBLACK, typically -0.2;
+     *        SAUVOLA, typically 0.2 to 0.5)
+     * @param R Dynamic range of the standard deviation (SAUVOLA, 128 for 8-bit images)
+     * @return True if the image was thresholded, false if the arguments are invalid
+     */
+    bool localAdaptiveThreshold(const cv::Mat& src, cv::Mat& dst, double maxValue, int blockSize,
+        LocalThresholdMethod method, double C = 0.0, double k = 0.5, double R = 128.0);
+
+}
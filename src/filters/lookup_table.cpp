@@ -0,0 +1,49 @@
+#include "lookup_table.h"
+#include "row_bands.h"
+#include "simd_kernels.h"
+#include <iostream>
+
+namespace image_processor {
+
+    static void applyLookupTable16u(const cv::Mat& src, const cv::Mat& lut, cv::Mat& dst) {
+        const ushort* table = lut.ptr<ushort>(0);
+        const int samples = src.cols * src.channels();
+
+        parallelForRowBands(src.rows, DEFAULT_MIN_BAND_ROWS, [&](int rowBegin, int rowEnd) {
+            for (int y = rowBegin; y < rowEnd; ++y) {
+                lookupRow16u(src.ptr<ushort>(y), table, dst.ptr<ushort>(y), samples);
+            }
+        });
+    }
+
+    bool applyLookupTable(const cv::Mat& src, const cv::Mat& lut, cv::Mat& dst) {
+        if (src.empty()) {
+            std::cerr << "applyLookupTable: Source image is empty." << std::endl;
+            return false;
+        }
+
+        const int depth = src.depth();
+        if (depth != CV_8U && depth != CV_16U) {
+            std::cerr << "applyLookupTable: Source must be an 8U or 16U image." << std::endl;
+            return false;
+        }
+
+        const int entries = depth == CV_8U ? 256 : 65536;
+        if (lut.type() != depth || lut.total() != static_cast<size_t>(entries) || !lut.isContinuous()) {
+            std::cerr << "applyLookupTable: Table must have " << entries << " entries of the source depth." << std::endl;
+            return false;
+        }
+
+        if (depth == CV_8U) {
+            cv::LUT(src, lut, dst);
+            return true;
+        }
+
+        cv::Mat result(src.rows, src.cols, src.type());
+        applyLookupTable16u(src, lut, result);
+
+        dst = result;
+        return true;
+    }
+
+}
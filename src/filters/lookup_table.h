@@ -0,0 +1,21 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+namespace image_processor {
+
+    /**
+     * @brief Map every sample of an integer image through a lookup table
+     *
+     * 8-bit images use a 256-entry CV_8U table and are mapped with cv::LUT.
+     * 16-bit images use a 65536-entry CV_16U table and are mapped in parallel
+     * over row bands. All channels share the same table.
+     *
+     * @param src Source image (8U or 16U, any number of channels)
+     * @param lut Lookup table, a continuous 1 x 256 CV_8U or 1 x 65536 CV_16U matrix matching the depth of src
+     * @param dst Destination image, allocated with the size and type of src
+     * @return True if the image was mapped, false if the arguments are invalid
+     */
+    bool applyLookupTable(const cv::Mat& src, const cv::Mat& lut, cv::Mat& dst);
+
+}
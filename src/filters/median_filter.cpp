@@ -0,0 +1,225 @@
+#include "median_filter.h"
+#include "row_bands.h"
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace image_processor {
+
+    // Number of output columns processed per tile; keeps the column
+    // histograms of a tile in cache
+    static const int MEDIAN_TILE_WIDTH = 256;
+
+    // Number of quantization levels used for images that are not 8-bit
+    static const int MEDIAN_WIDE_LEVELS = 4096;
+
+    /**
+     * @brief Filter one row band of a single-channel image of level codes
+     *
+     * Codes are split into a coarse part (high bits) and a fine part (low
+     * bits) with FINE_BITS bits each. Column histograms are stored for both
+     * levels; the kernel keeps the full coarse histogram and updates a fine
+     * histogram lazily, only when the median falls into its coarse bin.
+     */
+    template <typename T, int FINE_BITS>
+    static void medianBand(const cv::Mat& src, cv::Mat& dst, int radius, int rowBegin, int rowEnd) {
+        const int FINE = 1 << FINE_BITS;
+        const int COARSE = FINE;
+        const int width = src.cols;
+        const int height = src.rows;
+        const int diameter = 2 * radius + 1;
+        const uint32_t rank = static_cast<uint32_t>(diameter) * diameter / 2;
+
+        std::vector<uint16_t> columnCoarse;
+        std::vector<uint16_t> columnFine;
+        std::vector<uint32_t> kernelFine(COARSE * FINE);
+        std::vector<int> lastColumn(COARSE);
+        uint32_t kernelCoarse[COARSE];
+
+        for (int tileBegin = 0; tileBegin < width; tileBegin += MEDIAN_TILE_WIDTH) {
+            const int tileEnd = std::min(tileBegin + MEDIAN_TILE_WIDTH, width);
+
+            // Columns whose histograms the tile reads; positions outside the
+            // image are clamped to the border columns
+            const int columnBegin = std::max(tileBegin - radius, 0);
+            const int columnEnd = std::min(tileEnd + radius, width);
+            const int columnCount = columnEnd - columnBegin;
+
+            columnCoarse.assign(static_cast<size_t>(columnCount) * COARSE, 0);
+            columnFine.assign(static_cast<size_t>(columnCount) * COARSE * FINE, 0);
+
+            auto clampColumn = [&](int x) {
+                return std::min(std::max(x, 0), width - 1) - columnBegin;
+            };
+
+            auto addRow = [&](int y) {
+                const T* row = src.ptr<T>(std::min(std::max(y, 0), height - 1));
+                for (int c = 0; c < columnCount; ++c) {
+                    int value = row[columnBegin + c];
+                    columnCoarse[c * COARSE + (value >> FINE_BITS)]++;
+                    columnFine[static_cast<size_t>(c) * COARSE * FINE + value]++;
+                }
+            };
+
+            auto removeRow = [&](int y) {
+                const T* row = src.ptr<T>(std::min(std::max(y, 0), height - 1));
+                for (int c = 0; c < columnCount; ++c) {
+                    int value = row[columnBegin + c];
+                    columnCoarse[c * COARSE + (value >> FINE_BITS)]--;
+                    columnFine[static_cast<size_t>(c) * COARSE * FINE + value]--;
+                }
+            };
+
+            for (int y = rowBegin - radius; y <= rowBegin + radius; ++y) {
+                addRow(y);
+            }
+
+            for (int y = rowBegin; y < rowEnd; ++y) {
+                if (y > rowBegin) {
+                    removeRow(y - radius - 1);
+                    addRow(y + radius);
+                }
+
+                // Coarse kernel histogram for the first column of the tile
+                std::fill(kernelCoarse, kernelCoarse + COARSE, 0u);
+                for (int x = tileBegin - radius; x <= tileBegin + radius; ++x) {
+                    const uint16_t* column = &columnCoarse[clampColumn(x) * COARSE];
+                    for (int bin = 0; bin < COARSE; ++bin) {
+                        kernelCoarse[bin] += column[bin];
+                    }
+                }
+
+                // Fine histograms are rebuilt on first use in this row
+                std::fill(lastColumn.begin(), lastColumn.end(), tileBegin - diameter - 1);
+
+                T* outputRow = dst.ptr<T>(y);
+                for (int x = tileBegin; x < tileEnd; ++x) {
+                    if (x > tileBegin) {
+                        const uint16_t* added = &columnCoarse[clampColumn(x + radius) * COARSE];
+                        const uint16_t* removed = &columnCoarse[clampColumn(x - radius - 1) * COARSE];
+                        for (int bin = 0; bin < COARSE; ++bin) {
+                            kernelCoarse[bin] += added[bin] - removed[bin];
+                        }
+                    }
+
+                    // Find the coarse bin containing the median
+                    uint32_t count = 0;
+                    int coarse = 0;
+                    while (count + kernelCoarse[coarse] <= rank) {
+                        count += kernelCoarse[coarse];
+                        coarse++;
+                    }
+
+                    // Bring the fine histogram of that bin up to date, either
+                    // incrementally or from scratch if it is too far behind
+                    uint32_t* fine = &kernelFine[coarse * FINE];
+                    if (x - lastColumn[coarse] >= diameter) {
+                        std::fill(fine, fine + FINE, 0u);
+                        for (int j = x - radius; j <= x + radius; ++j) {
+                            const uint16_t* column = &columnFine[(static_cast<size_t>(clampColumn(j)) * COARSE + coarse) * FINE];
+                            for (int bin = 0; bin < FINE; ++bin) {
+                                fine[bin] += column[bin];
+                            }
+                        }
+                    }
+                    else {
+                        for (int j = lastColumn[coarse] + 1; j <= x; ++j) {
+                            const uint16_t* added = &columnFine[(static_cast<size_t>(clampColumn(j + radius)) * COARSE + coarse) * FINE];
+                            const uint16_t* removed = &columnFine[(static_cast<size_t>(clampColumn(j - radius - 1)) * COARSE + coarse) * FINE];
+                            for (int bin = 0; bin < FINE; ++bin) {
+                                fine[bin] += added[bin] - removed[bin];
+                            }
+                        }
+                    }
+                    lastColumn[coarse] = x;
+
+                    // Find the median inside the coarse bin
+                    int bin = 0;
+                    while (count + fine[bin] <= rank) {
+                        count += fine[bin];
+                        bin++;
+                    }
+
+                    outputRow[x] = static_cast<T>((coarse << FINE_BITS) + bin);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Filter a single-channel image of level codes in parallel row bands
+     */
+    template <typename T, int FINE_BITS>
+    static void medianPlane(const cv::Mat& src, cv::Mat& dst, int radius) {
+        // Every band rebuilds its column histograms, so keep bands much
+        // taller than the kernel
+        const int diameter = 2 * radius + 1;
+        parallelForRowBands(src.rows, 2 * diameter, [&](int rowBegin, int rowEnd) {
+            medianBand<T, FINE_BITS>(src, dst, radius, rowBegin, rowEnd);
+        });
+    }
+
+    bool constantTimeMedianBlur(const cv::Mat& src, cv::Mat& dst, int kernelSize) {
+        if (src.empty()) {
+            std::cerr << "constantTimeMedianBlur: Source image is empty." << std::endl;
+            return false;
+        }
+
+        if (kernelSize < 3 || kernelSize % 2 == 0) {
+            std::cerr << "constantTimeMedianBlur: Kernel size must be odd and at least 3." << std::endl;
+            return false;
+        }
+
+        int depth = src.depth();
+        if (depth != CV_8U && depth != CV_16U && depth != CV_16S && depth != CV_32F && depth != CV_64F) {
+            std::cerr << "constantTimeMedianBlur: Unsupported image depth." << std::endl;
+            return false;
+        }
+
+        // Column counts are stored in 16 bits
+        if (kernelSize > 65535) {
+            std::cerr << "constantTimeMedianBlur: Kernel size is too large." << std::endl;
+            return false;
+        }
+
+        const int radius = kernelSize / 2;
+
+        std::vector<cv::Mat> planes;
+        cv::split(src, planes);
+
+        for (cv::Mat& plane : planes) {
+            if (depth == CV_8U) {
+                cv::Mat filtered(plane.rows, plane.cols, CV_8UC1);
+                medianPlane<uchar, 4>(plane, filtered, radius);
+                plane = filtered;
+                continue;
+            }
+
+            // Map the value range of the channel linearly onto the levels.
+            // Integer images whose range fits are only offset, so they stay exact.
+            double minValue = 0.0;
+            double maxValue = 0.0;
+            cv::minMaxLoc(plane, &minValue, &maxValue);
+
+            double scale = 1.0;
+            double range = maxValue - minValue;
+            bool integral = depth == CV_16U || depth == CV_16S;
+            if (!integral || range >= MEDIAN_WIDE_LEVELS) {
+                scale = range > 0.0 ? (MEDIAN_WIDE_LEVELS - 1) / range : 0.0;
+            }
+
+            cv::Mat codes;
+            plane.convertTo(codes, CV_16U, scale, -minValue * scale);
+
+            cv::Mat filtered(plane.rows, plane.cols, CV_16UC1);
+            medianPlane<ushort, 6>(codes, filtered, radius);
+
+            filtered.convertTo(plane, depth, scale > 0.0 ? 1.0 / scale : 0.0, minValue);
+        }
+
+        cv::merge(planes, dst);
+        return true;
+    }
+
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+namespace image_processor {
+
+    /**
+     * @brief Median filter whose per-pixel cost does not depend on the kernel size
+     *
+     * Implements the Perreault-Hebert algorithm: every image column keeps a
+     * histogram of the pixels in the vertical window, and the kernel histogram
+     * is slid along each row by adding one column histogram and removing
+     * another. Histograms are split into coarse and fine levels so that only
+     * one fine histogram has to be updated per pixel. The image is processed
+     * in parallel over row bands, and in column tiles to keep the histograms
+     * in cache. Borders are replicated, as in cv::medianBlur.
+     *
+     * 8-bit images are filtered exactly with 256 levels. Other depths are
+     * mapped linearly onto 4096 levels between the minimum and maximum of each
+     * channel, so the result is exact for integer images whose values span
+     * fewer than 4096 levels and otherwise within (max - min) / 8190 of the
+     * exact median.
+     *
+     * @param src Source image (8U, 16U, 16S, 32F or 64F, any number of channels)
+     * @param dst Destination image, allocated with the size and type of src
+     * @param kernelSize Aperture size (odd, at least 3)
+     * @return True if the image was filtered, false if the arguments are invalid
+     */
+    bool constantTimeMedianBlur(const cv::Mat& src, cv::Mat& dst, int kernelSize);
+
+}
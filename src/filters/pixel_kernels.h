@@ -0,0 +1,166 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <type_traits>
+
+namespace image_processor {
+
+    /**
+     * @brief Compile-time properties of a sample type
+     *
+     * maxValue is the value of full intensity: 255 for 8U, 65535 for 16U and
+     * 1 for 16F and 32F. Kernels work on values normalized by it, so one
+     * formula serves every depth. Half-float samples are computed in single
+     * precision and only stored in half precision.
+     */
+    template <typename T>
+    struct PixelTraits;
+
+    template <>
+    struct PixelTraits<uchar> {
+        static constexpr int depth = CV_8U;
+        static constexpr float maxValue = 255.0f;
+    };
+
+    template <>
+    struct PixelTraits<ushort> {
+        static constexpr int depth = CV_16U;
+        static constexpr float maxValue = 65535.0f;
+    };
+
+    template <>
+    struct PixelTraits<cv::float16_t> {
+        static constexpr int depth = CV_16F;
+        static constexpr float maxValue = 1.0f;
+    };
+
+    template <>
+    struct PixelTraits<float> {
+        static constexpr int depth = CV_32F;
+        static constexpr float maxValue = 1.0f;
+    };
+
+    /**
+     * @brief Tag carrying a sample type through a generic lambda
+     */
+    template <typename T>
+    struct DepthTag {
+        using type = T;
+    };
+
+    /**
+     * @brief Tag carrying a channel count through a generic lambda
+     */
+    template <int CN>
+    using ChannelTag = std::integral_constant<int, CN>;
+
+    /**
+     * @brief Full intensity value of an image depth
+     * @param depth CV_8U, CV_16U, CV_16F or CV_32F (any other depth returns 1)
+     * @return 255, 65535 or 1
+     */
+    inline double depthMaxValue(int depth) {
+        switch (depth) {
+        case CV_8U:
+            return 255.0;
+        case CV_16U:
+            return 65535.0;
+        default:
+            return 1.0;
+        }
+    }
+
+    /**
+     * @brief Check whether an image type has a specialized kernel
+     * @param type OpenCV matrix type
+     * @return True for 8U, 16U, 16F and 32F with 1, 3 or 4 channels
+     */
+    inline bool isKernelTypeSupported(int type) {
+        int depth = CV_MAT_DEPTH(type);
+        int channels = CV_MAT_CN(type);
+        return (depth == CV_8U || depth == CV_16U || depth == CV_16F || depth == CV_32F) &&
+            (channels == 1 || channels == 3 || channels == 4);
+    }
+
+    template <typename T, typename F>
+    inline bool dispatchChannels(int channels, F&& kernel) {
+        switch (channels) {
+        case 1:
+            kernel(DepthTag<T>(), ChannelTag<1>());
+            return true;
+        case 3:
+            kernel(DepthTag<T>(), ChannelTag<3>());
+            return true;
+        case 4:
+            kernel(DepthTag<T>(), ChannelTag<4>());
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    /**
+     * @brief Call a kernel specialized for the depth and channel count of an image type
+     *
+     * The kernel is a generic callable taking (DepthTag<T>, ChannelTag<CN>),
+     * so the switch on the type happens once per call and the kernel body is
+     * compiled separately for each of the twelve combinations:
+     *
+     * @code
+     * dispatchPixelType(image.type(), [&](auto depthTag, auto channelTag) {
+     *     using T = typename decltype(depthTag)::type;
+     *     constexpr int CN = decltype(channelTag)::value;
+     *     ...
+     * });
+     * @endcode
+     *
+     * @param type OpenCV matrix type (8U, 16U, 16F or 32F with 1, 3 or 4 channels)
+     * @param kernel The kernel to call
+     * @return True if the kernel was called, false if the type is not supported
+     */
+    template <typename F>
+    inline bool dispatchPixelType(int type, F&& kernel) {
+        switch (CV_MAT_DEPTH(type)) {
+        case CV_8U:
+            return dispatchChannels<uchar>(CV_MAT_CN(type), kernel);
+        case CV_16U:
+            return dispatchChannels<ushort>(CV_MAT_CN(type), kernel);
+        case CV_16F:
+            return dispatchChannels<cv::float16_t>(CV_MAT_CN(type), kernel);
+        case CV_32F:
+            return dispatchChannels<float>(CV_MAT_CN(type), kernel);
+        default:
+            return false;
+        }
+    }
+
+    /**
+     * @brief Single-precision copy of a half-float image
+     *
+     * Most OpenCV filters do not accept CV_16F. Nodes keep half-float images
+     * in half precision between nodes and widen them only while filtering.
+     *
+     * @param image Any image
+     * @return A CV_32F copy of a CV_16F image, otherwise the image itself
+     */
+    inline cv::Mat widenHalfFloat(const cv::Mat& image) {
+        if (image.depth() != CV_16F) {
+            return image;
+        }
+        cv::Mat widened;
+        image.convertTo(widened, CV_32F);
+        return widened;
+    }
+
+    /**
+     * @brief Store a filtered image back in half precision if its source was
+     * @param image Filtered image, converted in place from CV_32F to CV_16F if needed
+     * @param sourceDepth Depth of the image before widenHalfFloat
+     */
+    inline void narrowHalfFloat(cv::Mat& image, int sourceDepth) {
+        if (sourceDepth == CV_16F && !image.empty() && image.depth() == CV_32F) {
+            image.convertTo(image, CV_16F);
+        }
+    }
+
+}
@@ -0,0 +1,242 @@
+#include "pyramid.h"
+#include "pixel_kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace image_processor {
+
+    // Smallest sigma, in pixels of the coarse level, that is still blurred at that level
+    static const double PYRAMID_MIN_COARSE_SIGMA = 2.0;
+
+    static bool isValidLevel(const std::vector<cv::Mat>& pyramid, int level, const char* caller) {
+        if (pyramid.empty() || pyramid[0].empty()) {
+            std::cerr << caller << ": Pyramid is empty." << std::endl;
+            return false;
+        }
+        if (level < 0 || level >= static_cast<int>(pyramid.size())) {
+            std::cerr << caller << ": Level " << level << " is not in the pyramid." << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    static cv::Mat toFloat(const cv::Mat& image) {
+        if (image.depth() == CV_32F) {
+            return image;
+        }
+        cv::Mat converted;
+        image.convertTo(converted, CV_32F);
+        return converted;
+    }
+
+    int coarsePyramidLevel(double sigma, int maxLevel) {
+        for (int level = maxLevel; level > 0; --level) {
+            if (coarseSigma(sigma, level) >= PYRAMID_MIN_COARSE_SIGMA) {
+                return level;
+            }
+        }
+        return 0;
+    }
+
+    double coarseSigma(double sigma, int level) {
+        // The 5-tap kernel of pyrDown and pyrUp has a variance of one pixel of
+        // the finer level, so each step down and back up adds 4^k at level k
+        const double area = std::ldexp(1.0, 2 * level);
+        const double variance = (sigma * sigma - 2.0 * (area - 1.0) / 3.0) / area;
+        return variance > 0.0 ? std::sqrt(variance) : 0.0;
+    }
+
+    bool upsamplePyramidLevel(const std::vector<cv::Mat>& pyramid, int level, const cv::Mat& coarse, cv::Mat& dst) {
+        if (!isValidLevel(pyramid, level, "upsamplePyramidLevel")) {
+            return false;
+        }
+        if (coarse.size() != pyramid[level].size()) {
+            std::cerr << "upsamplePyramidLevel: Image does not have the size of level " << level << "." << std::endl;
+            return false;
+        }
+
+        cv::Mat image = coarse;
+        for (int finer = level - 1; finer >= 0; --finer) {
+            cv::Mat upsampled;
+            cv::pyrUp(image, upsampled, pyramid[finer].size());
+            image = upsampled;
+        }
+
+        dst = image;
+        return true;
+    }
+
+    bool pyramidGaussianBlur(const std::vector<cv::Mat>& pyramid, int level, double sigmaX, double sigmaY, cv::Mat& dst) {
+        if (!isValidLevel(pyramid, level, "pyramidGaussianBlur")) {
+            return false;
+        }
+        if (sigmaX <= 0.0) {
+            std::cerr << "pyramidGaussianBlur: Sigma must be positive." << std::endl;
+            return false;
+        }
+        if (sigmaY <= 0.0) {
+            sigmaY = sigmaX;
+        }
+
+        // Blur and upsample in single precision so 8-bit images are rounded only once
+        cv::Mat coarse = toFloat(pyramid[level]);
+        double coarseX = coarseSigma(sigmaX, level);
+        double coarseY = coarseSigma(sigmaY, level);
+        if (coarseX > 0.0 || coarseY > 0.0) {
+            cv::Mat blurred;
+            cv::GaussianBlur(coarse, blurred, cv::Size(0, 0), std::max(coarseX, 0.1), std::max(coarseY, 0.1));
+            coarse = blurred;
+        }
+
+        cv::Mat result;
+        if (!upsamplePyramidLevel(pyramid, level, coarse, result)) {
+            return false;
+        }
+
+        result.convertTo(dst, pyramid[0].depth());
+        return true;
+    }
+
+    double localMeanSigma(int blockSize, bool gaussian) {
+        if (gaussian) {
+            return 0.3 * ((blockSize - 1) * 0.5 - 1) + 0.8;
+        }
+        return std::sqrt((static_cast<double>(blockSize) * blockSize - 1.0) / 12.0);
+    }
+
+    bool pyramidAdaptiveThreshold(const std::vector<cv::Mat>& pyramid, int level, cv::Mat& dst,
+        double maxValue, int blockSize, bool gaussian, double C) {
+        if (!isValidLevel(pyramid, level, "pyramidAdaptiveThreshold")) {
+            return false;
+        }
+        if (pyramid[0].channels() != 1) {
+            std::cerr << "pyramidAdaptiveThreshold: Source must be a single-channel image." << std::endl;
+            return false;
+        }
+        if (blockSize < 3 || blockSize % 2 == 0) {
+            std::cerr << "pyramidAdaptiveThreshold: Block size must be odd and at least 3." << std::endl;
+            return false;
+        }
+
+        const double sigmaLeft = coarseSigma(localMeanSigma(blockSize, gaussian), level);
+
+        cv::Mat coarse = toFloat(pyramid[level]);
+        if (sigmaLeft > 0.0) {
+            cv::Mat blurred;
+            if (gaussian) {
+                cv::GaussianBlur(coarse, blurred, cv::Size(0, 0), sigmaLeft, sigmaLeft, cv::BORDER_REPLICATE);
+            }
+            else {
+                // Odd box with the remaining variance
+                int boxSize = 2 * static_cast<int>(std::lround((std::sqrt(12.0 * sigmaLeft * sigmaLeft + 1.0) - 1.0) / 2.0)) + 1;
+                cv::blur(coarse, blurred, cv::Size(boxSize, boxSize), cv::Point(-1, -1), cv::BORDER_REPLICATE);
+            }
+            coarse = blurred;
+        }
+
+        cv::Mat mean;
+        if (!upsamplePyramidLevel(pyramid, level, coarse, mean)) {
+            return false;
+        }
+
+        // src > mean - C is src - mean > -C
+        cv::Mat difference;
+        cv::subtract(toFloat(pyramid[0]), mean, difference);
+        cv::Mat result;
+        cv::threshold(difference, result, -C, maxValue, cv::THRESH_BINARY);
+
+        result.convertTo(dst, pyramid[0].depth());
+        return true;
+    }
+
+    // base + (blend - base) * weight, with a uniform weight when weight is empty
+    static cv::Mat mixBands(const cv::Mat& base, const cv::Mat& blend, const cv::Mat& weight, double alpha) {
+        cv::Mat mixed;
+        if (weight.empty()) {
+            cv::addWeighted(base, 1.0 - alpha, blend, alpha, 0.0, mixed);
+            return mixed;
+        }
+        cv::Mat difference;
+        cv::subtract(blend, base, difference);
+        cv::multiply(difference, weight, difference);
+        cv::add(base, difference, mixed);
+        return mixed;
+    }
+
+    bool multiBandBlend(const std::vector<cv::Mat>& basePyramid, const std::vector<cv::Mat>& blendPyramid,
+        const cv::Mat& mask, double alpha, int depth, cv::Mat& dst) {
+        if (!isValidLevel(basePyramid, 0, "multiBandBlend")) {
+            return false;
+        }
+
+        const int levels = static_cast<int>(basePyramid.size());
+        if (static_cast<int>(blendPyramid.size()) != levels) {
+            std::cerr << "multiBandBlend: Pyramids must have the same number of levels." << std::endl;
+            return false;
+        }
+        for (int level = 0; level < levels; ++level) {
+            if (basePyramid[level].size() != blendPyramid[level].size() ||
+                basePyramid[level].type() != blendPyramid[level].type()) {
+                std::cerr << "multiBandBlend: Pyramid levels must have the same size and type." << std::endl;
+                return false;
+            }
+        }
+        if (!mask.empty() && (mask.channels() != 1 || mask.size() != basePyramid[0].size())) {
+            std::cerr << "multiBandBlend: Mask must be a single-channel image of the size of the base image." << std::endl;
+            return false;
+        }
+
+        alpha = std::min(std::max(alpha, 0.0), 1.0);
+        const int channels = basePyramid[0].channels();
+
+        // Gaussian pyramid of the weights, one level per band
+        std::vector<cv::Mat> weights;
+        if (!mask.empty()) {
+            cv::Mat weight;
+            mask.convertTo(weight, CV_32F, alpha / depthMaxValue(mask.depth()));
+            cv::buildPyramid(weight, weights, levels - 1);
+            if (channels > 1) {
+                for (cv::Mat& level : weights) {
+                    cv::Mat expanded;
+                    cv::merge(std::vector<cv::Mat>(channels, level), expanded);
+                    level = expanded;
+                }
+            }
+        }
+        auto bandWeight = [&](int level) {
+            return weights.empty() ? cv::Mat() : weights[level];
+        };
+
+        // The coarsest band is the coarsest Gaussian level itself
+        cv::Mat coarserBase = toFloat(basePyramid[levels - 1]);
+        cv::Mat coarserBlend = toFloat(blendPyramid[levels - 1]);
+        cv::Mat result = mixBands(coarserBase, coarserBlend, bandWeight(levels - 1), alpha);
+
+        // Mix each Laplacian band and add it to the upsampled result so far
+        for (int level = levels - 2; level >= 0; --level) {
+            const cv::Size size = basePyramid[level].size();
+            cv::Mat levelBase = toFloat(basePyramid[level]);
+            cv::Mat levelBlend = toFloat(blendPyramid[level]);
+
+            cv::Mat upsampled;
+            cv::Mat baseBand;
+            cv::Mat blendBand;
+            cv::pyrUp(coarserBase, upsampled, size);
+            cv::subtract(levelBase, upsampled, baseBand);
+            cv::pyrUp(coarserBlend, upsampled, size);
+            cv::subtract(levelBlend, upsampled, blendBand);
+
+            cv::Mat band = mixBands(baseBand, blendBand, bandWeight(level), alpha);
+            cv::pyrUp(result, upsampled, size);
+            cv::add(upsampled, band, result);
+
+            coarserBase = levelBase;
+            coarserBlend = levelBlend;
+        }
+
+        result.convertTo(dst, CV_MAKETYPE(depth, channels));
+        return true;
+    }
+
+}
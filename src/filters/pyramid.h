@@ -0,0 +1,112 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+namespace image_processor {
+
+    /**
+     * Large-radius filters evaluated on a coarse level of a Gaussian pyramid
+     * and upsampled back to full resolution. The pyramids are lists of
+     * images where level 0 is the source and each level is cv::pyrDown of
+     * the previous one, as BaseNode::getOutputPyramid caches them.
+     *
+     * Going down and back up the pyramid blurs the image by itself, so the
+     * filter at the coarse level only adds the rest of the requested blur.
+     * A level is used only while that rest is still wide enough to be
+     * sampled well, which keeps the result close to the full-resolution one
+     * at a small fraction of its cost.
+     */
+
+    /**
+     * @brief Coarsest pyramid level at which a Gaussian of the given sigma can run
+     * @param sigma Standard deviation of the blur at full resolution
+     * @param maxLevel Coarsest level allowed
+     * @return The level, or 0 if the blur should run at full resolution
+     */
+    int coarsePyramidLevel(double sigma, int maxLevel);
+
+    /**
+     * @brief Sigma left to apply at a pyramid level
+     *
+     * Subtracts the blur of the pyrDown steps to the level and of the pyrUp
+     * steps back, and converts the rest to pixels of the level.
+     *
+     * @param sigma Standard deviation of the blur at full resolution
+     * @param level Pyramid level
+     * @return The sigma in pixels of the level, or 0 if the pyramid alone blurs more
+     */
+    double coarseSigma(double sigma, int level);
+
+    /**
+     * @brief Upsample an image of a pyramid level back to the size of level 0
+     * @param pyramid Pyramid whose level sizes are followed
+     * @param level Level of the image
+     * @param coarse Image with the size of that level
+     * @param dst Destination image, with the size of level 0 and the type of coarse
+     * @return True if the image was upsampled, false if the arguments are invalid
+     */
+    bool upsamplePyramidLevel(const std::vector<cv::Mat>& pyramid, int level, const cv::Mat& coarse, cv::Mat& dst);
+
+    /**
+     * @brief Gaussian blur computed at a coarse pyramid level
+     * @param pyramid Pyramid of the source image
+     * @param level Level to blur at (from coarsePyramidLevel)
+     * @param sigmaX Horizontal sigma at full resolution
+     * @param sigmaY Vertical sigma at full resolution
+     * @param dst Destination image, with the size and type of level 0
+     * @return True if the image was blurred, false if the arguments are invalid
+     */
+    bool pyramidGaussianBlur(const std::vector<cv::Mat>& pyramid, int level, double sigmaX, double sigmaY, cv::Mat& dst);
+
+    /**
+     * @brief Standard deviation of the block weights of an adaptive threshold
+     * @param blockSize Size of the block
+     * @param gaussian True for the Gaussian weights cv::getGaussianKernel derives
+     *        from the size, false for a box
+     * @return The standard deviation in pixels
+     */
+    double localMeanSigma(int blockSize, bool gaussian);
+
+    /**
+     * @brief Adaptive threshold against a local mean computed at a coarse pyramid level
+     *
+     * Matches cv::adaptiveThreshold with THRESH_BINARY: a pixel is set to
+     * maxValue where it is above its local mean minus C. The box mean
+     * (gaussian false) is approximated by a box of the same variance at the
+     * coarse level.
+     *
+     * @param pyramid Pyramid of the single-channel source image
+     * @param level Level to compute the mean at (from coarsePyramidLevel with localMeanSigma)
+     * @param dst Destination image, with the size and type of level 0
+     * @param maxValue Value of pixels above their threshold; other pixels are 0
+     * @param blockSize Size of the block at full resolution (odd, at least 3)
+     * @param gaussian True for a Gaussian-weighted mean, false for a box mean
+     * @param C Constant subtracted from the mean
+     * @return True if the image was thresholded, false if the arguments are invalid
+     */
+    bool pyramidAdaptiveThreshold(const std::vector<cv::Mat>& pyramid, int level, cv::Mat& dst,
+        double maxValue, int blockSize, bool gaussian, double C);
+
+    /**
+     * @brief Multi-band (Laplacian pyramid) blend of two images
+     *
+     * Each band of the Laplacian pyramids is mixed with the mask blurred to
+     * the scale of the band, so seams along mask edges are wide for coarse
+     * structure and narrow for fine detail (Burt and Adelson). The pyramid
+     * is collapsed band by band, so only a few full-resolution buffers are
+     * alive at a time.
+     *
+     * @param basePyramid Gaussian pyramid of the base image
+     * @param blendPyramid Gaussian pyramid of the blend image, with the same level sizes and types
+     * @param mask Weight of the blend image per pixel (single channel, the size of level 0,
+     *        full intensity meaning fully the blend image), or empty for a uniform weight
+     * @param alpha Strength of the blend image (0 to 1), multiplied with the mask
+     * @param depth Depth of the destination image
+     * @param dst Destination image, with the size and channels of level 0
+     * @return True if the images were blended, false if the arguments are invalid
+     */
+    bool multiBandBlend(const std::vector<cv::Mat>& basePyramid, const std::vector<cv::Mat>& blendPyramid,
+        const cv::Mat& mask, double alpha, int depth, cv::Mat& dst);
+
+}
@@ -0,0 +1,194 @@
+#include "recursive_gaussian.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+namespace image_processor {
+
+    // Number of adjacent floats filtered together in the vertical pass
+    static const int RECURSIVE_STRIP_WIDTH = 256;
+
+    // Smallest sigma supported by the Young-van Vliet coefficients
+    static const double RECURSIVE_MIN_SIGMA = 0.5;
+
+    /**
+     * @brief Coefficients of the recursion y[n] = B x[n] + a1 y[n-1] + a2 y[n-2] + a3 y[n-3]
+     *
+     * The same recursion is run backwards for the anti-causal pass. boundary
+     * maps the causal state at the end of a line, relative to the replicated
+     * last sample, onto the three anti-causal values following the line.
+     */
+    struct RecursiveCoefficients {
+        float B = 1.0f;
+        float a1 = 0.0f;
+        float a2 = 0.0f;
+        float a3 = 0.0f;
+        double boundary[3][3] = {};
+    };
+
+    static RecursiveCoefficients computeCoefficients(double sigma) {
+        // Young and van Vliet, "Recursive implementation of the Gaussian filter" (1995)
+        double q = sigma >= 2.5
+            ? 0.98711 * sigma - 0.96330
+            : 3.97156 - 4.14554 * std::sqrt(1.0 - 0.26891 * sigma);
+
+        double b0 = 1.57825 + 2.44413 * q + 1.4281 * q * q + 0.422205 * q * q * q;
+        double b1 = 2.44413 * q + 2.85619 * q * q + 1.26661 * q * q * q;
+        double b2 = -(1.4281 * q * q + 1.26661 * q * q * q);
+        double b3 = 0.422205 * q * q * q;
+
+        double a1 = b1 / b0;
+        double a2 = b2 / b0;
+        double a3 = b3 / b0;
+        double B = 1.0 - (a1 + a2 + a3);
+
+        RecursiveCoefficients coefficients;
+        coefficients.B = static_cast<float>(B);
+        coefficients.a1 = static_cast<float>(a1);
+        coefficients.a2 = static_cast<float>(a2);
+        coefficients.a3 = static_cast<float>(a3);
+
+        // Boundary matrix (Triggs and Sdika): the response of both passes to
+        // each unit causal end state, with the input held at the last sample.
+        // The system is linear, so simulating the three unit states until
+        // they have decayed gives the matrix exactly.
+        int length = static_cast<int>(std::ceil(30.0 * q)) + 64;
+        std::vector<double> causal(length + 3);
+        std::vector<double> anticausal(length + 3);
+        for (int state = 0; state < 3; ++state) {
+            // causal[0..2] hold w[N-3], w[N-2], w[N-1] relative to the last sample
+            std::fill(causal.begin(), causal.end(), 0.0);
+            causal[2 - state] = 1.0;
+            for (int n = 3; n < length + 3; ++n) {
+                causal[n] = a1 * causal[n - 1] + a2 * causal[n - 2] + a3 * causal[n - 3];
+            }
+
+            std::fill(anticausal.begin(), anticausal.end(), 0.0);
+            for (int n = length - 1; n >= 3; --n) {
+                anticausal[n] = B * causal[n] + a1 * anticausal[n + 1] + a2 * anticausal[n + 2] + a3 * anticausal[n + 3];
+            }
+
+            // anticausal[3..5] are y[N], y[N+1], y[N+2]
+            for (int k = 0; k < 3; ++k) {
+                coefficients.boundary[k][state] = anticausal[3 + k];
+            }
+        }
+
+        return coefficients;
+    }
+
+    /**
+     * @brief Filter a set of lines in place, both directions
+     *
+     * Sample n of lane l is at data[n * sampleStep + l]; the lanes are
+     * contiguous so the inner loops vectorize.
+     */
+    static void filterLines(float* data, std::ptrdiff_t sampleStep, int length, int lanes,
+        const RecursiveCoefficients& c, std::vector<float>& buffer) {
+        buffer.resize(static_cast<size_t>(lanes) * 5);
+        float* first = buffer.data();          // Replicated first sample
+        float* last = first + lanes;           // Original last sample
+        float* y1 = last + lanes;              // Anti-causal values after the line: y[N]
+        float* y2 = y1 + lanes;                // y[N+1]
+        float* y3 = y2 + lanes;                // y[N+2]
+
+        std::copy(data, data + lanes, first);
+        std::copy(data + (length - 1) * sampleStep, data + (length - 1) * sampleStep + lanes, last);
+
+        // Causal pass; the line is extended to the left with its first sample
+        for (int n = 0; n < length; ++n) {
+            float* row = data + n * sampleStep;
+            const float* p1 = n >= 1 ? row - sampleStep : first;
+            const float* p2 = n >= 2 ? row - 2 * sampleStep : first;
+            const float* p3 = n >= 3 ? row - 3 * sampleStep : first;
+            for (int l = 0; l < lanes; ++l) {
+                row[l] = c.B * row[l] + c.a1 * p1[l] + c.a2 * p2[l] + c.a3 * p3[l];
+            }
+        }
+
+        // Anti-causal start values from the causal end state
+        float start[3];
+        for (int l = 0; l < lanes; ++l) {
+            double u = last[l];
+            double w1 = data[(length - 1) * sampleStep + l] - u;
+            double w2 = (length >= 2 ? data[(length - 2) * sampleStep + l] : first[l]) - u;
+            double w3 = (length >= 3 ? data[(length - 3) * sampleStep + l] : first[l]) - u;
+            for (int k = 0; k < 3; ++k) {
+                start[k] = static_cast<float>(u + c.boundary[k][0] * w1 + c.boundary[k][1] * w2 + c.boundary[k][2] * w3);
+            }
+            y1[l] = start[0];
+            y2[l] = start[1];
+            y3[l] = start[2];
+        }
+
+        // Anti-causal pass
+        for (int n = length - 1; n >= 0; --n) {
+            float* row = data + n * sampleStep;
+            const float* n1 = n + 1 < length ? row + sampleStep : y1;
+            const float* n2 = n + 2 < length ? row + 2 * sampleStep : (n + 2 == length ? y1 : y2);
+            const float* n3 = n + 3 < length ? row + 3 * sampleStep : (n + 3 == length ? y1 : (n + 3 == length + 1 ? y2 : y3));
+            for (int l = 0; l < lanes; ++l) {
+                row[l] = c.B * row[l] + c.a1 * n1[l] + c.a2 * n2[l] + c.a3 * n3[l];
+            }
+        }
+    }
+
+    bool recursiveGaussianBlur(const cv::Mat& src, cv::Mat& dst, double sigmaX, double sigmaY) {
+        if (src.empty()) {
+            std::cerr << "recursiveGaussianBlur: Source image is empty." << std::endl;
+            return false;
+        }
+
+        if (sigmaY <= 0.0) {
+            sigmaY = sigmaX;
+        }
+
+        if (sigmaX <= 0.0) {
+            std::cerr << "recursiveGaussianBlur: Sigma must be positive." << std::endl;
+            return false;
+        }
+
+        if (sigmaX < RECURSIVE_MIN_SIGMA || sigmaY < RECURSIVE_MIN_SIGMA) {
+            cv::GaussianBlur(src, dst, cv::Size(0, 0), sigmaX, sigmaY, cv::BORDER_REPLICATE);
+            return true;
+        }
+
+        const RecursiveCoefficients horizontal = computeCoefficients(sigmaX);
+        const RecursiveCoefficients vertical = computeCoefficients(sigmaY);
+
+        cv::Mat image;
+        src.convertTo(image, CV_32F);
+        if (image.data == src.data) {
+            image = image.clone();
+        }
+
+        const int channels = image.channels();
+        const int rowLength = image.cols * channels;
+        const std::ptrdiff_t rowStep = static_cast<std::ptrdiff_t>(image.step / sizeof(float));
+
+        // Horizontal pass: each row is one line whose samples are pixels
+        cv::parallel_for_(cv::Range(0, image.rows), [&](const cv::Range& range) {
+            std::vector<float> buffer;
+            for (int y = range.start; y < range.end; ++y) {
+                filterLines(image.ptr<float>(y), channels, image.cols, channels, horizontal, buffer);
+            }
+        });
+
+        // Vertical pass over strips of adjacent columns
+        const int stripCount = (rowLength + RECURSIVE_STRIP_WIDTH - 1) / RECURSIVE_STRIP_WIDTH;
+        cv::parallel_for_(cv::Range(0, stripCount), [&](const cv::Range& range) {
+            std::vector<float> buffer;
+            for (int strip = range.start; strip < range.end; ++strip) {
+                int begin = strip * RECURSIVE_STRIP_WIDTH;
+                int lanes = std::min(RECURSIVE_STRIP_WIDTH, rowLength - begin);
+                filterLines(image.ptr<float>(0) + begin, rowStep, image.rows, lanes, vertical, buffer);
+            }
+        });
+
+        image.convertTo(dst, src.type());
+        return true;
+    }
+
+}
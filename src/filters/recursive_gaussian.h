@@ -0,0 +1,32 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+namespace image_processor {
+
+    /**
+     * @brief Gaussian blur with a per-pixel cost independent of sigma
+     *
+     * Uses the third-order recursive (IIR) approximation of Young and
+     * van Vliet, run forwards and backwards along every row and then every
+     * column, with the boundary initialization of Triggs and Sdika so that
+     * borders behave like BORDER_REPLICATE. Rows are filtered in parallel;
+     * columns are filtered in parallel strips of adjacent columns, so the inner
+     * loop runs over contiguous memory and vectorizes.
+     *
+     * The result is an approximation. On images with sharp steps the RMS
+     * difference to cv::GaussianBlur is about 1% of the step height. The
+     * largest difference near a step is about 5% for sigma below 2 and 2%
+     * above, and the difference shrinks further for very large sigma. For
+     * sigma below 0.5 the recursion is not defined and cv::GaussianBlur is
+     * used instead.
+     *
+     * @param src Source image (any depth, any number of channels)
+     * @param dst Destination image, allocated with the size and type of src
+     * @param sigmaX Standard deviation in the horizontal direction
+     * @param sigmaY Standard deviation in the vertical direction (0 uses sigmaX)
+     * @return True if the image was filtered, false if the arguments are invalid
+     */
+    bool recursiveGaussianBlur(const cv::Mat& src, cv::Mat& dst, double sigmaX, double sigmaY = 0.0);
+
+}
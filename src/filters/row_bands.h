@@ -0,0 +1,52 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <cstdint>
+
+namespace image_processor {
+
+    // Default minimum height of a row band for kernels whose per-band setup
+    // cost does not depend on a kernel size
+    static const int DEFAULT_MIN_BAND_ROWS = 16;
+
+    /**
+     * @brief Number of row bands to split an image into
+     *
+     * One band per OpenCV thread, but never bands shorter than minBandRows,
+     * so that per-band setup stays small against the work of the band.
+     */
+    inline int rowBandCount(int rows, int minBandRows) {
+        return std::min(std::max(cv::getNumThreads(), 1), std::max(1, rows / std::max(minBandRows, 1)));
+    }
+
+    /**
+     * @brief First row of a band; band == bandCount gives the row count
+     */
+    inline int rowBandStart(int rows, int band, int bandCount) {
+        return static_cast<int>(static_cast<int64_t>(rows) * band / bandCount);
+    }
+
+    /**
+     * @brief Run fn(band, rowBegin, rowEnd) for bandCount equal row bands in parallel
+     */
+    template <typename Fn>
+    void parallelForBands(int rows, int bandCount, Fn&& fn) {
+        cv::parallel_for_(cv::Range(0, bandCount), [&](const cv::Range& range) {
+            for (int band = range.start; band < range.end; ++band) {
+                fn(band, rowBandStart(rows, band, bandCount), rowBandStart(rows, band + 1, bandCount));
+            }
+        });
+    }
+
+    /**
+     * @brief Run fn(rowBegin, rowEnd) over row bands of at least minBandRows rows in parallel
+     */
+    template <typename Fn>
+    void parallelForRowBands(int rows, int minBandRows, Fn&& fn) {
+        parallelForBands(rows, rowBandCount(rows, minBandRows), [&](int, int rowBegin, int rowEnd) {
+            fn(rowBegin, rowEnd);
+        });
+    }
+
+}
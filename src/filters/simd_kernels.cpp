@@ -0,0 +1,712 @@
+#include "simd_kernels.h"
+#include "cpu_dispatch.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+// GCC and clang fuse a separate multiply and add into one FMA when the
+// target has it (AVX-512 implies FMA), which rounds once instead of twice.
+// Every variant must round like the scalar code, whose loops are also
+// inlined into the vector functions as their tails, so contraction is
+// disabled in this file.
+#if defined(__clang__)
+#pragma clang fp contract(off)
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+#ifdef IMAGE_PROCESSOR_X86
+#include <immintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define TARGET_SSE42 __attribute__((target("sse4.2")))
+#define TARGET_AVX2 __attribute__((target("avx2,f16c")))
+#define TARGET_AVX512 __attribute__((target("avx512f,avx512bw,f16c")))
+#else
+#define TARGET_SSE42
+#define TARGET_AVX2
+#define TARGET_AVX512
+#endif
+#endif
+
+namespace image_processor {
+
+    // Value of full intensity of 8-bit samples, as in PixelTraits<uchar>
+    static const float BLEND_MAX_8U = 255.0f;
+
+    // Entries of a 16-bit lookup table
+    static const int LOOKUP_TABLE_SIZE_16U = 65536;
+
+    // Largest channel count the channel split transposes in vector registers
+    static const int SPLIT_MAX_TRANSPOSED_CHANNELS = 16;
+
+    /**
+     * @brief Entry points of one instruction set level
+     */
+    struct KernelTable {
+        void (*blendNormal8u)(const uchar*, const uchar*, uchar*, int, float);
+        void (*lookup16u)(const ushort*, const ushort*, ushort*, int);
+        void (*convert8u)(const double*, uchar*, int, double);
+        void (*convert16u)(const double*, ushort*, int, double);
+        void (*convert32f)(const double*, float*, int, double);
+        void (*convert16f)(const double*, cv::float16_t*, int, double);
+        void (*splitChannels)(const uchar*, int, int, uchar* const*, int);
+    };
+
+    // Scalar reference versions
+
+    static void blendNormalRow8uScalar(const uchar* base, const uchar* blend, uchar* dst, int count, float alpha) {
+        const float scale = 1.0f / BLEND_MAX_8U;
+        for (int i = 0; i < count; ++i) {
+            float a = base[i] * scale;
+            float b = blend[i] * scale;
+            dst[i] = cv::saturate_cast<uchar>((a + (b - a) * alpha) * BLEND_MAX_8U);
+        }
+    }
+
+    static void lookupRow16uScalar(const ushort* src, const ushort* table, ushort* dst, int count) {
+        for (int i = 0; i < count; ++i) {
+            dst[i] = table[src[i]];
+        }
+    }
+
+    template <typename T>
+    static void convertScaledRowScalar(const double* src, T* dst, int count, double scale) {
+        for (int i = 0; i < count; ++i) {
+            dst[i] = cv::saturate_cast<T>(src[i] * scale);
+        }
+    }
+
+    template <typename T>
+    static void splitChannelsRange(const uchar* src, int channels, uchar* const* dst, int first, int count) {
+        const T* pixels = reinterpret_cast<const T*>(src);
+        for (int i = first; i < count; ++i) {
+            for (int c = 0; c < channels; ++c) {
+                T* out = reinterpret_cast<T*>(dst[c]) + 3 * i;
+                out[0] = out[1] = out[2] = 0;
+                out[channels == 3 ? c : 0] = pixels[i * channels + c];
+            }
+        }
+    }
+
+    // Splits pixels first to count - 1, which finishes the rows of the vector versions
+    static void splitChannelsRange(const uchar* src, int channels, int elemSize, uchar* const* dst, int first, int count) {
+        switch (elemSize) {
+        case 1:
+            splitChannelsRange<uint8_t>(src, channels, dst, first, count);
+            break;
+        case 2:
+            splitChannelsRange<uint16_t>(src, channels, dst, first, count);
+            break;
+        case 4:
+            splitChannelsRange<uint32_t>(src, channels, dst, first, count);
+            break;
+        default:
+            splitChannelsRange<uint64_t>(src, channels, dst, first, count);
+            break;
+        }
+    }
+
+    static void splitChannelsRowScalar(const uchar* src, int channels, int elemSize, uchar* const* dst, int count) {
+        splitChannelsRange(src, channels, elemSize, dst, 0, count);
+    }
+
+#ifdef IMAGE_PROCESSOR_X86
+    static inline int loadInt32(const uchar* p) {
+        int value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    // SSE4.2 versions
+
+    TARGET_SSE42 static inline __m128i blendNormal4Sse42(const uchar* base, const uchar* blend,
+        __m128 scale, __m128 weight, __m128 maxValue) {
+        __m128 a = _mm_mul_ps(_mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(loadInt32(base)))), scale);
+        __m128 b = _mm_mul_ps(_mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(loadInt32(blend)))), scale);
+        __m128 result = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), weight));
+        return _mm_cvtps_epi32(_mm_mul_ps(result, maxValue));
+    }
+
+    TARGET_SSE42 static void blendNormalRow8uSse42(const uchar* base, const uchar* blend, uchar* dst, int count, float alpha) {
+        const __m128 scale = _mm_set1_ps(1.0f / BLEND_MAX_8U);
+        const __m128 weight = _mm_set1_ps(alpha);
+        const __m128 maxValue = _mm_set1_ps(BLEND_MAX_8U);
+        int i = 0;
+        for (; i + 16 <= count; i += 16) {
+            __m128i q0 = blendNormal4Sse42(base + i, blend + i, scale, weight, maxValue);
+            __m128i q1 = blendNormal4Sse42(base + i + 4, blend + i + 4, scale, weight, maxValue);
+            __m128i q2 = blendNormal4Sse42(base + i + 8, blend + i + 8, scale, weight, maxValue);
+            __m128i q3 = blendNormal4Sse42(base + i + 12, blend + i + 12, scale, weight, maxValue);
+            __m128i packed = _mm_packus_epi16(_mm_packs_epi32(q0, q1), _mm_packs_epi32(q2, q3));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), packed);
+        }
+        blendNormalRow8uScalar(base + i, blend + i, dst + i, count - i, alpha);
+    }
+
+    TARGET_SSE42 static inline __m128i convert4Sse42(const double* src, __m128d scale) {
+        __m128i low = _mm_cvtpd_epi32(_mm_mul_pd(_mm_loadu_pd(src), scale));
+        __m128i high = _mm_cvtpd_epi32(_mm_mul_pd(_mm_loadu_pd(src + 2), scale));
+        return _mm_unpacklo_epi64(low, high);
+    }
+
+    TARGET_SSE42 static void convertScaledRow8uSse42(const double* src, uchar* dst, int count, double scale) {
+        const __m128d factor = _mm_set1_pd(scale);
+        int i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m128i words = _mm_packs_epi32(convert4Sse42(src + i, factor), convert4Sse42(src + i + 4, factor));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(words, words));
+        }
+        convertScaledRowScalar(src + i, dst + i, count - i, scale);
+    }
+
+    TARGET_SSE42 static void convertScaledRow16uSse42(const double* src, ushort* dst, int count, double scale) {
+        const __m128d factor = _mm_set1_pd(scale);
+        int i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m128i words = _mm_packus_epi32(convert4Sse42(src + i, factor), convert4Sse42(src + i + 4, factor));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), words);
+        }
+        convertScaledRowScalar(src + i, dst + i, count - i, scale);
+    }
+
+    TARGET_SSE42 static void convertScaledRow32fSse42(const double* src, float* dst, int count, double scale) {
+        const __m128d factor = _mm_set1_pd(scale);
+        int i = 0;
+        for (; i + 4 <= count; i += 4) {
+            __m128 low = _mm_cvtpd_ps(_mm_mul_pd(_mm_loadu_pd(src + i), factor));
+            __m128 high = _mm_cvtpd_ps(_mm_mul_pd(_mm_loadu_pd(src + i + 2), factor));
+            _mm_storeu_ps(dst + i, _mm_movelh_ps(low, high));
+        }
+        convertScaledRowScalar(src + i, dst + i, count - i, scale);
+    }
+
+    TARGET_SSE42 static inline __m128i unpackLowSse42(__m128i a, __m128i b, int elemSize) {
+        switch (elemSize) {
+        case 1:
+            return _mm_unpacklo_epi8(a, b);
+        case 2:
+            return _mm_unpacklo_epi16(a, b);
+        case 4:
+            return _mm_unpacklo_epi32(a, b);
+        default:
+            return _mm_unpacklo_epi64(a, b);
+        }
+    }
+
+    TARGET_SSE42 static inline __m128i unpackHighSse42(__m128i a, __m128i b, int elemSize) {
+        switch (elemSize) {
+        case 1:
+            return _mm_unpackhi_epi8(a, b);
+        case 2:
+            return _mm_unpackhi_epi16(a, b);
+        case 4:
+            return _mm_unpackhi_epi32(a, b);
+        default:
+            return _mm_unpackhi_epi64(a, b);
+        }
+    }
+
+    TARGET_SSE42 static void splitChannelsRowSse42(const uchar* src, int channels, int elemSize, uchar* const* dst, int count) {
+        const int pixelBytes = 3 * elemSize;
+        int i = 0;
+
+        if (channels == 3) {
+            // Pixels line up with every 48 bytes, so three masks per channel keep its element of each pixel
+            __m128i masks[3][3];
+            for (int c = 0; c < 3; ++c) {
+                for (int v = 0; v < 3; ++v) {
+                    alignas(16) uchar bytes[16];
+                    for (int j = 0; j < 16; ++j) {
+                        bytes[j] = (16 * v + j) / elemSize % 3 == c ? 0xFF : 0;
+                    }
+                    masks[c][v] = _mm_load_si128(reinterpret_cast<const __m128i*>(bytes));
+                }
+            }
+
+            const int rowBytes = count * pixelBytes;
+            int offset = 0;
+            for (; offset + 48 <= rowBytes; offset += 48) {
+                for (int v = 0; v < 3; ++v) {
+                    __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + offset + 16 * v));
+                    for (int c = 0; c < 3; ++c) {
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst[c] + offset + 16 * v), _mm_and_si128(pixels, masks[c][v]));
+                    }
+                }
+            }
+            i = offset / pixelBytes;
+        }
+        else if ((channels & (channels - 1)) == 0 && channels <= SPLIT_MAX_TRANSPOSED_CHANNELS) {
+            // A block holds one vector of every channel; a round of unpacking
+            // rotates the index bits of every value by one, so log2(blockPixels)
+            // rounds move the pixel bits below the channel bits
+            const int blockPixels = 16 / elemSize;
+            int rounds = 0;
+            for (int n = blockPixels; channels > 1 && n > 1; n >>= 1) {
+                ++rounds;
+            }
+
+            // Spread the values of one vector over three, each followed by two zero elements
+            __m128i expand[3];
+            for (int v = 0; v < 3; ++v) {
+                alignas(16) uchar bytes[16];
+                for (int j = 0; j < 16; ++j) {
+                    const int position = 16 * v + j;
+                    const int element = position % pixelBytes;
+                    bytes[j] = element < elemSize ? static_cast<uchar>(position / pixelBytes * elemSize + element) : 0x80;
+                }
+                expand[v] = _mm_load_si128(reinterpret_cast<const __m128i*>(bytes));
+            }
+
+            const int half = channels / 2;
+            for (; i + blockPixels <= count; i += blockPixels) {
+                const uchar* block = src + static_cast<size_t>(i) * channels * elemSize;
+                __m128i values[SPLIT_MAX_TRANSPOSED_CHANNELS];
+                __m128i unpacked[SPLIT_MAX_TRANSPOSED_CHANNELS];
+                for (int n = 0; n < channels; ++n) {
+                    values[n] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * n));
+                }
+                for (int round = 0; round < rounds; ++round) {
+                    for (int n = 0; n < half; ++n) {
+                        unpacked[2 * n] = unpackLowSse42(values[n], values[n + half], elemSize);
+                        unpacked[2 * n + 1] = unpackHighSse42(values[n], values[n + half], elemSize);
+                    }
+                    std::copy(unpacked, unpacked + channels, values);
+                }
+                for (int c = 0; c < channels; ++c) {
+                    uchar* out = dst[c] + static_cast<size_t>(i) * pixelBytes;
+                    for (int v = 0; v < 3; ++v) {
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16 * v), _mm_shuffle_epi8(values[c], expand[v]));
+                    }
+                }
+            }
+        }
+
+        splitChannelsRange(src, channels, elemSize, dst, i, count);
+    }
+
+    // AVX2 versions
+
+    TARGET_AVX2 static inline __m256i blendNormal8Avx2(const uchar* base, const uchar* blend,
+        __m256 scale, __m256 weight, __m256 maxValue) {
+        __m256 a = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(
+            _mm_loadl_epi64(reinterpret_cast<const __m128i*>(base)))), scale);
+        __m256 b = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(
+            _mm_loadl_epi64(reinterpret_cast<const __m128i*>(blend)))), scale);
+        __m256 result = _mm256_add_ps(a, _mm256_mul_ps(_mm256_sub_ps(b, a), weight));
+        return _mm256_cvtps_epi32(_mm256_mul_ps(result, maxValue));
+    }
+
+    TARGET_AVX2 static void blendNormalRow8uAvx2(const uchar* base, const uchar* blend, uchar* dst, int count, float alpha) {
+        const __m256 scale = _mm256_set1_ps(1.0f / BLEND_MAX_8U);
+        const __m256 weight = _mm256_set1_ps(alpha);
+        const __m256 maxValue = _mm256_set1_ps(BLEND_MAX_8U);
+        int i = 0;
+        for (; i + 16 <= count; i += 16) {
+            __m256i low = blendNormal8Avx2(base + i, blend + i, scale, weight, maxValue);
+            __m256i high = blendNormal8Avx2(base + i + 8, blend + i + 8, scale, weight, maxValue);
+            // packs works within 128-bit lanes; restore the sample order before the final pack
+            __m256i words = _mm256_permute4x64_epi64(_mm256_packs_epi32(low, high), 0xD8);
+            __m128i packed = _mm_packus_epi16(_mm256_castsi256_si128(words), _mm256_extracti128_si256(words, 1));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), packed);
+        }
+        blendNormalRow8uScalar(base + i, blend + i, dst + i, count - i, alpha);
+    }
+
+    TARGET_AVX2 static void lookupRow16uAvx2(const ushort* src, const ushort* table, ushort* dst, int count) {
+        // A 32-bit gather of the last entry would read past the table, so that lane keeps a preset value
+        const __m256i lastIndex = _mm256_set1_epi32(LOOKUP_TABLE_SIZE_16U - 1);
+        const __m256i lastEntry = _mm256_set1_epi32(table[LOOKUP_TABLE_SIZE_16U - 1]);
+        const __m256i allOnes = _mm256_set1_epi32(-1);
+        const __m256i lowHalf = _mm256_set1_epi32(0xFFFF);
+        const int* base = reinterpret_cast<const int*>(table);
+        int i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m256i index = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+            __m256i mask = _mm256_xor_si256(_mm256_cmpeq_epi32(index, lastIndex), allOnes);
+            __m256i values = _mm256_and_si256(_mm256_mask_i32gather_epi32(lastEntry, base, index, mask, 2), lowHalf);
+            __m256i words = _mm256_permute4x64_epi64(_mm256_packus_epi32(values, values), 0x08);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm256_castsi256_si128(words));
+        }
+        lookupRow16uScalar(src + i, table, dst + i, count - i);
+    }
+
+    TARGET_AVX2 static void convertScaledRow8uAvx2(const double* src, uchar* dst, int count, double scale) {
+        const __m256d factor = _mm256_set1_pd(scale);
+        int i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m128i low = _mm256_cvtpd_epi32(_mm256_mul_pd(_mm256_loadu_pd(src + i), factor));
+            __m128i high = _mm256_cvtpd_epi32(_mm256_mul_pd(_mm256_loadu_pd(src + i + 4), factor));
+            __m128i words = _mm_packs_epi32(low, high);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(words, words));
+        }
+        convertScaledRowScalar(src + i, dst + i, count - i, scale);
+    }
+
+    TARGET_AVX2 static void convertScaledRow16uAvx2(const double* src, ushort* dst, int count, double scale) {
+        const __m256d factor = _mm256_set1_pd(scale);
+        int i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m128i low = _mm256_cvtpd_epi32(_mm256_mul_pd(_mm256_loadu_pd(src + i), factor));
+            __m128i high = _mm256_cvtpd_epi32(_mm256_mul_pd(_mm256_loadu_pd(src + i + 4), factor));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi32(low, high));
+        }
+        convertScaledRowScalar(src + i, dst + i, count - i, scale);
+    }
+
+    TARGET_AVX2 static void convertScaledRow32fAvx2(const double* src, float* dst, int count, double scale) {
+        const __m256d factor = _mm256_set1_pd(scale);
+        int i = 0;
+        for (; i + 4 <= count; i += 4) {
+            _mm_storeu_ps(dst + i, _mm256_cvtpd_ps(_mm256_mul_pd(_mm256_loadu_pd(src + i), factor)));
+        }
+        convertScaledRowScalar(src + i, dst + i, count - i, scale);
+    }
+
+    // Half floats are rounded to single precision first, as saturate_cast<float16_t> does
+    TARGET_AVX2 static void convertScaledRow16fAvx2(const double* src, cv::float16_t* dst, int count, double scale) {
+        const __m256d factor = _mm256_set1_pd(scale);
+        int i = 0;
+        for (; i + 4 <= count; i += 4) {
+            __m128 values = _mm256_cvtpd_ps(_mm256_mul_pd(_mm256_loadu_pd(src + i), factor));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i), _mm_cvtps_ph(values, _MM_FROUND_TO_NEAREST_INT));
+        }
+        convertScaledRowScalar(src + i, dst + i, count - i, scale);
+    }
+
+    // Unpacking works within 128-bit lanes, so wider levels split other channel counts with the SSE4.2 transpose
+    TARGET_AVX2 static void splitChannelsRowAvx2(const uchar* src, int channels, int elemSize, uchar* const* dst, int count) {
+        if (channels != 3) {
+            splitChannelsRowSse42(src, channels, elemSize, dst, count);
+            return;
+        }
+
+        // Pixels line up with every 96 bytes
+        const int pixelBytes = 3 * elemSize;
+        __m256i masks[3][3];
+        for (int c = 0; c < 3; ++c) {
+            for (int v = 0; v < 3; ++v) {
+                alignas(32) uchar bytes[32];
+                for (int j = 0; j < 32; ++j) {
+                    bytes[j] = (32 * v + j) / elemSize % 3 == c ? 0xFF : 0;
+                }
+                masks[c][v] = _mm256_load_si256(reinterpret_cast<const __m256i*>(bytes));
+            }
+        }
+
+        const int rowBytes = count * pixelBytes;
+        int offset = 0;
+        for (; offset + 96 <= rowBytes; offset += 96) {
+            for (int v = 0; v < 3; ++v) {
+                __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + offset + 32 * v));
+                for (int c = 0; c < 3; ++c) {
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst[c] + offset + 32 * v), _mm256_and_si256(pixels, masks[c][v]));
+                }
+            }
+        }
+        splitChannelsRange(src, channels, elemSize, dst, offset / pixelBytes, count);
+    }
+
+    // AVX-512 versions
+
+    TARGET_AVX512 static void blendNormalRow8uAvx512(const uchar* base, const uchar* blend, uchar* dst, int count, float alpha) {
+        const __m512 scale = _mm512_set1_ps(1.0f / BLEND_MAX_8U);
+        const __m512 weight = _mm512_set1_ps(alpha);
+        const __m512 maxValue = _mm512_set1_ps(BLEND_MAX_8U);
+        const __m512i zero = _mm512_setzero_si512();
+        int i = 0;
+        for (; i + 16 <= count; i += 16) {
+            __m512 a = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(base + i)))), scale);
+            __m512 b = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(blend + i)))), scale);
+            __m512 result = _mm512_add_ps(a, _mm512_mul_ps(_mm512_sub_ps(b, a), weight));
+            // Negative values clamp to 0 first, as the unsigned saturating narrow treats them as large
+            __m512i values = _mm512_max_epi32(_mm512_cvtps_epi32(_mm512_mul_ps(result, maxValue)), zero);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm512_cvtusepi32_epi8(values));
+        }
+        blendNormalRow8uScalar(base + i, blend + i, dst + i, count - i, alpha);
+    }
+
+    TARGET_AVX512 static void lookupRow16uAvx512(const ushort* src, const ushort* table, ushort* dst, int count) {
+        // A 32-bit gather of the last entry would read past the table, so that lane keeps a preset value
+        const __m512i lastIndex = _mm512_set1_epi32(LOOKUP_TABLE_SIZE_16U - 1);
+        const __m512i lastEntry = _mm512_set1_epi32(table[LOOKUP_TABLE_SIZE_16U - 1]);
+        const __m512i lowHalf = _mm512_set1_epi32(0xFFFF);
+        int i = 0;
+        for (; i + 16 <= count; i += 16) {
+            __m512i index = _mm512_cvtepu16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i)));
+            __mmask16 mask = _mm512_cmpneq_epi32_mask(index, lastIndex);
+            __m512i values = _mm512_and_si512(_mm512_mask_i32gather_epi32(lastEntry, mask, index, table, 2), lowHalf);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm512_cvtepi32_epi16(values));
+        }
+        lookupRow16uScalar(src + i, table, dst + i, count - i);
+    }
+
+    TARGET_AVX512 static inline __m512i convert16Avx512(const double* src, __m512d scale) {
+        __m256i low = _mm512_cvtpd_epi32(_mm512_mul_pd(_mm512_loadu_pd(src), scale));
+        __m256i high = _mm512_cvtpd_epi32(_mm512_mul_pd(_mm512_loadu_pd(src + 8), scale));
+        return _mm512_max_epi32(_mm512_inserti64x4(_mm512_castsi256_si512(low), high, 1), _mm512_setzero_si512());
+    }
+
+    TARGET_AVX512 static void convertScaledRow8uAvx512(const double* src, uchar* dst, int count, double scale) {
+        const __m512d factor = _mm512_set1_pd(scale);
+        int i = 0;
+        for (; i + 16 <= count; i += 16) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm512_cvtusepi32_epi8(convert16Avx512(src + i, factor)));
+        }
+        convertScaledRowScalar(src + i, dst + i, count - i, scale);
+    }
+
+    TARGET_AVX512 static void convertScaledRow16uAvx512(const double* src, ushort* dst, int count, double scale) {
+        const __m512d factor = _mm512_set1_pd(scale);
+        int i = 0;
+        for (; i + 16 <= count; i += 16) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm512_cvtusepi32_epi16(convert16Avx512(src + i, factor)));
+        }
+        convertScaledRowScalar(src + i, dst + i, count - i, scale);
+    }
+
+    TARGET_AVX512 static void convertScaledRow32fAvx512(const double* src, float* dst, int count, double scale) {
+        const __m512d factor = _mm512_set1_pd(scale);
+        int i = 0;
+        for (; i + 8 <= count; i += 8) {
+            _mm256_storeu_ps(dst + i, _mm512_cvtpd_ps(_mm512_mul_pd(_mm512_loadu_pd(src + i), factor)));
+        }
+        convertScaledRowScalar(src + i, dst + i, count - i, scale);
+    }
+
+    TARGET_AVX512 static void convertScaledRow16fAvx512(const double* src, cv::float16_t* dst, int count, double scale) {
+        const __m512d factor = _mm512_set1_pd(scale);
+        int i = 0;
+        for (; i + 16 <= count; i += 16) {
+            __m256 low = _mm512_cvtpd_ps(_mm512_mul_pd(_mm512_loadu_pd(src + i), factor));
+            __m256 high = _mm512_cvtpd_ps(_mm512_mul_pd(_mm512_loadu_pd(src + i + 8), factor));
+            __m512d both = _mm512_insertf64x4(_mm512_castpd256_pd512(_mm256_castps_pd(low)), _mm256_castps_pd(high), 1);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+                _mm512_cvtps_ph(_mm512_castpd_ps(both), _MM_FROUND_TO_NEAREST_INT));
+        }
+        convertScaledRowScalar(src + i, dst + i, count - i, scale);
+    }
+
+    TARGET_AVX512 static void splitChannelsRowAvx512(const uchar* src, int channels, int elemSize, uchar* const* dst, int count) {
+        if (channels != 3) {
+            splitChannelsRowSse42(src, channels, elemSize, dst, count);
+            return;
+        }
+
+        // Pixels line up with every 192 bytes
+        const int pixelBytes = 3 * elemSize;
+        __m512i masks[3][3];
+        for (int c = 0; c < 3; ++c) {
+            for (int v = 0; v < 3; ++v) {
+                alignas(64) uchar bytes[64];
+                for (int j = 0; j < 64; ++j) {
+                    bytes[j] = (64 * v + j) / elemSize % 3 == c ? 0xFF : 0;
+                }
+                masks[c][v] = _mm512_load_si512(bytes);
+            }
+        }
+
+        const int rowBytes = count * pixelBytes;
+        int offset = 0;
+        for (; offset + 192 <= rowBytes; offset += 192) {
+            for (int v = 0; v < 3; ++v) {
+                __m512i pixels = _mm512_loadu_si512(src + offset + 64 * v);
+                for (int c = 0; c < 3; ++c) {
+                    _mm512_storeu_si512(dst[c] + offset + 64 * v, _mm512_and_si512(pixels, masks[c][v]));
+                }
+            }
+        }
+        splitChannelsRange(src, channels, elemSize, dst, offset / pixelBytes, count);
+    }
+#endif
+
+    static const KernelTable& kernelsFor(CpuIsa isa) {
+        static const KernelTable scalar = { blendNormalRow8uScalar, lookupRow16uScalar,
+            convertScaledRowScalar<uchar>, convertScaledRowScalar<ushort>, convertScaledRowScalar<float>,
+            convertScaledRowScalar<cv::float16_t>, splitChannelsRowScalar };
+#ifdef IMAGE_PROCESSOR_X86
+        // Gathers need AVX2 and half-float conversion F16C, so the SSE4.2
+        // level looks up entries and converts half floats one by one
+        static const KernelTable sse42 = { blendNormalRow8uSse42, lookupRow16uScalar,
+            convertScaledRow8uSse42, convertScaledRow16uSse42, convertScaledRow32fSse42,
+            convertScaledRowScalar<cv::float16_t>, splitChannelsRowSse42 };
+        static const KernelTable avx2 = { blendNormalRow8uAvx2, lookupRow16uAvx2,
+            convertScaledRow8uAvx2, convertScaledRow16uAvx2, convertScaledRow32fAvx2,
+            convertScaledRow16fAvx2, splitChannelsRowAvx2 };
+        static const KernelTable avx512 = { blendNormalRow8uAvx512, lookupRow16uAvx512,
+            convertScaledRow8uAvx512, convertScaledRow16uAvx512, convertScaledRow32fAvx512,
+            convertScaledRow16fAvx512, splitChannelsRowAvx512 };
+
+        switch (isa) {
+        case CpuIsa::AVX512:
+            return avx512;
+        case CpuIsa::AVX2:
+            return avx2;
+        case CpuIsa::SSE42:
+            return sse42;
+        default:
+            return scalar;
+        }
+#else
+        return scalar;
+#endif
+    }
+
+    void blendNormalRow8u(const uchar* base, const uchar* blend, uchar* dst, int count, float alpha) {
+        kernelsFor(activeCpuIsa()).blendNormal8u(base, blend, dst, count, alpha);
+    }
+
+    void lookupRow16u(const ushort* src, const ushort* table, ushort* dst, int count) {
+        kernelsFor(activeCpuIsa()).lookup16u(src, table, dst, count);
+    }
+
+    void convertScaledRow(const double* src, uchar* dst, int count, double scale) {
+        kernelsFor(activeCpuIsa()).convert8u(src, dst, count, scale);
+    }
+
+    void convertScaledRow(const double* src, ushort* dst, int count, double scale) {
+        kernelsFor(activeCpuIsa()).convert16u(src, dst, count, scale);
+    }
+
+    void convertScaledRow(const double* src, float* dst, int count, double scale) {
+        kernelsFor(activeCpuIsa()).convert32f(src, dst, count, scale);
+    }
+
+    void convertScaledRow(const double* src, cv::float16_t* dst, int count, double scale) {
+        kernelsFor(activeCpuIsa()).convert16f(src, dst, count, scale);
+    }
+
+    void splitChannelsRow(const uchar* src, int channels, int elemSize, uchar* const* dst, int count) {
+        kernelsFor(activeCpuIsa()).splitChannels(src, channels, elemSize, dst, count);
+    }
+
+    template <typename T>
+    static bool sameBits(const std::vector<T>& expected, const std::vector<T>& actual,
+        const char* kernel, CpuIsa isa) {
+        if (std::memcmp(expected.data(), actual.data(), expected.size() * sizeof(T)) == 0) {
+            return true;
+        }
+        std::cerr << "verifyDispatchedKernels: " << kernel << " differs from the scalar version with "
+            << cpuIsaName(isa) << "." << std::endl;
+        return false;
+    }
+
+    bool verifyDispatchedKernels() {
+        // Lengths cover empty rows, pure tails and every remainder of the vector widths
+        static const int LENGTHS[] = { 0, 1, 3, 7, 8, 15, 16, 17, 31, 33, 64, 100, 1027 };
+        static const float ALPHAS[] = { 0.0f, 1.0f, 0.5f, 0.3f, 1.0f / 3.0f, 0.77777f };
+        static const double SCALES[] = { 1.0, 255.0, 65535.0 };
+        // Transposed, masked and scalar-only channel counts, for every element size
+        static const int SPLIT_CHANNELS[] = { 1, 2, 3, 4, 5, 8, 16 };
+        static const int SPLIT_ELEM_SIZES[] = { 1, 2, 4, 8 };
+
+        std::mt19937 generator(12345);
+        std::uniform_int_distribution<int> byteDistribution(0, 255);
+        std::uniform_int_distribution<int> wordDistribution(0, LOOKUP_TABLE_SIZE_16U - 1);
+        std::uniform_real_distribution<double> valueDistribution(-1.5, 1.5);
+
+        std::vector<ushort> table(LOOKUP_TABLE_SIZE_16U);
+        for (ushort& entry : table) {
+            entry = static_cast<ushort>(wordDistribution(generator));
+        }
+
+        const KernelTable& reference = kernelsFor(CpuIsa::SCALAR);
+        bool allEqual = true;
+
+        for (int level = static_cast<int>(CpuIsa::SSE42); level <= static_cast<int>(detectCpuIsa()); ++level) {
+            const CpuIsa isa = static_cast<CpuIsa>(level);
+            const KernelTable& kernels = kernelsFor(isa);
+
+            for (int length : LENGTHS) {
+                std::vector<uchar> base(length);
+                std::vector<uchar> blend(length);
+                std::vector<ushort> indices(length);
+                std::vector<double> values(length);
+                for (int i = 0; i < length; ++i) {
+                    base[i] = static_cast<uchar>(byteDistribution(generator));
+                    blend[i] = static_cast<uchar>(i % 5 == 0 ? 255 - base[i] : byteDistribution(generator));
+                    indices[i] = static_cast<ushort>(i % 3 == 0 ? LOOKUP_TABLE_SIZE_16U - 1 - i % 2 : wordDistribution(generator));
+                    values[i] = valueDistribution(generator);
+                }
+
+                // Ties, infinities, NaN and values outside the integer range
+                const double specials[] = { 0.5, 1.5, 2.5, -0.5, 1e12, -1e12,
+                    std::numeric_limits<double>::infinity(), std::numeric_limits<double>::quiet_NaN() };
+                for (int i = 0; i < length && i < 8; ++i) {
+                    values[length - 1 - i] = specials[i];
+                }
+
+                for (float alpha : ALPHAS) {
+                    std::vector<uchar> expected(length);
+                    std::vector<uchar> actual(length);
+                    reference.blendNormal8u(base.data(), blend.data(), expected.data(), length, alpha);
+                    kernels.blendNormal8u(base.data(), blend.data(), actual.data(), length, alpha);
+                    allEqual &= sameBits(expected, actual, "blendNormalRow8u", isa);
+                }
+
+                std::vector<ushort> expectedWords(length);
+                std::vector<ushort> actualWords(length);
+                reference.lookup16u(indices.data(), table.data(), expectedWords.data(), length);
+                kernels.lookup16u(indices.data(), table.data(), actualWords.data(), length);
+                allEqual &= sameBits(expectedWords, actualWords, "lookupRow16u", isa);
+
+                for (double scale : SCALES) {
+                    std::vector<uchar> expectedBytes(length);
+                    std::vector<uchar> actualBytes(length);
+                    reference.convert8u(values.data(), expectedBytes.data(), length, scale);
+                    kernels.convert8u(values.data(), actualBytes.data(), length, scale);
+                    allEqual &= sameBits(expectedBytes, actualBytes, "convertScaledRow (8U)", isa);
+
+                    reference.convert16u(values.data(), expectedWords.data(), length, scale);
+                    kernels.convert16u(values.data(), actualWords.data(), length, scale);
+                    allEqual &= sameBits(expectedWords, actualWords, "convertScaledRow (16U)", isa);
+
+                    std::vector<float> expectedFloats(length);
+                    std::vector<float> actualFloats(length);
+                    reference.convert32f(values.data(), expectedFloats.data(), length, scale);
+                    kernels.convert32f(values.data(), actualFloats.data(), length, scale);
+                    allEqual &= sameBits(expectedFloats, actualFloats, "convertScaledRow (32F)", isa);
+
+                    std::vector<cv::float16_t> expectedHalves(length);
+                    std::vector<cv::float16_t> actualHalves(length);
+                    reference.convert16f(values.data(), expectedHalves.data(), length, scale);
+                    kernels.convert16f(values.data(), actualHalves.data(), length, scale);
+                    allEqual &= sameBits(expectedHalves, actualHalves, "convertScaledRow (16F)", isa);
+                }
+
+                for (int channels : SPLIT_CHANNELS) {
+                    for (int elemSize : SPLIT_ELEM_SIZES) {
+                        std::vector<uchar> pixels(static_cast<size_t>(length) * channels * elemSize);
+                        for (uchar& value : pixels) {
+                            value = static_cast<uchar>(byteDistribution(generator));
+                        }
+
+                        // Destinations start with a fill value, so bytes left unwritten show up as differences
+                        const size_t rowBytes = static_cast<size_t>(length) * 3 * elemSize;
+                        std::vector<std::vector<uchar>> expectedRows(channels, std::vector<uchar>(rowBytes, 0xA5));
+                        std::vector<std::vector<uchar>> actualRows(channels, std::vector<uchar>(rowBytes, 0xA5));
+                        std::vector<uchar*> expectedPointers;
+                        std::vector<uchar*> actualPointers;
+                        for (int c = 0; c < channels; ++c) {
+                            expectedPointers.push_back(expectedRows[c].data());
+                            actualPointers.push_back(actualRows[c].data());
+                        }
+                        reference.splitChannels(pixels.data(), channels, elemSize, expectedPointers.data(), length);
+                        kernels.splitChannels(pixels.data(), channels, elemSize, actualPointers.data(), length);
+                        for (int c = 0; c < channels; ++c) {
+                            allEqual &= sameBits(expectedRows[c], actualRows[c], "splitChannelsRow", isa);
+                        }
+                    }
+                }
+            }
+        }
+
+        return allEqual;
+    }
+
+}
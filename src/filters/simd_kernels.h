@@ -0,0 +1,80 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+namespace image_processor {
+
+    /**
+     * Row kernels with SSE4.2, AVX2 and AVX-512 variants. Each call runs the
+     * variant for activeCpuIsa() (see cpu_dispatch.h). Every variant gives
+     * the same bits as the scalar one, which verifyDispatchedKernels checks.
+     */
+
+    /**
+     * @brief Normal blend of 8-bit samples, as blendImages computes it
+     *
+     * dst = round((a / 255 + (b / 255 - a / 255) * alpha) * 255) in single precision.
+     *
+     * @param base Base samples
+     * @param blend Blend samples
+     * @param dst Destination samples (may be base or blend)
+     * @param count Number of samples
+     * @param alpha Strength of the blend samples (0 to 1)
+     */
+    void blendNormalRow8u(const uchar* base, const uchar* blend, uchar* dst, int count, float alpha);
+
+    /**
+     * @brief Map 16-bit samples through a 65536-entry table
+     * @param src Source samples
+     * @param table Table of 65536 entries
+     * @param dst Destination samples (may be src)
+     * @param count Number of samples
+     */
+    void lookupRow16u(const ushort* src, const ushort* table, ushort* dst, int count);
+
+    /**
+     * @brief Scale samples and convert them with saturation, as cv::saturate_cast does
+     * @param src Source samples
+     * @param dst Destination samples
+     * @param count Number of samples
+     * @param scale Factor applied before the conversion
+     */
+    void convertScaledRow(const double* src, uchar* dst, int count, double scale);
+
+    /** @copydoc convertScaledRow(const double*, uchar*, int, double) */
+    void convertScaledRow(const double* src, ushort* dst, int count, double scale);
+
+    /** @copydoc convertScaledRow(const double*, uchar*, int, double) */
+    void convertScaledRow(const double* src, float* dst, int count, double scale);
+
+    /** @copydoc convertScaledRow(const double*, uchar*, int, double) */
+    void convertScaledRow(const double* src, cv::float16_t* dst, int count, double scale);
+
+    /**
+     * @brief Split interleaved pixels into one 3-channel row per channel, as ChannelSplitterNode shows them
+     *
+     * Channel c of each pixel goes to dst[c], in element c of a pixel when
+     * the source has 3 channels and in element 0 otherwise; the other
+     * elements are set to zero. All channels are split in one pass.
+     *
+     * @param src Source pixels
+     * @param channels Number of channels of the source
+     * @param elemSize Size of one channel value in bytes (1, 2, 4 or 8)
+     * @param dst One destination row per channel, 3 * elemSize bytes per pixel
+     * @param count Number of pixels
+     */
+    void splitChannelsRow(const uchar* src, int channels, int elemSize, uchar* const* dst, int count);
+
+    /**
+     * @brief Check every vector variant the processor supports against the scalar one
+     *
+     * Runs each kernel on random and edge-case data (including unaligned
+     * lengths, saturating values, the last table entry and every channel
+     * count the split vectorizes) for every instruction set up to
+     * detectCpuIsa(), and reports any difference on std::cerr.
+     *
+     * @return True if all variants are bit-exact, false otherwise
+     */
+    bool verifyDispatchedKernels();
+
+}
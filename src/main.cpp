@@ -1,13 +1,20 @@
+#include <filesystem>
 #include <iostream>
 #include <string>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 #include <opencv2/opencv.hpp>
 
 #include "core/node_graph.h"
 #include "core/image.h"
 #include "core/base_node.h"
-#include "input/input_node.h"
+#include "core/input_node.h"
 #include "core/output_node.h"
+#include "core/graph_serializer.h"
+#include "core/result_cache.h"
+#include "filters/cpu_dispatch.h"
+#include "filters/simd_kernels.h"
 #include "nodes/brightness_contrast_node.h"
 #include "nodes/channel_splitter_node.h"
 #include "nodes/threshold_node.h"
@@ -19,6 +26,12 @@
 
 using namespace image_processor;
 
+// Size budget of the result cache directory given with --cache
+static const uint64_t DEFAULT_CACHE_BYTES = 1ULL << 30;
+
+// Output rows computed at a time with --stream
+static const int DEFAULT_STRIP_ROWS = 256;
+
 // Function to display an image with OpenCV
 void displayImage(const std::string& windowName, const cv::Mat& image) {
     cv::namedWindow(windowName, cv::WINDOW_AUTOSIZE);
@@ -108,10 +121,19 @@ void processChannelSplitter(const std::string& inputImagePath) {
     // Process the graph
     graph.processGraph();
 
-    // Save the output images
-    redOutputNode->saveImage("output_red_channel.png");
-    greenOutputNode->saveImage("output_green_channel.png");
-    blueOutputNode->saveImage("output_blue_channel.png");
+    // Save the output images, encoding them in parallel
+    const std::vector<std::pair<OutputNode*, std::string>> outputFiles = {
+        { redOutputNode, "output_red_channel.png" },
+        { greenOutputNode, "output_green_channel.png" },
+        { blueOutputNode, "output_blue_channel.png" }
+    };
+    cv::parallel_for_(cv::Range(0, static_cast<int>(outputFiles.size())), [&](const cv::Range& range) {
+        for (int i = range.start; i < range.end; ++i) {
+            if (!outputFiles[i].first->saveImage(outputFiles[i].second)) {
+                std::cerr << "Failed to save output image: " << outputFiles[i].second << std::endl;
+            }
+        }
+    });
 
     // Display the input and output images
     displayImage("Input Image", inputNode->getImage());
@@ -404,10 +426,140 @@ void processConvolution(const std::string& inputImagePath, const std::string& ou
 
 
 
+void processGraphFile(const std::string& graphPath, const std::string& inputImagePath, ResultCache* cache) {
+    std::cout << "Loading processing graph from " << graphPath << "..." << std::endl;
+
+    // Create the node graph from the graph file
+    NodeGraph graph;
+    if (!GraphSerializer::load(graphPath, graph)) {
+        std::cerr << "Failed to load graph: " << graphPath << std::endl;
+        return;
+    }
+
+    // Feed the input image to any input node the graph file left empty
+    for (BaseNode* node : graph.getInputNodes()) {
+        InputNode* inputNode = static_cast<InputNode*>(node);
+        if (!inputNode->hasValidImage() && !inputNode->loadImage(inputImagePath)) {
+            std::cerr << "Failed to load input image: " << inputImagePath << std::endl;
+            return;
+        }
+    }
+
+    // Process the graph, reusing results of earlier runs when a cache is given
+    graph.setResultCache(cache);
+    graph.processGraph();
+
+    // Display every output of the graph
+    for (BaseNode* node : graph.getOutputNodes()) {
+        displayImage(node->getName(), static_cast<OutputNode*>(node)->getImage());
+    }
+
+    // Wait for a key press
+    cv::waitKey(0);
+}
+
+
+
+bool processGraphFileStreaming(const std::string& graphPath, const std::string& inputImagePath,
+    const std::string& outputImagePath) {
+    std::cout << "Streaming " << inputImagePath << " through " << graphPath << "..." << std::endl;
+
+    NodeGraph graph;
+    if (!GraphSerializer::load(graphPath, graph)) {
+        std::cerr << "Failed to load graph: " << graphPath << std::endl;
+        return false;
+    }
+
+    // Every input node reads the input file
+    std::unordered_map<BaseNode*, std::string> inputPaths;
+    for (BaseNode* node : graph.getInputNodes()) {
+        inputPaths[node] = inputImagePath;
+    }
+
+    // A single output node writes the output file; several write one file each, named after the node
+    std::unordered_map<BaseNode*, std::string> outputPaths;
+    std::vector<BaseNode*> outputNodes = graph.getOutputNodes();
+    for (BaseNode* node : outputNodes) {
+        std::filesystem::path path = outputImagePath;
+        if (outputNodes.size() > 1) {
+            path.replace_filename(path.stem().string() + "_" + node->getName() + path.extension().string());
+        }
+        outputPaths[node] = path.string();
+    }
+
+    if (!graph.processStreaming(inputPaths, outputPaths, DEFAULT_STRIP_ROWS)) {
+        std::cerr << "Failed to stream " << inputImagePath << " through " << graphPath << std::endl;
+        return false;
+    }
+
+    for (const auto& path : outputPaths) {
+        std::cout << "Output image saved to: " << path.second << std::endl;
+    }
+    return true;
+}
+
+
+
 int main(int argc, char** argv) {
     // Image path
     std::string inputImagePath = "input/input.jpg";
 
+    // Limit the vector kernels to an instruction set: --isa <scalar|sse4.2|avx2|avx512> ...
+    bool reportIsa = false;
+    if (argc > 2 && std::string(argv[1]) == "--isa") {
+        CpuIsa isa = CpuIsa::SCALAR;
+        if (!parseCpuIsa(argv[2], isa)) {
+            std::cerr << "Unknown instruction set: " << argv[2] << std::endl;
+            return 1;
+        }
+        setCpuIsaOverride(isa);
+        reportIsa = true;
+        argc -= 2;
+        argv += 2;
+    }
+
+    // Check the vector kernels against the scalar ones: --verify-kernels
+    const bool verifyKernels = argc > 1 && std::string(argv[1]) == "--verify-kernels";
+
+    // Report the kernels only when asked about them, on the log stream so
+    // that it does not mix into the output of demos and graphs
+    if (reportIsa || verifyKernels) {
+        std::clog << "Using " << cpuIsaName(activeCpuIsa()) << " kernels (detected "
+            << cpuIsaName(detectCpuIsa()) << ")" << std::endl;
+    }
+
+    if (verifyKernels) {
+        bool verified = verifyDispatchedKernels();
+        std::cout << (verified ? "All kernel variants match the scalar versions." : "Kernel verification failed.") << std::endl;
+        return verified ? 0 : 1;
+    }
+
+    // Keep node results between runs of graph files: --cache <directory> ...
+    std::unique_ptr<ResultCache> cache;
+    if (argc > 2 && std::string(argv[1]) == "--cache") {
+        cache.reset(new ResultCache(argv[2], DEFAULT_CACHE_BYTES));
+        if (!cache->isValid()) {
+            return 1;
+        }
+        argc -= 2;
+        argv += 2;
+    }
+
+    // Run a graph file instead of the built-in demos: --graph <file> [image]
+    if (argc > 2 && std::string(argv[1]) == "--graph") {
+        processGraphFile(argv[2], argc > 3 ? argv[3] : inputImagePath, cache.get());
+        return 0;
+    }
+
+    // Run a graph file over an image too large for memory, strip by strip:
+    // --stream <file> <image> <output> (raw .ipr or TIFF images)
+    if (argc > 4 && std::string(argv[1]) == "--stream") {
+        if (cache) {
+            std::cout << "The result cache is not used for streaming." << std::endl;
+        }
+        return processGraphFileStreaming(argv[2], argv[3], argv[4]) ? 0 : 1;
+    }
+
     if (argc > 1) {
         inputImagePath = argv[1];
     }
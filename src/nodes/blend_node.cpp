@@ -1,13 +1,85 @@
 #include "blend_node.h"
+#include "node_registry.h"
+#include "pixel_kernels.h"
+#include "pyramid.h"
 #include <iostream>
 #include <algorithm>
 
 namespace image_processor {
 
+    // Symbolic names of BlendMode values, in declaration order
+    static const char* const BLEND_MODE_NAMES[] = {
+        "NORMAL", "ADD", "MULTIPLY", "SCREEN", "OVERLAY", "DARKEN", "LIGHTEN", "DIFFERENCE", "MULTIBAND"
+    };
+    static const int BLEND_MODE_COUNT = sizeof(BLEND_MODE_NAMES) / sizeof(BLEND_MODE_NAMES[0]);
+
+    // Largest number of pyramid bands for MULTIBAND blending
+    static const int BLEND_MAX_BANDS = 12;
+
+    // Register the node type for graph files and dynamic construction
+    static NodeTypeRegistrar s_blendNodeRegistrar({
+        "BlendNode",
+        "Blend",
+        [](const std::string& name) -> BaseNode* { return new BlendNode(name); },
+        {
+            { "blendMode", ParameterType::ENUM, std::string("NORMAL"), "Blending mode", 0.0, 0.0,
+                std::vector<std::string>(BLEND_MODE_NAMES, BLEND_MODE_NAMES + BLEND_MODE_COUNT) },
+            { "alpha", ParameterType::DOUBLE, 0.5, "Strength of the blend image", 0.0, 1.0 },
+            { "bands", ParameterType::INT, 5, "Number of pyramid bands for MULTIBAND blending", 1.0, 12.0 }
+        }
+    });
+
+    // Convert the blend image in place to the size, channel count and depth of the base image
+    static bool conformBlendImage(const cv::Mat& base, cv::Mat& blend) {
+        // cv::resize and cv::cvtColor do not accept half floats; the depth conversion below narrows them again
+        if (blend.size() != base.size() || blend.channels() != base.channels()) {
+            blend = widenHalfFloat(blend);
+        }
+
+        if (blend.size() != base.size()) {
+            cv::resize(blend, blend, base.size());
+        }
+
+        const int baseChannels = base.channels();
+        const int blendChannels = blend.channels();
+        if (blendChannels != baseChannels) {
+            if (baseChannels == 1 && blendChannels == 3) {
+                cv::cvtColor(blend, blend, cv::COLOR_BGR2GRAY);
+            }
+            else if (baseChannels == 1 && blendChannels == 4) {
+                cv::cvtColor(blend, blend, cv::COLOR_BGRA2GRAY);
+            }
+            else if (baseChannels == 3 && blendChannels == 1) {
+                cv::cvtColor(blend, blend, cv::COLOR_GRAY2BGR);
+            }
+            else if (baseChannels == 3 && blendChannels == 4) {
+                cv::cvtColor(blend, blend, cv::COLOR_BGRA2BGR);
+            }
+            else if (baseChannels == 4 && blendChannels == 1) {
+                cv::cvtColor(blend, blend, cv::COLOR_GRAY2BGRA);
+            }
+            else if (baseChannels == 4 && blendChannels == 3) {
+                cv::cvtColor(blend, blend, cv::COLOR_BGR2BGRA);
+            }
+            else {
+                return false;
+            }
+        }
+
+        // Rescale so that full intensity maps to full intensity (e.g. 255 in 8U to 65535 in 16U)
+        if (blend.depth() != base.depth()) {
+            double scale = depthMaxValue(base.depth()) / depthMaxValue(blend.depth());
+            blend.convertTo(blend, base.type(), scale);
+        }
+        return true;
+    }
+
     BlendNode::BlendNode(const std::string& name, BlendMode blendMode, double alpha)
         : BaseNode(name),
         m_blendMode(blendMode),
-        m_alpha(validateAlpha(alpha)) {
+        m_alpha(validateAlpha(alpha)),
+        m_bands(5),
+        m_blendVersion(0) {
     }
 
     void BlendNode::process() {
@@ -32,78 +104,69 @@ namespace image_processor {
             return;
         }
 
-        // Ensure both images have the same size and type
-        if (inputImage1.size() != inputImage2.size()) {
-            // Resize the second image to match the first
-            std::cout << "Images not of same size" << std::endl;
-            cv::resize(inputImage2, inputImage2, inputImage1.size());
-        }
-
-        // Ensure same number of channels
-        if (inputImage1.channels() != inputImage2.channels()) {
-            if (inputImage2.channels() == 1) {
-                cv::cvtColor(inputImage2, inputImage2, cv::COLOR_GRAY2BGR);
-            }
-            else {
-                cv::cvtColor(inputImage2, inputImage2, cv::COLOR_BGR2GRAY);
-            }
-        }
-
-        // Convert images to the same type if needed
-        int targetType = inputImage1.type();
-        if (inputImage2.type() != targetType) {
-            inputImage2.convertTo(inputImage2, targetType);
+        // Ensure both images have the same size, channel count and depth
+        const uchar* blendData = inputImage2.data;
+        if (!conformBlendInput(inputImage1, inputImage2, input2.first->getOutputVersion(input2.second))) {
+            std::cerr << "BlendNode::process: Cannot convert the blend image to the type of the base image." << std::endl;
+            return;
         }
 
+        // Consumers that read part of the image get only that part blended. The
+        // margin is 0, so the view of the base image covers the clipped region itself.
         cv::Mat outputImage;
+        const cv::Rect region = getRequestedRegion() & cv::Rect(0, 0, inputImage1.cols, inputImage1.rows);
+        auto blendView = [this, &inputImage2, region](const cv::Mat& base, cv::Mat& blended) {
+            blendPixels(base, inputImage2(region), blended);
+        };
+        if (filterRequestedRegion(inputImage1, outputImage, getRegionMargin(0), blendView)) {
+            setOutputValue(0, outputImage);
+            return;
+        }
 
-        // Apply the selected blending mode
-        switch (m_blendMode) {
-        case BlendMode::NORMAL:
-            applyNormalBlend(inputImage1, inputImage2, outputImage);
-            break;
-
-        case BlendMode::ADD:
-            applyAddBlend(inputImage1, inputImage2, outputImage);
-            break;
-
-        case BlendMode::MULTIPLY:
-            applyMultiplyBlend(inputImage1, inputImage2, outputImage);
-            break;
-
-        case BlendMode::SCREEN:
-            applyScreenBlend(inputImage1, inputImage2, outputImage);
-            break;
-
-        case BlendMode::OVERLAY:
-            applyOverlayBlend(inputImage1, inputImage2, outputImage);
-            break;
-
-        case BlendMode::DARKEN:
-            applyDarkenBlend(inputImage1, inputImage2, outputImage);
-            break;
+        if (m_blendMode == BlendMode::MULTIBAND) {
+            std::vector<cv::Mat> basePyramid = getInputPyramid(0, m_bands - 1);
+            const int levels = static_cast<int>(basePyramid.size()) - 1;
 
-        case BlendMode::LIGHTEN:
-            applyLightenBlend(inputImage1, inputImage2, outputImage);
-            break;
+            // The pyramid cached by the producer only fits if the blend input needed no conversion
+            std::vector<cv::Mat> blendPyramid;
+            if (inputImage2.data == blendData) {
+                blendPyramid = getInputPyramid(1, levels);
+            }
+            else {
+                if (static_cast<int>(m_conformedPyramid.size()) != levels + 1) {
+                    cv::buildPyramid(widenHalfFloat(m_conformedBlend), m_conformedPyramid, levels);
+                }
+                blendPyramid = m_conformedPyramid;
+            }
 
-        case BlendMode::DIFFERENCE:
-            applyDifferenceBlend(inputImage1, inputImage2, outputImage);
-            break;
+            cv::Mat mask = getDerivedInput(2, DerivedFormat::GRAY);
+            if (!mask.empty() && mask.size() != inputImage1.size()) {
+                cv::resize(mask, mask, inputImage1.size(), 0, 0, cv::INTER_LINEAR);
+            }
 
-        default:
-            std::cerr << "BlendNode::process: Unknown blend mode." << std::endl;
-            applyNormalBlend(inputImage1, inputImage2, outputImage);
-            break;
+            if (!multiBandBlend(basePyramid, blendPyramid, mask, m_alpha, inputImage1.depth(), outputImage)) {
+                outputImage = inputImage1.clone();
+            }
+        }
+        else {
+            blendPixels(inputImage1, inputImage2, outputImage);
         }
 
-        cv::addWeighted(inputImage1, 1.0 - m_alpha, inputImage2, m_alpha, 0.0, outputImage);
+        setOutputValue(0, outputImage);
+    }
 
-        m_outputValues[0] = outputImage;
+    void BlendNode::blendPixels(const cv::Mat& base, const cv::Mat& blend, cv::Mat& outputImage) const {
+        if (isKernelTypeSupported(base.type())) {
+            blendImages(base, blend, outputImage, m_blendMode, m_alpha);
+        }
+        else {
+            // Types without a specialized kernel fall back to plain alpha blending
+            cv::addWeighted(base, 1.0 - m_alpha, blend, m_alpha, 0.0, outputImage);
+        }
     }
 
     int BlendNode::getInputCount() const {
-        return 2; // Two inputs for the source images
+        return 3; // Two source images and an optional mask
     }
 
     int BlendNode::getOutputCount() const {
@@ -117,6 +180,9 @@ namespace image_processor {
         else if (index == 1) {
             return "Blend Image";
         }
+        else if (index == 2) {
+            return "Mask";
+        }
         return "";
     }
 
@@ -127,142 +193,109 @@ namespace image_processor {
         return "";
     }
 
-    void BlendNode::setBlendMode(BlendMode blendMode) {
-        m_blendMode = blendMode;
+    PortType BlendNode::getInputType(int index) const {
+        return index == 2 ? PortType::MASK : PortType::IMAGE;
     }
 
-    BlendMode BlendNode::getBlendMode() const {
-        return m_blendMode;
+    bool BlendNode::isInputOptional(int index) const {
+        return index == 2;
     }
 
-    void BlendNode::setAlpha(double alpha) {
-        m_alpha = validateAlpha(alpha);
-    }
-
-    double BlendNode::getAlpha() const {
-        return m_alpha;
+    std::string BlendNode::getTypeName() const {
+        return "BlendNode";
     }
 
-    double BlendNode::validateAlpha(double alpha) {
-        return std::max(0.0, std::min(1.0, alpha));
+    int BlendNode::getRegionMargin(int inputIndex) const {
+        // The blend image and mask may be resized to the base image, and the
+        // multi-band blend spreads each pixel over its coarsest band
+        if (inputIndex != 0 || m_blendMode == BlendMode::MULTIBAND) {
+            return WHOLE_IMAGE_MARGIN;
+        }
+        return 0;
     }
 
-    void BlendNode::applyNormalBlend(const cv::Mat& src1, const cv::Mat& src2, cv::Mat& dst) {
-        // Normal blending: dst = src1 * (1 - alpha) + src2 * alpha
-        cv::addWeighted(src1, 1.0 - m_alpha, src2, m_alpha, 0.0, dst);
+    ParameterMap BlendNode::getParameters() const {
+        ParameterMap parameters;
+        parameters["blendMode"] = enumToString(static_cast<int>(m_blendMode), BLEND_MODE_NAMES, BLEND_MODE_COUNT);
+        parameters["alpha"] = m_alpha;
+        parameters["bands"] = m_bands;
+        return parameters;
     }
 
-    void BlendNode::applyAddBlend(const cv::Mat& src1, const cv::Mat& src2, cv::Mat& dst) {
-        // Add blending: dst = src1 + src2 * alpha
-        cv::addWeighted(src1, 1.0, src2, m_alpha, 0.0, dst);
+    bool BlendNode::setParameter(const std::string& name, const ParameterValue& value) {
+        int intValue = 0;
+        double doubleValue = 0.0;
 
-        // Ensure values don't exceed the maximum
-        cv::min(dst, 255, dst);
+        if (name == "blendMode" && parameterToEnum(value, BLEND_MODE_NAMES, BLEND_MODE_COUNT, intValue)) {
+            setBlendMode(static_cast<BlendMode>(intValue));
+            return true;
+        }
+        if (name == "alpha" && parameterToDouble(value, doubleValue)) {
+            setAlpha(doubleValue);
+            return true;
+        }
+        if (name == "bands" && parameterToInt(value, intValue)) {
+            setBands(intValue);
+            return true;
+        }
+        return false;
     }
 
-    void BlendNode::applyMultiplyBlend(const cv::Mat& src1, const cv::Mat& src2, cv::Mat& dst) {
-        // Multiply blending: dst = src1 * (src2 * alpha + (1 - alpha))
-
-        // Create a temporary image for the blend factor
-        cv::Mat blendFactor;
-        cv::addWeighted(src2, m_alpha, cv::Scalar::all(255), 1.0 - m_alpha, 0.0, blendFactor);
-
-        // Convert to float for multiplication
-        cv::Mat src1Float, blendFactorFloat;
-        src1.convertTo(src1Float, CV_32F, 1.0 / 255.0);
-        blendFactor.convertTo(blendFactorFloat, CV_32F, 1.0 / 255.0);
-
-        // Multiply
-        cv::Mat resultFloat;
-        cv::multiply(src1Float, blendFactorFloat, resultFloat);
-
-        // Convert back to original type
-        resultFloat.convertTo(dst, src1.type(), 255.0);
+    void BlendNode::setBlendMode(BlendMode blendMode) {
+        m_blendMode = blendMode;
     }
 
-    void BlendNode::applyScreenBlend(const cv::Mat& src1, const cv::Mat& src2, cv::Mat& dst) {
-        // Screen blending: dst = 1 - (1 - src1) * (1 - src2 * alpha)
-
-        // Convert to float for calculations
-        cv::Mat src1Float, src2Float;
-        src1.convertTo(src1Float, CV_32F, 1.0 / 255.0);
-        src2.convertTo(src2Float, CV_32F, 1.0 / 255.0);
-
-        // Apply screen formula
-        cv::Mat invSrc1, invSrc2, result;
-        invSrc1 = 1.0 - src1Float;
-        invSrc2 = 1.0 - src2Float * m_alpha - cv::Scalar::all(1.0 - m_alpha);
-        cv::multiply(invSrc1, invSrc2, result);
-        result = 1.0 - result;
-
-        // Convert back to original type
-        result.convertTo(dst, src1.type(), 255.0);
+    BlendMode BlendNode::getBlendMode() const {
+        return m_blendMode;
     }
 
-    void BlendNode::applyOverlayBlend(const cv::Mat& src1, const cv::Mat& src2, cv::Mat& dst) {
-        // Overlay blending: combines Multiply and Screen modes
-        // If src1 < 0.5: dst = 2 * src1 * src2
-        // If src1 >= 0.5: dst = 1 - 2 * (1 - src1) * (1 - src2)
-
-        // Convert to float for calculations
-        cv::Mat src1Float, src2Float;
-        src1.convertTo(src1Float, CV_32F, 1.0 / 255.0);
-        src2.convertTo(src2Float, CV_32F, 1.0 / 255.0);
-
-        // Adjust src2 with alpha
-        src2Float = src2Float * m_alpha + cv::Scalar::all(0.5 * (1.0 - m_alpha));
-
-        // Create masks for the two conditions
-        cv::Mat mask1, mask2;
-        mask1 = src1Float < 0.5;
-        mask2 = src1Float >= 0.5;
-
-        // Apply the two formulas
-        cv::Mat result1, result2, result;
-        cv::multiply(2.0 * src1Float, src2Float, result1);
-        cv::multiply(1.0 - 2.0 * (1.0 - src1Float), 1.0 - 2.0 * (1.0 - src2Float), result2);
-        result2 = 1.0 - result2;
-
-        // Combine the results using the masks
-        result = cv::Mat::zeros(src1Float.size(), CV_32F);
-        result1.copyTo(result, mask1);
-        result2.copyTo(result, mask2);
-
-        // Convert back to original type
-        result.convertTo(dst, src1.type(), 255.0);
+    void BlendNode::setAlpha(double alpha) {
+        m_alpha = validateAlpha(alpha);
     }
 
-    void BlendNode::applyDarkenBlend(const cv::Mat& src1, const cv::Mat& src2, cv::Mat& dst) {
-        // Darken blending: dst = min(src1, src2)
-
-        // Adjust src2 with alpha
-        cv::Mat adjustedSrc2;
-        cv::addWeighted(src2, m_alpha, src1, 1.0 - m_alpha, 0.0, adjustedSrc2);
+    double BlendNode::getAlpha() const {
+        return m_alpha;
+    }
 
-        // Apply darken formula
-        cv::min(src1, adjustedSrc2, dst);
+    void BlendNode::setBands(int bands) {
+        m_bands = std::min(std::max(bands, 1), BLEND_MAX_BANDS);
     }
 
-    void BlendNode::applyLightenBlend(const cv::Mat& src1, const cv::Mat& src2, cv::Mat& dst) {
-        // Lighten blending: dst = max(src1, src2)
+    int BlendNode::getBands() const {
+        return m_bands;
+    }
 
-        // Adjust src2 with alpha
-        cv::Mat adjustedSrc2;
-        cv::addWeighted(src2, m_alpha, src1, 1.0 - m_alpha, 0.0, adjustedSrc2);
+    bool BlendNode::conformBlendInput(const cv::Mat& base, cv::Mat& blend, uint64_t blendVersion) {
+        if (blend.size() == base.size() && blend.type() == base.type()) {
+            return true;
+        }
 
-        // Apply lighten formula
-        cv::max(src1, adjustedSrc2, dst);
-    }
+        // An output keeps its version until it is set again, and versions are
+        // never reused, so an unchanged version means the same blend image
+        bool cached = !m_conformedBlend.empty() &&
+            blendVersion != 0 &&
+            m_blendVersion == blendVersion &&
+            m_conformedBlend.size() == base.size() &&
+            m_conformedBlend.type() == base.type();
+        if (cached) {
+            blend = m_conformedBlend;
+            return true;
+        }
 
-    void BlendNode::applyDifferenceBlend(const cv::Mat& src1, const cv::Mat& src2, cv::Mat& dst) {
-        // Difference blending: dst = |src1 - src2|
+        cv::Mat conformed = blend;
+        if (!conformBlendImage(base, conformed)) {
+            return false;
+        }
 
-        // Adjust src2 with alpha
-        cv::Mat adjustedSrc2;
-        cv::addWeighted(src2, m_alpha, src1, 1.0 - m_alpha, 0.0, adjustedSrc2);
+        m_blendVersion = blendVersion;
+        m_conformedBlend = conformed;
+        m_conformedPyramid.clear();
+        blend = conformed;
+        return true;
+    }
 
-        // Apply difference formula
-        cv::absdiff(src1, adjustedSrc2, dst);
+    double BlendNode::validateAlpha(double alpha) {
+        return std::max(0.0, std::min(1.0, alpha));
     }
 
 } // namespace image_processor
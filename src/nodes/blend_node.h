@@ -1,29 +1,25 @@
 #pragma once
 
 #include "base_node.h"
+#include "blend_kernels.h"
 #include <opencv2/opencv.hpp>
 
 namespace image_processor {
 
-    /**
-     * @brief Enumeration of available blending modes
-     */
-    enum class BlendMode {
-        NORMAL,     // Simple alpha blending
-        ADD,        // Addition blending
-        MULTIPLY,   // Multiplication blending
-        SCREEN,     // Screen blending
-        OVERLAY,    // Overlay blending
-        DARKEN,     // Darken blending
-        LIGHTEN,    // Lighten blending
-        DIFFERENCE  // Difference blending
-    };
-
     /**
      * @brief Node for blending two images together
      *
      * This node takes two input images and blends them together using
      * various blending modes and an alpha factor to control the blend strength.
+     * The blend image is converted to the size, channel count and depth of the
+     * base image, and each mode runs as a kernel specialized for the depth and
+     * channel count (see blendImages). The converted blend image is cached
+     * and reused for as long as the blend input and the base geometry stay
+     * the same, so a static overlay is converted once rather than per frame.
+     *
+     * MULTIBAND mixes the Laplacian pyramids of the images through the
+     * optional mask input (see multiBandBlend), using the pyramids cached by
+     * the producers of the inputs.
      */
     class BlendNode : public BaseNode {
     public:
@@ -51,7 +47,7 @@ namespace image_processor {
 
         /**
          * @brief Get the number of inputs this node accepts
-         * @return Always returns 2 as this node accepts two input images
+         * @return Always returns 3 (base image, blend image and optional mask)
          */
         virtual int getInputCount() const override;
 
@@ -75,6 +71,48 @@ namespace image_processor {
          */
         virtual std::string getOutputName(int index) const override;
 
+        /**
+         * @brief Get the type of a specific input
+         * @param index The input index
+         * @return MASK for the mask input, IMAGE otherwise
+         */
+        virtual PortType getInputType(int index) const override;
+
+        /**
+         * @brief Check if an input may stay unconnected
+         * @param index The input index
+         * @return True for the mask input, false otherwise
+         */
+        virtual bool isInputOptional(int index) const override;
+
+        /**
+         * @brief Get the stable type identifier of this node
+         * @return Always returns "BlendNode"
+         */
+        virtual std::string getTypeName() const override;
+
+        /**
+         * @brief Get the margin of an input each blended pixel depends on
+         * @param inputIndex The input index
+         * @return 0 for the base image, WHOLE_IMAGE_MARGIN for the blend image,
+         *         the mask and every input of MULTIBAND
+         */
+        virtual int getRegionMargin(int inputIndex) const override;
+
+        /**
+         * @brief Get the current parameters of this node
+         * @return Map of parameter names to values
+         */
+        virtual ParameterMap getParameters() const override;
+
+        /**
+         * @brief Set a parameter by name
+         * @param name The parameter name (as returned by getParameters)
+         * @param value The new value
+         * @return True if the parameter was recognised and applied, false otherwise
+         */
+        virtual bool setParameter(const std::string& name, const ParameterValue& value) override;
+
         /**
          * @brief Set the blend mode
          * @param blendMode The new blend mode
@@ -99,80 +137,50 @@ namespace image_processor {
          */
         double getAlpha() const;
 
-    private:
-        BlendMode m_blendMode;  // Type of blending to apply
-        double m_alpha;         // Alpha value for blending (0.0 to 1.0)
-
         /**
-         * @brief Validate the alpha value to ensure it's in the range [0.0, 1.0]
-         * @param alpha The alpha value to validate
-         * @return A valid alpha value clamped to [0.0, 1.0]
+         * @brief Set the number of pyramid bands (for MULTIBAND)
+         * @param bands The new number of bands (clamped to 1..12)
          */
-        double validateAlpha(double alpha);
-
-        /**
-         * @brief Apply normal blending (alpha blending)
-         * @param src1 First source image
-         * @param src2 Second source image
-         * @param dst Destination image
-         */
-        void applyNormalBlend(const cv::Mat& src1, const cv::Mat& src2, cv::Mat& dst);
+        void setBands(int bands);
 
         /**
-         * @brief Apply addition blending
-         * @param src1 First source image
-         * @param src2 Second source image
-         * @param dst Destination image
+         * @brief Get the current number of pyramid bands
+         * @return The current number of bands
          */
-        void applyAddBlend(const cv::Mat& src1, const cv::Mat& src2, cv::Mat& dst);
+        int getBands() const;
 
-        /**
-         * @brief Apply multiplication blending
-         * @param src1 First source image
-         * @param src2 Second source image
-         * @param dst Destination image
-         */
-        void applyMultiplyBlend(const cv::Mat& src1, const cv::Mat& src2, cv::Mat& dst);
-
-        /**
-         * @brief Apply screen blending
-         * @param src1 First source image
-         * @param src2 Second source image
-         * @param dst Destination image
-         */
-        void applyScreenBlend(const cv::Mat& src1, const cv::Mat& src2, cv::Mat& dst);
+    private:
+        BlendMode m_blendMode;  // Type of blending to apply
+        double m_alpha;         // Alpha value for blending (0.0 to 1.0)
+        int m_bands;            // Number of pyramid bands for MULTIBAND blending
 
-        /**
-         * @brief Apply overlay blending
-         * @param src1 First source image
-         * @param src2 Second source image
-         * @param dst Destination image
-         */
-        void applyOverlayBlend(const cv::Mat& src1, const cv::Mat& src2, cv::Mat& dst);
+        uint64_t m_blendVersion;                  // Output version of the blend input m_conformedBlend was made from
+        cv::Mat m_conformedBlend;                 // Blend input converted to the size and type of the base input
+        std::vector<cv::Mat> m_conformedPyramid;  // Pyramid of m_conformedBlend for MULTIBAND, built on demand
 
         /**
-         * @brief Apply darken blending
-         * @param src1 First source image
-         * @param src2 Second source image
-         * @param dst Destination image
+         * @brief Convert the blend input to the size and type of the base input, reusing the last conversion
+         * @param base The base input
+         * @param blend The blend input, replaced by the converted image
+         * @param blendVersion Output version of the blend input (see BaseNode::getOutputVersion)
+         * @return True if the images match now, false if the blend input cannot be converted
          */
-        void applyDarkenBlend(const cv::Mat& src1, const cv::Mat& src2, cv::Mat& dst);
+        bool conformBlendInput(const cv::Mat& base, cv::Mat& blend, uint64_t blendVersion);
 
         /**
-         * @brief Apply lighten blending
-         * @param src1 First source image
-         * @param src2 Second source image
-         * @param dst Destination image
+         * @brief Blend two images of the same size and type pixel by pixel with the current mode
+         * @param base The base image
+         * @param blend The blend image
+         * @param outputImage Receives the blended image
          */
-        void applyLightenBlend(const cv::Mat& src1, const cv::Mat& src2, cv::Mat& dst);
+        void blendPixels(const cv::Mat& base, const cv::Mat& blend, cv::Mat& outputImage) const;
 
         /**
-         * @brief Apply difference blending
-         * @param src1 First source image
-         * @param src2 Second source image
-         * @param dst Destination image
+         * @brief Validate the alpha value to ensure it's in the range [0.0, 1.0]
+         * @param alpha The alpha value to validate
+         * @return A valid alpha value clamped to [0.0, 1.0]
          */
-        void applyDifferenceBlend(const cv::Mat& src1, const cv::Mat& src2, cv::Mat& dst);
+        double validateAlpha(double alpha);
     };
 
 } // namespace image_processor
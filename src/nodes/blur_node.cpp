@@ -1,8 +1,42 @@
 #include "blur_node.h"
+#include "node_registry.h"
+#include "median_filter.h"
+#include "bilateral_grid.h"
+#include "recursive_gaussian.h"
+#include "box_filter.h"
+#include "pixel_kernels.h"
+#include "pyramid.h"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
 namespace image_processor {
 
+    // Symbolic names of BlurType values, in declaration order
+    static const char* const BLUR_TYPE_NAMES[] = { "BOX", "GAUSSIAN", "MEDIAN", "BILATERAL", "BILATERAL_GRID", "RECURSIVE_GAUSSIAN", "STACKED_BOX" };
+    static const int BLUR_TYPE_COUNT = sizeof(BLUR_TYPE_NAMES) / sizeof(BLUR_TYPE_NAMES[0]);
+
+    // Coarsest pyramid level the node may blur at
+    static const int BLUR_MAX_PYRAMID_LEVELS = 8;
+
+    // Register the node type for graph files and dynamic construction
+    static NodeTypeRegistrar s_blurNodeRegistrar({
+        "BlurNode",
+        "Blur",
+        [](const std::string& name) -> BaseNode* { return new BlurNode(name); },
+        {
+            { "blurType", ParameterType::ENUM, std::string("GAUSSIAN"), "Type of blur to apply", 0.0, 0.0,
+                std::vector<std::string>(BLUR_TYPE_NAMES, BLUR_TYPE_NAMES + BLUR_TYPE_COUNT) },
+            { "kernelSize", ParameterType::INT, 5, "Size of the blur kernel (positive and odd)", 1.0 },
+            { "sigmaX", ParameterType::DOUBLE, 0.0, "Sigma X for Gaussian blur (0 derives it from the kernel size)", 0.0 },
+            { "sigmaY", ParameterType::DOUBLE, 0.0, "Sigma Y for Gaussian blur (0 uses sigma X)", 0.0 },
+            { "sigmaColor", ParameterType::DOUBLE, 75.0, "Sigma color for the bilateral filter", 0.0 },
+            { "sigmaSpace", ParameterType::DOUBLE, 75.0, "Sigma space for the bilateral filter", 0.0 },
+            { "boxPasses", ParameterType::INT, 3, "Number of box passes for the stacked box blur", 1.0 },
+            { "pyramidLevels", ParameterType::INT, 0, "Coarsest pyramid level for wide Gaussian blurs (0 blurs at full resolution)", 0.0, 8.0 }
+        }
+    });
+
     BlurNode::BlurNode(const std::string& name, BlurType blurType, int kernelSize,
         double sigmaX, double sigmaY, double sigmaColor, double sigmaSpace)
         : BaseNode(name),
@@ -11,7 +45,9 @@ namespace image_processor {
         m_sigmaX(sigmaX),
         m_sigmaY(sigmaY),
         m_sigmaColor(sigmaColor),
-        m_sigmaSpace(sigmaSpace) {
+        m_sigmaSpace(sigmaSpace),
+        m_boxPasses(3),
+        m_pyramidLevels(0) {
     }
 
     void BlurNode::process() {
@@ -32,12 +68,36 @@ namespace image_processor {
             return;
         }
 
+        // Half-float images are filtered in single precision and stored back in half precision
+        auto blur = [this](const cv::Mat& source, cv::Mat& filtered) {
+            blurImage(widenHalfFloat(source), filtered);
+            narrowHalfFloat(filtered, source.depth());
+        };
+
+        // Consumers that read part of the image get only that part blurred;
+        // otherwise wide blurs run on a coarse pyramid level when allowed
         cv::Mat outputImage;
+        if (filterRequestedRegion(inputImage, outputImage, getRegionMargin(0), blur)) {
+            setOutputValue(0, outputImage);
+            return;
+        }
+        if (blurOnPyramid(outputImage)) {
+            narrowHalfFloat(outputImage, inputImage.depth());
+            setOutputValue(0, outputImage);
+            return;
+        }
+
+        blur(inputImage, outputImage);
+        setOutputValue(0, outputImage);
+    }
 
+    void BlurNode::blurImage(const cv::Mat& inputImage, cv::Mat& outputImage) const {
         // Apply the selected blur effect
         switch (m_blurType) {
         case BlurType::BOX:
-            cv::blur(inputImage, outputImage, cv::Size(m_kernelSize, m_kernelSize));
+            if (!fastBoxFilter(inputImage, outputImage, m_kernelSize)) {
+                cv::blur(inputImage, outputImage, cv::Size(m_kernelSize, m_kernelSize));
+            }
             break;
 
         case BlurType::GAUSSIAN:
@@ -45,20 +105,47 @@ namespace image_processor {
             break;
 
         case BlurType::MEDIAN:
-            cv::medianBlur(inputImage, outputImage, m_kernelSize);
+            // cv::medianBlur is fastest for small apertures but slows down with
+            // the kernel size and rejects large kernels on non-8-bit images
+            if (m_kernelSize <= 5) {
+                cv::medianBlur(inputImage, outputImage, m_kernelSize);
+            }
+            else if (!constantTimeMedianBlur(inputImage, outputImage, m_kernelSize)) {
+                outputImage = inputImage.clone();
+            }
             break;
 
         case BlurType::BILATERAL:
             cv::bilateralFilter(inputImage, outputImage, m_kernelSize, m_sigmaColor, m_sigmaSpace);
             break;
 
+        case BlurType::BILATERAL_GRID:
+            // The support follows sigma space, so the kernel size is not used
+            if (!bilateralGridFilter(inputImage, outputImage, m_sigmaSpace, m_sigmaColor)) {
+                outputImage = inputImage.clone();
+            }
+            break;
+
+        case BlurType::RECURSIVE_GAUSSIAN: {
+            // Without an explicit sigma, use the one cv::GaussianBlur derives from the kernel size
+            double sigmaX = m_sigmaX > 0 ? m_sigmaX : 0.3 * ((m_kernelSize - 1) * 0.5 - 1) + 0.8;
+            if (!recursiveGaussianBlur(inputImage, outputImage, sigmaX, m_sigmaY)) {
+                outputImage = inputImage.clone();
+            }
+            break;
+        }
+
+        case BlurType::STACKED_BOX:
+            if (!stackedBoxFilter(inputImage, outputImage, m_kernelSize, m_boxPasses)) {
+                outputImage = inputImage.clone();
+            }
+            break;
+
         default:
-            std::cerr << "BlurNode::process: Unknown blur type." << std::endl;
+            std::cerr << "BlurNode::blurImage: Unknown blur type." << std::endl;
             outputImage = inputImage.clone();
             break;
         }
-
-        m_outputValues[0] = outputImage;
     }
 
     int BlurNode::getInputCount() const {
@@ -83,6 +170,62 @@ namespace image_processor {
         return "";
     }
 
+    std::string BlurNode::getTypeName() const {
+        return "BlurNode";
+    }
+
+    ParameterMap BlurNode::getParameters() const {
+        ParameterMap parameters;
+        parameters["blurType"] = enumToString(static_cast<int>(m_blurType), BLUR_TYPE_NAMES, BLUR_TYPE_COUNT);
+        parameters["kernelSize"] = m_kernelSize;
+        parameters["sigmaX"] = m_sigmaX;
+        parameters["sigmaY"] = m_sigmaY;
+        parameters["sigmaColor"] = m_sigmaColor;
+        parameters["sigmaSpace"] = m_sigmaSpace;
+        parameters["boxPasses"] = m_boxPasses;
+        parameters["pyramidLevels"] = m_pyramidLevels;
+        return parameters;
+    }
+
+    bool BlurNode::setParameter(const std::string& name, const ParameterValue& value) {
+        int intValue = 0;
+        double doubleValue = 0.0;
+
+        if (name == "blurType" && parameterToEnum(value, BLUR_TYPE_NAMES, BLUR_TYPE_COUNT, intValue)) {
+            setBlurType(static_cast<BlurType>(intValue));
+            return true;
+        }
+        if (name == "kernelSize" && parameterToInt(value, intValue)) {
+            setKernelSize(intValue);
+            return true;
+        }
+        if (name == "sigmaX" && parameterToDouble(value, doubleValue)) {
+            setSigmaX(doubleValue);
+            return true;
+        }
+        if (name == "sigmaY" && parameterToDouble(value, doubleValue)) {
+            setSigmaY(doubleValue);
+            return true;
+        }
+        if (name == "sigmaColor" && parameterToDouble(value, doubleValue)) {
+            setSigmaColor(doubleValue);
+            return true;
+        }
+        if (name == "sigmaSpace" && parameterToDouble(value, doubleValue)) {
+            setSigmaSpace(doubleValue);
+            return true;
+        }
+        if (name == "boxPasses" && parameterToInt(value, intValue)) {
+            setBoxPasses(intValue);
+            return true;
+        }
+        if (name == "pyramidLevels" && parameterToInt(value, intValue)) {
+            setPyramidLevels(intValue);
+            return true;
+        }
+        return false;
+    }
+
     void BlurNode::setBlurType(BlurType blurType) {
         m_blurType = blurType;
     }
@@ -131,6 +274,79 @@ namespace image_processor {
         return m_sigmaSpace;
     }
 
+    void BlurNode::setBoxPasses(int boxPasses) {
+        m_boxPasses = std::max(boxPasses, 1);
+    }
+
+    int BlurNode::getBoxPasses() const {
+        return m_boxPasses;
+    }
+
+    void BlurNode::setPyramidLevels(int pyramidLevels) {
+        m_pyramidLevels = std::min(std::max(pyramidLevels, 0), BLUR_MAX_PYRAMID_LEVELS);
+    }
+
+    int BlurNode::getPyramidLevels() const {
+        return m_pyramidLevels;
+    }
+
+    int BlurNode::getRegionMargin(int inputIndex) const {
+        switch (m_blurType) {
+        case BlurType::BILATERAL_GRID:
+            // The grid weighs pixels within four sigma space
+            return static_cast<int>(std::ceil(4.0 * m_sigmaSpace));
+
+        case BlurType::RECURSIVE_GAUSSIAN: {
+            // The recursion reaches every pixel but its weights beyond four sigma are negligible
+            double sigmaX = m_sigmaX > 0 ? m_sigmaX : 0.3 * ((m_kernelSize - 1) * 0.5 - 1) + 0.8;
+            return static_cast<int>(std::ceil(4.0 * std::max(sigmaX, m_sigmaY)));
+        }
+
+        case BlurType::STACKED_BOX:
+            return m_boxPasses * (m_kernelSize / 2);
+
+        default:
+            return m_kernelSize / 2;
+        }
+    }
+
+    bool BlurNode::isRegionExact() const {
+        // The recursion and the grid cells reach past the margin, and the grid
+        // takes its depth from the range of the pixels it sees
+        if (m_blurType == BlurType::RECURSIVE_GAUSSIAN || m_blurType == BlurType::BILATERAL_GRID) {
+            return false;
+        }
+        return m_pyramidLevels == 0 || (m_blurType != BlurType::GAUSSIAN && m_blurType != BlurType::STACKED_BOX);
+    }
+
+    bool BlurNode::blurOnPyramid(cv::Mat& outputImage) const {
+        if (m_pyramidLevels == 0) {
+            return false;
+        }
+
+        // Standard deviation of each blur type at full resolution
+        double sigmaX = 0.0;
+        if (m_blurType == BlurType::GAUSSIAN || m_blurType == BlurType::RECURSIVE_GAUSSIAN) {
+            sigmaX = m_sigmaX > 0 ? m_sigmaX : 0.3 * ((m_kernelSize - 1) * 0.5 - 1) + 0.8;
+        }
+        else if (m_blurType == BlurType::STACKED_BOX) {
+            sigmaX = std::sqrt(m_boxPasses * (static_cast<double>(m_kernelSize) * m_kernelSize - 1.0) / 12.0);
+        }
+        else {
+            return false;
+        }
+        double sigmaY = m_sigmaY > 0 && m_blurType != BlurType::STACKED_BOX ? m_sigmaY : sigmaX;
+
+        int level = coarsePyramidLevel(std::min(sigmaX, sigmaY), m_pyramidLevels);
+        if (level == 0) {
+            return false;
+        }
+
+        std::vector<cv::Mat> pyramid = getInputPyramid(0, level);
+        return static_cast<int>(pyramid.size()) > level &&
+            pyramidGaussianBlur(pyramid, level, sigmaX, sigmaY, outputImage);
+    }
+
     int BlurNode::validateKernelSize(int size) {
         // Kernel size must be positive
         if (size <= 0) {
@@ -9,10 +9,13 @@ namespace image_processor {
      * @brief Enumeration of available blur types
      */
     enum class BlurType {
-        BOX,        // Simple box blur
-        GAUSSIAN,   // Gaussian blur
-        MEDIAN,     // Median blur
-        BILATERAL   // Bilateral filter (edge-preserving)
+        BOX,                // Simple box blur
+        GAUSSIAN,           // Gaussian blur
+        MEDIAN,             // Median blur (constant time per pixel for kernels above 5)
+        BILATERAL,          // Bilateral filter (edge-preserving)
+        BILATERAL_GRID,     // Approximate bilateral filter, cost independent of sigma space
+        RECURSIVE_GAUSSIAN, // Recursive Gaussian blur, cost independent of sigma
+        STACKED_BOX         // Repeated box blur approximating a Gaussian, cost independent of kernel size
     };
 
     /**
@@ -79,6 +82,40 @@ namespace image_processor {
          */
         virtual std::string getOutputName(int index) const override;
 
+        /**
+         * @brief Get the stable type identifier of this node
+         * @return Always returns "BlurNode"
+         */
+        virtual std::string getTypeName() const override;
+
+        /**
+         * @brief Get the margin of the input each blurred pixel depends on
+         * @param inputIndex The input index
+         * @return The radius of the blur in pixels
+         */
+        virtual int getRegionMargin(int inputIndex) const override;
+
+        /**
+         * @brief Check whether a requested region is blurred exactly as the whole image would be
+         * @return False for the recursive Gaussian and the bilateral grid, and
+         *         for blurs the whole image may run on a pyramid level
+         */
+        virtual bool isRegionExact() const override;
+
+        /**
+         * @brief Get the current parameters of this node
+         * @return Map of parameter names to values
+         */
+        virtual ParameterMap getParameters() const override;
+
+        /**
+         * @brief Set a parameter by name
+         * @param name The parameter name (as returned by getParameters)
+         * @param value The new value
+         * @return True if the parameter was recognised and applied, false otherwise
+         */
+        virtual bool setParameter(const std::string& name, const ParameterValue& value) override;
+
         /**
          * @brief Set the blur type
          * @param blurType The new blur type
@@ -151,6 +188,35 @@ namespace image_processor {
          */
         double getSigmaSpace() const;
 
+        /**
+         * @brief Set the number of box passes (for stacked box blur)
+         * @param boxPasses The new number of passes (at least 1)
+         */
+        void setBoxPasses(int boxPasses);
+
+        /**
+         * @brief Get the current number of box passes
+         * @return The current number of box passes
+         */
+        int getBoxPasses() const;
+
+        /**
+         * @brief Set the coarsest pyramid level used for wide blurs
+         *
+         * GAUSSIAN, RECURSIVE_GAUSSIAN and STACKED_BOX blurs wide enough for a
+         * coarse level of the input pyramid run there and are upsampled back,
+         * which costs a small fraction of the full-resolution blur.
+         *
+         * @param pyramidLevels The coarsest level (0 always blurs at full resolution, clamped to 0..8)
+         */
+        void setPyramidLevels(int pyramidLevels);
+
+        /**
+         * @brief Get the coarsest pyramid level used for wide blurs
+         * @return The current level
+         */
+        int getPyramidLevels() const;
+
     private:
         BlurType m_blurType;     // Type of blur to apply
         int m_kernelSize;        // Size of the blur kernel
@@ -158,6 +224,22 @@ namespace image_processor {
         double m_sigmaY;         // Sigma Y value for Gaussian blur
         double m_sigmaColor;     // Sigma color value for bilateral filter
         double m_sigmaSpace;     // Sigma space value for bilateral filter
+        int m_boxPasses;         // Number of box passes for stacked box blur
+        int m_pyramidLevels;     // Coarsest pyramid level for wide blurs (0 for full resolution only)
+
+        /**
+         * @brief Apply the selected blur at full resolution
+         * @param inputImage Image to blur (not half-float)
+         * @param outputImage Receives the blurred image, with the size of inputImage
+         */
+        void blurImage(const cv::Mat& inputImage, cv::Mat& outputImage) const;
+
+        /**
+         * @brief Run a wide Gaussian-type blur on a coarse level of the input pyramid
+         * @param outputImage Receives the blurred image
+         * @return True if the blur ran on the pyramid, false if it should run at full resolution
+         */
+        bool blurOnPyramid(cv::Mat& outputImage) const;
 
         /**
          * @brief Ensure that kernel size is positive and odd
@@ -1,10 +1,52 @@
 #include "brightness_contrast_node.h"
+#include "node_registry.h"
+#include "lookup_table.h"
+#include "row_bands.h"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
 namespace image_processor {
 
+    static const char* const TONE_MODE_NAMES[] = { "LINEAR", "GAMMA", "CURVES" };
+    static const int TONE_MODE_COUNT = sizeof(TONE_MODE_NAMES) / sizeof(TONE_MODE_NAMES[0]);
+
+    // Register the node type for graph files and dynamic construction
+    static NodeTypeRegistrar s_brightnessContrastNodeRegistrar({
+        "BrightnessContrastNode",
+        "Brightness/Contrast",
+        [](const std::string& name) -> BaseNode* { return new BrightnessContrastNode(name); },
+        {
+            { "contrast", ParameterType::DOUBLE, 1.0, "Contrast gain (alpha), 1 leaves the image unchanged", 0.0, 3.0 },
+            { "brightness", ParameterType::DOUBLE, 0.0, "Brightness offset (beta), 0 leaves the image unchanged", -100.0, 100.0 },
+            { "mode", ParameterType::ENUM, std::string("LINEAR"), "Tone curve applied after brightness and contrast", 0.0, 0.0,
+                std::vector<std::string>(TONE_MODE_NAMES, TONE_MODE_NAMES + TONE_MODE_COUNT) },
+            { "gamma", ParameterType::DOUBLE, 1.0, "Gamma for GAMMA mode, above 1 brightens the mid-tones", 0.01, 10.0 },
+            { "curve", ParameterType::MATRIX, cv::Mat((cv::Mat_<double>(2, 2) << 0.0, 0.0, 1.0, 1.0)), "N x 2 curve control points (input, output) in [0, 1], used with CURVES" }
+        }
+    });
+
     BrightnessContrastNode::BrightnessContrastNode(const std::string& name, float alpha, float beta)
-        : BaseNode(name), m_alpha(alpha), m_beta(beta) {
+        : BaseNode(name), m_alpha(alpha), m_beta(beta),
+        m_mode(ToneMode::LINEAR),
+        m_gamma(1.0),
+        m_lutDirty(true) {
+        setCurve((cv::Mat_<double>(2, 2) << 0.0, 0.0, 1.0, 1.0));
+    }
+
+    template <typename T, typename F>
+    static void applyToneFunction(const cv::Mat& src, cv::Mat& dst, const F& tone) {
+        const int samples = src.cols * src.channels();
+
+        parallelForRowBands(src.rows, DEFAULT_MIN_BAND_ROWS, [&](int rowBegin, int rowEnd) {
+            for (int y = rowBegin; y < rowEnd; ++y) {
+                const T* in = src.ptr<T>(y);
+                T* out = dst.ptr<T>(y);
+                for (int x = 0; x < samples; ++x) {
+                    out[x] = static_cast<T>(tone(in[x]));
+                }
+            }
+        });
     }
 
     void BrightnessContrastNode::process() {
@@ -25,13 +67,46 @@ namespace image_processor {
             return;
         }
 
+        // Consumers that read part of the image get only that part adjusted
         cv::Mat outputImage;
+        auto adjust = [this](const cv::Mat& source, cv::Mat& adjusted) { adjustImage(source, adjusted); };
+        if (!filterRequestedRegion(inputImage, outputImage, getRegionMargin(0), adjust)) {
+            adjustImage(inputImage, outputImage);
+        }
+        setOutputValue(0, outputImage);
+    }
+
+    void BrightnessContrastNode::adjustImage(const cv::Mat& inputImage, cv::Mat& outputImage) {
+        const int depth = inputImage.depth();
 
-        // Apply brightness and contrast adjustment
-        // Formula: output = alpha * input + beta
-        inputImage.convertTo(outputImage, -1, m_alpha, m_beta);
+        if (depth == CV_8U || depth == CV_16U) {
+            // The whole transform is one table lookup per sample
+            updateLookupTable(depth);
+            applyLookupTable(inputImage, m_lut, outputImage);
+        }
+        else if (m_mode != ToneMode::LINEAR && (depth == CV_16F || depth == CV_32F || depth == CV_64F)) {
+            outputImage.create(inputImage.rows, inputImage.cols, inputImage.type());
+            auto tone = [this](double value) { return toneValue(m_alpha * value + m_beta, 1.0); };
+            if (depth == CV_16F) {
+                // Half floats are evaluated in double precision and rounded once on store
+                applyToneFunction<cv::float16_t>(inputImage, outputImage, tone);
+            }
+            else if (depth == CV_32F) {
+                applyToneFunction<float>(inputImage, outputImage, tone);
+            }
+            else {
+                applyToneFunction<double>(inputImage, outputImage, tone);
+            }
+        }
+        else {
+            if (m_mode != ToneMode::LINEAR) {
+                std::cerr << "BrightnessContrastNode::adjustImage: Tone curves need an unsigned integer or floating-point image, applying brightness and contrast only." << std::endl;
+            }
 
-        m_outputValues[0] = outputImage;
+            // Apply brightness and contrast adjustment
+            // Formula: output = alpha * input + beta
+            inputImage.convertTo(outputImage, -1, m_alpha, m_beta);
+        }
     }
 
     int BrightnessContrastNode::getInputCount() const {
@@ -56,8 +131,54 @@ namespace image_processor {
         return "";
     }
 
+    std::string BrightnessContrastNode::getTypeName() const {
+        return "BrightnessContrastNode";
+    }
+
+    int BrightnessContrastNode::getRegionMargin(int inputIndex) const {
+        return 0;
+    }
+
+    ParameterMap BrightnessContrastNode::getParameters() const {
+        ParameterMap parameters;
+        parameters["contrast"] = static_cast<double>(m_alpha);
+        parameters["brightness"] = static_cast<double>(m_beta);
+        parameters["mode"] = enumToString(static_cast<int>(m_mode), TONE_MODE_NAMES, TONE_MODE_COUNT);
+        parameters["gamma"] = m_gamma;
+        parameters["curve"] = m_curve;
+        return parameters;
+    }
+
+    bool BrightnessContrastNode::setParameter(const std::string& name, const ParameterValue& value) {
+        double doubleValue = 0.0;
+        int intValue = 0;
+        cv::Mat matValue;
+
+        if (name == "contrast" && parameterToDouble(value, doubleValue)) {
+            setContrast(static_cast<float>(doubleValue));
+            return true;
+        }
+        if (name == "brightness" && parameterToDouble(value, doubleValue)) {
+            setBrightness(static_cast<float>(doubleValue));
+            return true;
+        }
+        if (name == "mode" && parameterToEnum(value, TONE_MODE_NAMES, TONE_MODE_COUNT, intValue)) {
+            setMode(static_cast<ToneMode>(intValue));
+            return true;
+        }
+        if (name == "gamma" && parameterToDouble(value, doubleValue)) {
+            setGamma(doubleValue);
+            return true;
+        }
+        if (name == "curve" && parameterToMat(value, matValue)) {
+            return setCurve(matValue);
+        }
+        return false;
+    }
+
     void BrightnessContrastNode::setContrast(float alpha) {
         m_alpha = alpha;
+        m_lutDirty = true;
     }
 
     float BrightnessContrastNode::getContrast() const {
@@ -66,10 +187,154 @@ namespace image_processor {
 
     void BrightnessContrastNode::setBrightness(float beta) {
         m_beta = beta;
+        m_lutDirty = true;
     }
 
     float BrightnessContrastNode::getBrightness() const {
         return m_beta;
     }
 
+    void BrightnessContrastNode::setMode(ToneMode mode) {
+        m_mode = mode;
+        m_lutDirty = true;
+    }
+
+    ToneMode BrightnessContrastNode::getMode() const {
+        return m_mode;
+    }
+
+    void BrightnessContrastNode::setGamma(double gamma) {
+        m_gamma = std::max(gamma, 0.01);
+        m_lutDirty = true;
+    }
+
+    double BrightnessContrastNode::getGamma() const {
+        return m_gamma;
+    }
+
+    bool BrightnessContrastNode::setCurve(const cv::Mat& points) {
+        if (points.empty() || points.channels() != 1 || points.cols != 2 || points.rows < 2) {
+            std::cerr << "BrightnessContrastNode::setCurve: Curve must be an N x 2 matrix with N >= 2." << std::endl;
+            return false;
+        }
+
+        cv::Mat sorted;
+        points.convertTo(sorted, CV_64F);
+        std::vector<std::pair<double, double>> pairs(sorted.rows);
+        for (int i = 0; i < sorted.rows; ++i) {
+            pairs[i] = std::make_pair(sorted.at<double>(i, 0), sorted.at<double>(i, 1));
+        }
+        std::sort(pairs.begin(), pairs.end());
+
+        for (size_t i = 1; i < pairs.size(); ++i) {
+            if (pairs[i].first <= pairs[i - 1].first) {
+                std::cerr << "BrightnessContrastNode::setCurve: Curve inputs must be distinct." << std::endl;
+                return false;
+            }
+        }
+
+        const int n = static_cast<int>(pairs.size());
+        m_curve = cv::Mat(n, 2, CV_64F);
+        for (int i = 0; i < n; ++i) {
+            m_curve.at<double>(i, 0) = pairs[i].first;
+            m_curve.at<double>(i, 1) = pairs[i].second;
+        }
+
+        // Fritsch-Carlson tangents keep the curve monotone between monotone control points
+        std::vector<double> secants(n - 1);
+        for (int i = 0; i < n - 1; ++i) {
+            secants[i] = (pairs[i + 1].second - pairs[i].second) / (pairs[i + 1].first - pairs[i].first);
+        }
+
+        m_curveSlopes.assign(n, 0.0);
+        m_curveSlopes[0] = secants[0];
+        m_curveSlopes[n - 1] = secants[n - 2];
+        for (int i = 1; i < n - 1; ++i) {
+            m_curveSlopes[i] = secants[i - 1] * secants[i] <= 0.0 ? 0.0 : (secants[i - 1] + secants[i]) / 2.0;
+        }
+        for (int i = 0; i < n - 1; ++i) {
+            if (secants[i] == 0.0) {
+                m_curveSlopes[i] = 0.0;
+                m_curveSlopes[i + 1] = 0.0;
+                continue;
+            }
+            double a = m_curveSlopes[i] / secants[i];
+            double b = m_curveSlopes[i + 1] / secants[i];
+            double length = a * a + b * b;
+            if (length > 9.0) {
+                double scale = 3.0 / std::sqrt(length);
+                m_curveSlopes[i] = scale * a * secants[i];
+                m_curveSlopes[i + 1] = scale * b * secants[i];
+            }
+        }
+
+        m_lutDirty = true;
+        return true;
+    }
+
+    cv::Mat BrightnessContrastNode::getCurve() const {
+        return m_curve.clone();
+    }
+
+    double BrightnessContrastNode::evaluateCurve(double t) const {
+        const int n = m_curve.rows;
+        const double* points = m_curve.ptr<double>(0);
+        if (t <= points[0]) {
+            return points[1];
+        }
+        if (t >= points[2 * (n - 1)]) {
+            return points[2 * (n - 1) + 1];
+        }
+
+        // Find the segment containing t and evaluate its cubic Hermite polynomial
+        int i = 0;
+        while (i < n - 2 && t >= points[2 * (i + 1)]) {
+            ++i;
+        }
+        double x0 = points[2 * i];
+        double h = points[2 * (i + 1)] - x0;
+        double s = (t - x0) / h;
+        double s2 = s * s;
+        double s3 = s2 * s;
+        return (2.0 * s3 - 3.0 * s2 + 1.0) * points[2 * i + 1]
+            + (s3 - 2.0 * s2 + s) * h * m_curveSlopes[i]
+            + (-2.0 * s3 + 3.0 * s2) * points[2 * (i + 1) + 1]
+            + (s3 - s2) * h * m_curveSlopes[i + 1];
+    }
+
+    double BrightnessContrastNode::toneValue(double linear, double range) const {
+        if (m_mode == ToneMode::LINEAR) {
+            return linear;
+        }
+
+        double t = std::min(std::max(linear / range, 0.0), 1.0);
+        if (m_mode == ToneMode::GAMMA) {
+            return range * std::pow(t, 1.0 / m_gamma);
+        }
+        return range * evaluateCurve(t);
+    }
+
+    void BrightnessContrastNode::updateLookupTable(int depth) {
+        if (!m_lutDirty && !m_lut.empty() && m_lut.depth() == depth) {
+            return;
+        }
+
+        if (depth == CV_8U) {
+            m_lut.create(1, 256, CV_8U);
+            uchar* table = m_lut.ptr<uchar>(0);
+            for (int i = 0; i < 256; ++i) {
+                // Same single-precision multiply-add as convertTo
+                table[i] = cv::saturate_cast<uchar>(toneValue(m_alpha * i + m_beta, 255.0));
+            }
+        }
+        else {
+            m_lut.create(1, 65536, CV_16U);
+            ushort* table = m_lut.ptr<ushort>(0);
+            for (int i = 0; i < 65536; ++i) {
+                table[i] = cv::saturate_cast<ushort>(toneValue(m_alpha * i + m_beta, 65535.0));
+            }
+        }
+        m_lutDirty = false;
+    }
+
 } // namespace image_processor
@@ -2,15 +2,32 @@
 
 #include "base_node.h"
 #include <opencv2/opencv.hpp>
+#include <vector>
 
 namespace image_processor {
 
+    /**
+     * @brief Enumeration of available tone adjustment modes
+     */
+    enum class ToneMode {
+        LINEAR,     // output = alpha * input + beta
+        GAMMA,      // Linear adjustment followed by a gamma curve
+        CURVES      // Linear adjustment followed by a curve through control points
+    };
+
     /**
      * @brief Node for adjusting brightness and contrast of an image
      *
      * This node applies brightness and contrast adjustments to an input image.
      * The formula used is: output = alpha * input + beta
-     * where alpha controls contrast and beta controls brightness.
+     * where alpha controls contrast and beta controls brightness. The GAMMA
+     * and CURVES modes then map the result through a tone curve.
+     *
+     * For 8-bit and 16-bit images the whole transform is compiled into a
+     * lookup table, which is rebuilt only after a setting changes, so every
+     * mode costs one table lookup per sample. Floating-point depths (including
+     * half floats) evaluate the transform per sample, with tone curves
+     * spanning [0, 1].
      */
     class BrightnessContrastNode : public BaseNode {
     public:
@@ -61,6 +78,33 @@ namespace image_processor {
          */
         virtual std::string getOutputName(int index) const override;
 
+        /**
+         * @brief Get the stable type identifier of this node
+         * @return Always returns "BrightnessContrastNode"
+         */
+        virtual std::string getTypeName() const override;
+
+        /**
+         * @brief Get the margin of the input each adjusted pixel depends on
+         * @param inputIndex The input index
+         * @return Always returns 0 as every pixel is adjusted on its own
+         */
+        virtual int getRegionMargin(int inputIndex) const override;
+
+        /**
+         * @brief Get the current parameters of this node
+         * @return Map of parameter names to values
+         */
+        virtual ParameterMap getParameters() const override;
+
+        /**
+         * @brief Set a parameter by name
+         * @param name The parameter name (as returned by getParameters)
+         * @param value The new value
+         * @return True if the parameter was recognised and applied, false otherwise
+         */
+        virtual bool setParameter(const std::string& name, const ParameterValue& value) override;
+
         /**
          * @brief Set the contrast value (alpha)
          * @param alpha The new contrast value
@@ -85,9 +129,89 @@ namespace image_processor {
          */
         float getBrightness() const;
 
+        /**
+         * @brief Set the tone adjustment mode
+         * @param mode The new mode
+         */
+        void setMode(ToneMode mode);
+
+        /**
+         * @brief Get the current tone adjustment mode
+         * @return The current mode
+         */
+        ToneMode getMode() const;
+
+        /**
+         * @brief Set the gamma value (for GAMMA mode)
+         *
+         * Values above 1 brighten the mid-tones, values below 1 darken them.
+         *
+         * @param gamma The new gamma value (clamped to at least 0.01)
+         */
+        void setGamma(double gamma);
+
+        /**
+         * @brief Get the current gamma value
+         * @return The current gamma value
+         */
+        double getGamma() const;
+
+        /**
+         * @brief Set the control points of the tone curve (for CURVES mode)
+         *
+         * The curve passes through the given points with monotone cubic
+         * interpolation and is constant beyond the first and last point.
+         * Coordinates are fractions of the full range of the image depth.
+         *
+         * @param points N x 2 matrix of (input, output) pairs in [0, 1], N >= 2
+         * @return True if the points were accepted, false otherwise
+         */
+        bool setCurve(const cv::Mat& points);
+
+        /**
+         * @brief Get the control points of the tone curve
+         * @return N x 2 CV_64F matrix of (input, output) pairs, sorted by input
+         */
+        cv::Mat getCurve() const;
+
     private:
-        float m_alpha;  // Contrast control (1.0 means no change)
-        float m_beta;   // Brightness control (0.0 means no change)
+        /**
+         * @brief Apply the tone curve of the current mode to a linearly adjusted value
+         * @param linear The sample value after brightness and contrast
+         * @param range The value of full intensity for the image depth
+         * @return The transformed value, before saturation
+         */
+        double toneValue(double value, double range) const;
+
+        /**
+         * @brief Evaluate the tone curve at a fraction of the full range
+         * @param t The input fraction
+         * @return The output fraction
+         */
+        double evaluateCurve(double t) const;
+
+        /**
+         * @brief Rebuild the lookup table for the given depth if it is stale
+         * @param depth CV_8U or CV_16U
+         */
+        void updateLookupTable(int depth);
+
+        /**
+         * @brief Apply brightness, contrast and the tone curve to an image
+         * @param inputImage Image to adjust
+         * @param outputImage Receives the adjusted image, with the size and type of inputImage
+         */
+        void adjustImage(const cv::Mat& inputImage, cv::Mat& outputImage);
+
+        float m_alpha;      // Contrast control (1.0 means no change)
+        float m_beta;       // Brightness control (0.0 means no change)
+        ToneMode m_mode;    // Tone curve applied after the linear adjustment
+        double m_gamma;     // Gamma value (1.0 means no change)
+        cv::Mat m_curve;    // Curve control points, N x 2 CV_64F sorted by input
+        std::vector<double> m_curveSlopes; // Tangents of the curve at the control points
+
+        cv::Mat m_lut;      // Compiled transform for the depth it was built for
+        bool m_lutDirty;    // True when a setting changed since m_lut was built
     };
 
 } // namespace image_processor
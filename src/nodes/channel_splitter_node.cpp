@@ -1,11 +1,24 @@
 #include "channel_splitter_node.h"
+#include "node_registry.h"
+#include "row_bands.h"
+#include "simd_kernels.h"
+#include <algorithm>
 #include <iostream>
 
 namespace image_processor {
 
-    ChannelSplitterNode::ChannelSplitterNode(const std::string& name) : BaseNode
-    (name), m_channelCount(0) {
-        int m_channelCount;
+    // Register the node type for graph files and dynamic construction
+    static NodeTypeRegistrar s_channelSplitterNodeRegistrar({
+        "ChannelSplitterNode",
+        "Channel Splitter",
+        [](const std::string& name) -> BaseNode* { return new ChannelSplitterNode(name); },
+        {
+            { "channels", ParameterType::INT, 3, "Number of channel outputs before an image is processed", 1.0, static_cast<double>(CV_CN_MAX) }
+        }
+    });
+
+    ChannelSplitterNode::ChannelSplitterNode(const std::string& name, int channels) : BaseNode
+    (name), m_channels(std::min(std::max(channels, 1), CV_CN_MAX)), m_channelCount(0) {
     }
 
     void ChannelSplitterNode::process() {
@@ -26,41 +39,45 @@ namespace image_processor {
             return;
         }
 
-        std::vector<cv::Mat> channels;
-        cv::split(inputImage, channels);
-        m_channelCount = channels.size();
-
-        // Create 3-channel outputs for color visualization
-        for (int i = 0; i < m_channelCount; ++i) {
-            std::vector<cv::Mat> outputChannels;
-
-            // For BGR images, create color-specific outputs
-            if (m_channelCount == 3) {
-                outputChannels = {
-                    (i == 0) ? channels[i] : cv::Mat::zeros(inputImage.size(), CV_8UC1),  // Blue
-                    (i == 1) ? channels[i] : cv::Mat::zeros(inputImage.size(), CV_8UC1),  // Green
-                    (i == 2) ? channels[i] : cv::Mat::zeros(inputImage.size(), CV_8UC1)   // Red
-                };
-            }
-            else {
-                // For other channel counts, show single channel in first position
-                outputChannels.resize(3, cv::Mat::zeros(inputImage.size(), CV_8UC1));
-                outputChannels[0] = channels[i];
+        // Create 3-channel outputs for color visualization: for BGR images each
+        // channel keeps its color, other channel counts show it in the first position
+        // (outputs keep the depth of the input, so 16-bit and float images split too)
+        const int channelCount = inputImage.channels();
+        const int elemSize = static_cast<int>(inputImage.elemSize1());
+        std::vector<cv::Mat> outputs(channelCount);
+        for (cv::Mat& output : outputs) {
+            output.create(inputImage.size(), CV_MAKETYPE(inputImage.depth(), 3));
+        }
+
+        // Every channel is split in the same pass over the input, in parallel row bands
+        parallelForRowBands(inputImage.rows, DEFAULT_MIN_BAND_ROWS, [&](int rowBegin, int rowEnd) {
+            std::vector<uchar*> rows(channelCount);
+            for (int y = rowBegin; y < rowEnd; ++y) {
+                for (int c = 0; c < channelCount; ++c) {
+                    rows[c] = outputs[c].ptr(y);
+                }
+                splitChannelsRow(inputImage.ptr(y), channelCount, elemSize, rows.data(), inputImage.cols);
             }
+        });
 
-            cv::Mat colorOutput;
-            cv::merge(outputChannels, colorOutput);
-            m_outputValues[i] = colorOutput;
+        for (int i = 0; i < channelCount; ++i) {
+            setOutputValue(i, outputs[i]);
         }
-    }
 
+        // Channels the previous image had beyond this one's no longer exist;
+        // consumers still connected to them must not see the old images
+        for (int i = channelCount; i < m_channelCount; ++i) {
+            setOutputValue(i, PortValue());
+        }
+        m_channelCount = channelCount;
+    }
 
     int ChannelSplitterNode::getInputCount() const {
         return 1; // One input for the source image
     }
 
     int ChannelSplitterNode::getOutputCount() const {
-        return m_channelCount > 0 ? m_channelCount : 3;
+        return m_channelCount > 0 ? m_channelCount : m_channels;
     }
 
     std::string ChannelSplitterNode::getInputName(int index) const {
@@ -71,7 +88,7 @@ namespace image_processor {
     }
 
     std::string ChannelSplitterNode::getOutputName(int index) const {
-        if (index >= 0 && index < m_channelCount) {
+        if (index >= 0 && index < getOutputCount()) {
             switch (index) {
             case 0: return "Blue Channel";
             case 1: return "Green Channel";
@@ -82,6 +99,40 @@ namespace image_processor {
         return "";
     }
 
+    std::string ChannelSplitterNode::getTypeName() const {
+        return "ChannelSplitterNode";
+    }
+
+    int ChannelSplitterNode::getRegionMargin(int inputIndex) const {
+        return 0;
+    }
+
+    ParameterMap ChannelSplitterNode::getParameters() const {
+        // Reports the outputs the node has now, so a graph file saved after a
+        // run loads with the outputs its connections use
+        ParameterMap parameters;
+        parameters["channels"] = getOutputCount();
+        return parameters;
+    }
+
+    bool ChannelSplitterNode::setParameter(const std::string& name, const ParameterValue& value) {
+        int intValue = 0;
+
+        if (name == "channels" && parameterToInt(value, intValue)) {
+            setChannels(intValue);
+            return true;
+        }
+        return false;
+    }
+
+    void ChannelSplitterNode::setChannels(int channels) {
+        m_channels = std::min(std::max(channels, 1), CV_CN_MAX);
+    }
+
+    int ChannelSplitterNode::getChannels() const {
+        return m_channels;
+    }
+
     int ChannelSplitterNode::getChannelCount() const {
         return m_channelCount;
     }
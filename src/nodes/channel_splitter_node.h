@@ -17,8 +17,9 @@ namespace image_processor {
         /**
          * @brief Constructor for ChannelSplitterNode
          * @param name The name of the node
+         * @param channels Number of channel outputs before an image is processed (default: 3)
          */
-        explicit ChannelSplitterNode(const std::string& name = "Channel Splitter");
+        explicit ChannelSplitterNode(const std::string& name = "Channel Splitter", int channels = 3);
 
         /**
          * @brief Destructor
@@ -40,7 +41,8 @@ namespace image_processor {
 
         /**
          * @brief Get the number of outputs this node produces
-         * @return Returns the number of channels in the input image (typically 3 for BGR images)
+         * @return Returns the number of channels in the last processed image, or the
+         *         channels parameter before an image is processed
          */
         virtual int getOutputCount() const override;
 
@@ -58,6 +60,50 @@ namespace image_processor {
          */
         virtual std::string getOutputName(int index) const override;
 
+        /**
+         * @brief Get the stable type identifier of this node
+         * @return Always returns "ChannelSplitterNode"
+         */
+        virtual std::string getTypeName() const override;
+
+        /**
+         * @brief Get the margin of the input each channel pixel depends on
+         * @param inputIndex The input index
+         * @return Always returns 0 as every pixel is split on its own
+         */
+        virtual int getRegionMargin(int inputIndex) const override;
+
+        /**
+         * @brief Get the current parameters of this node
+         * @return Map of parameter names to values; "channels" is the current
+         *         output count, which is the channel count of the last processed image
+         */
+        virtual ParameterMap getParameters() const override;
+
+        /**
+         * @brief Set a parameter by name
+         * @param name The parameter name (as returned by getParameters)
+         * @param value The new value
+         * @return True if the parameter was recognised and applied, false otherwise
+         */
+        virtual bool setParameter(const std::string& name, const ParameterValue& value) override;
+
+        /**
+         * @brief Set the number of channel outputs before an image is processed
+         *
+         * Consumers of channels past the third of a multispectral image can
+         * then be connected (or loaded from a graph file) before the first run.
+         *
+         * @param channels The number of channels (clamped to 1..CV_CN_MAX)
+         */
+        void setChannels(int channels);
+
+        /**
+         * @brief Get the number of channel outputs before an image is processed
+         * @return The number of channels
+         */
+        int getChannels() const;
+
         /**
          * @brief Get the number of channels in the last processed image
          * @return The number of channels in the last processed image
@@ -65,6 +111,7 @@ namespace image_processor {
         int getChannelCount() const;
 
     private:
+        int m_channels;      // Number of channel outputs before an image is processed
         int m_channelCount;  // Number of channels in the last processed image
     };
 
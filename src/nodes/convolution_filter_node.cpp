@@ -1,8 +1,33 @@
 #include "convolution_filter_node.h"
+#include "node_registry.h"
+#include "box_filter.h"
+#include "pixel_kernels.h"
+#include <algorithm>
 #include <iostream>
 
 namespace image_processor {
 
+    // Symbolic names of ConvolutionFilterType values, in declaration order
+    static const char* const FILTER_TYPE_NAMES[] = {
+        "CUSTOM", "IDENTITY", "BOX_BLUR", "GAUSSIAN_BLUR", "SHARPEN", "EDGE_DETECT", "EMBOSS"
+    };
+    static const int FILTER_TYPE_COUNT = sizeof(FILTER_TYPE_NAMES) / sizeof(FILTER_TYPE_NAMES[0]);
+
+    // Register the node type for graph files and dynamic construction
+    static NodeTypeRegistrar s_convolutionFilterNodeRegistrar({
+        "ConvolutionFilterNode",
+        "Convolution Filter",
+        [](const std::string& name) -> BaseNode* { return new ConvolutionFilterNode(name); },
+        {
+            { "filterType", ParameterType::ENUM, std::string("IDENTITY"), "Predefined filter or CUSTOM", 0.0, 0.0,
+                std::vector<std::string>(FILTER_TYPE_NAMES, FILTER_TYPE_NAMES + FILTER_TYPE_COUNT) },
+            { "kernelSize", ParameterType::INT, 3, "Size of predefined kernels (odd)", 1.0 },
+            { "normalizeKernel", ParameterType::BOOL, true, "Normalize predefined kernels" },
+            { "borderType", ParameterType::INT, static_cast<int>(cv::BORDER_DEFAULT), "OpenCV border extrapolation mode" },
+            { "kernel", ParameterType::MATRIX, cv::Mat(), "Custom kernel (square, odd size), used with CUSTOM" }
+        }
+    });
+
     ConvolutionFilterNode::ConvolutionFilterNode(const std::string& name,
         ConvolutionFilterType filterType,
         int kernelSize)
@@ -32,13 +57,32 @@ namespace image_processor {
             return;
         }
 
+        // Half-float images are filtered in single precision and stored back in half precision
+        auto convolve = [this](const cv::Mat& source, cv::Mat& filtered) {
+            convolveImage(widenHalfFloat(source), filtered);
+            narrowHalfFloat(filtered, source.depth());
+        };
+
+        // Consumers that read part of the image get only that part filtered
         cv::Mat outputImage;
+        if (!filterRequestedRegion(inputImage, outputImage, getRegionMargin(0), convolve)) {
+            convolve(inputImage, outputImage);
+        }
+        setOutputValue(0, outputImage);
+    }
 
+    void ConvolutionFilterNode::convolveImage(const cv::Mat& inputImage, cv::Mat& outputImage) const {
         // Apply the convolution filter
         if (m_kernel.empty()) {
-            std::cerr << "ConvolutionFilterNode::process: Kernel is empty." << std::endl;
+            std::cerr << "ConvolutionFilterNode::convolveImage: Kernel is empty." << std::endl;
             outputImage = inputImage.clone();
         }
+        else if (m_filterType == ConvolutionFilterType::BOX_BLUR) {
+            // Running sums match the dense box kernel at a cost independent of its size
+            if (!fastBoxFilter(inputImage, outputImage, m_kernelSize, m_borderType, m_normalizeKernel)) {
+                cv::filter2D(inputImage, outputImage, -1, m_kernel, cv::Point(-1, -1), 0, m_borderType);
+            }
+        }
         else {
             // Process each channel separately for multi-channel images
             if (inputImage.channels() > 1) {
@@ -59,8 +103,6 @@ namespace image_processor {
                 cv::filter2D(inputImage, outputImage, -1, m_kernel, cv::Point(-1, -1), 0, m_borderType);
             }
         }
-
-        m_outputValues[0] = outputImage;
     }
 
     int ConvolutionFilterNode::getInputCount() const {
@@ -85,6 +127,64 @@ namespace image_processor {
         return "";
     }
 
+    std::string ConvolutionFilterNode::getTypeName() const {
+        return "ConvolutionFilterNode";
+    }
+
+    int ConvolutionFilterNode::getRegionMargin(int inputIndex) const {
+        // Wrapped borders read the opposite side of the image
+        if (m_borderType == cv::BORDER_WRAP) {
+            return WHOLE_IMAGE_MARGIN;
+        }
+        return std::max(m_kernel.rows, m_kernel.cols) / 2;
+    }
+
+    BaseNode* ConvolutionFilterNode::clone() const {
+        // The kernel is never modified in place, so copies can share its data
+        return new ConvolutionFilterNode(*this);
+    }
+
+    ParameterMap ConvolutionFilterNode::getParameters() const {
+        ParameterMap parameters;
+        parameters["filterType"] = enumToString(static_cast<int>(m_filterType), FILTER_TYPE_NAMES, FILTER_TYPE_COUNT);
+        parameters["kernelSize"] = m_kernelSize;
+        parameters["normalizeKernel"] = m_normalizeKernel;
+        parameters["borderType"] = m_borderType;
+
+        // Predefined kernels are rebuilt from the settings above; only custom ones need storing
+        if (m_filterType == ConvolutionFilterType::CUSTOM) {
+            parameters["kernel"] = m_kernel;
+        }
+        return parameters;
+    }
+
+    bool ConvolutionFilterNode::setParameter(const std::string& name, const ParameterValue& value) {
+        int intValue = 0;
+        bool boolValue = false;
+        cv::Mat matValue;
+
+        if (name == "filterType" && parameterToEnum(value, FILTER_TYPE_NAMES, FILTER_TYPE_COUNT, intValue)) {
+            setFilterType(static_cast<ConvolutionFilterType>(intValue));
+            return true;
+        }
+        if (name == "kernelSize" && parameterToInt(value, intValue)) {
+            setKernelSize(intValue);
+            return true;
+        }
+        if (name == "normalizeKernel" && parameterToBool(value, boolValue)) {
+            setNormalizeKernel(boolValue);
+            return true;
+        }
+        if (name == "borderType" && parameterToInt(value, intValue)) {
+            setBorderType(intValue);
+            return true;
+        }
+        if (name == "kernel" && parameterToMat(value, matValue)) {
+            return setCustomKernel(matValue);
+        }
+        return false;
+    }
+
     void ConvolutionFilterNode::setFilterType(ConvolutionFilterType filterType) {
         m_filterType = filterType;
         if (m_filterType != ConvolutionFilterType::CUSTOM) {
@@ -75,6 +75,42 @@ namespace image_processor {
          */
         virtual std::string getOutputName(int index) const override;
 
+        /**
+         * @brief Get the stable type identifier of this node
+         * @return Always returns "ConvolutionFilterNode"
+         */
+        virtual std::string getTypeName() const override;
+
+        /**
+         * @brief Get the margin of the input each filtered pixel depends on
+         * @param inputIndex The input index
+         * @return The radius of the kernel, or WHOLE_IMAGE_MARGIN for BORDER_WRAP
+         */
+        virtual int getRegionMargin(int inputIndex) const override;
+
+        /**
+         * @brief Get the current parameters of this node
+         * @return Map of parameter names to values
+         */
+        virtual ParameterMap getParameters() const override;
+
+        /**
+         * @brief Set a parameter by name
+         * @param name The parameter name (as returned by getParameters)
+         * @param value The new value
+         * @return True if the parameter was recognised and applied, false otherwise
+         */
+        virtual bool setParameter(const std::string& name, const ParameterValue& value) override;
+
+        /**
+         * @brief Create an unconnected copy of this node
+         *
+         * The copy shares the kernel data with this node instead of copying it.
+         *
+         * @return The new node
+         */
+        virtual BaseNode* clone() const override;
+
         /**
          * @brief Set the filter type
          * @param filterType The new filter type
@@ -143,6 +179,13 @@ namespace image_processor {
         bool m_normalizeKernel;              // Whether to normalize the kernel
         int m_borderType;                    // Border type for convolution
 
+        /**
+         * @brief Convolve an image with the current kernel
+         * @param inputImage Image to filter (not half-float)
+         * @param outputImage Receives the filtered image, with the size of inputImage
+         */
+        void convolveImage(const cv::Mat& inputImage, cv::Mat& outputImage) const;
+
         /**
          * @brief Create a predefined kernel based on the current filter type and kernel size
          */
@@ -1,8 +1,35 @@
 #include "edge_detection_node.h"
+#include "node_registry.h"
+#include "gradient_magnitude.h"
+#include "pixel_kernels.h"
+#include <algorithm>
 #include <iostream>
 
 namespace image_processor {
 
+    // Symbolic names of EdgeDetectionType values, in declaration order
+    static const char* const EDGE_TYPE_NAMES[] = { "SOBEL", "SCHARR", "LAPLACIAN", "CANNY" };
+    static const int EDGE_TYPE_COUNT = sizeof(EDGE_TYPE_NAMES) / sizeof(EDGE_TYPE_NAMES[0]);
+
+    // Distance Canny follows edges outside a requested region; hysteresis can
+    // connect edges of any length, so regions are exact only up to this
+    static const int EDGE_CANNY_HYSTERESIS_MARGIN = 16;
+
+    // Register the node type for graph files and dynamic construction
+    static NodeTypeRegistrar s_edgeDetectionNodeRegistrar({
+        "EdgeDetectionNode",
+        "Edge Detection",
+        [](const std::string& name) -> BaseNode* { return new EdgeDetectionNode(name); },
+        {
+            { "edgeType", ParameterType::ENUM, std::string("CANNY"), "Edge detection method", 0.0, 0.0,
+                std::vector<std::string>(EDGE_TYPE_NAMES, EDGE_TYPE_NAMES + EDGE_TYPE_COUNT) },
+            { "threshold1", ParameterType::DOUBLE, 100.0, "First hysteresis threshold for Canny", 0.0 },
+            { "threshold2", ParameterType::DOUBLE, 200.0, "Second hysteresis threshold for Canny", 0.0 },
+            { "apertureSize", ParameterType::INT, 3, "Aperture size of the gradient operator (1, 3, 5 or 7)", 1.0, 7.0 },
+            { "L2gradient", ParameterType::BOOL, false, "Use the L2 norm for the Canny gradient magnitude" }
+        }
+    });
+
     EdgeDetectionNode::EdgeDetectionNode(const std::string& name, EdgeDetectionType edgeType,
         double threshold1, double threshold2, int apertureSize, bool L2gradient)
         : BaseNode(name),
@@ -31,55 +58,96 @@ namespace image_processor {
             return;
         }
 
+        // Consumers that read part of the image get the edges of only that part
         cv::Mat outputImage;
-        cv::Mat grayImage;
+        auto detect = [this](const cv::Mat& source, cv::Mat& edges) { detectEdges(source, true, edges); };
+        if (!filterRequestedRegion(inputImage, outputImage, getRegionMargin(0), detect)) {
+            detectEdges(inputImage, false, outputImage);
+        }
+
+        // Gray versions of half-float images are single precision; store gradients like the input
+        narrowHalfFloat(outputImage, inputImage.depth());
+        setOutputValue(0, outputImage);
+    }
 
-        // Convert to grayscale if the image has multiple channels
-        if (inputImage.channels() > 1) {
-            cv::cvtColor(inputImage, grayImage, cv::COLOR_BGR2GRAY);
+    void EdgeDetectionNode::detectEdges(const cv::Mat& inputImage, bool isView, cv::Mat& outputImage) {
+        // 3x3 Sobel and Scharr on 8-bit images run as one fused pass, gray conversion included
+        bool fusedGradient = (m_edgeType == EdgeDetectionType::SOBEL && m_apertureSize == 3) ||
+            m_edgeType == EdgeDetectionType::SCHARR;
+        if (fusedGradient && isFusedGradientSupported(inputImage)) {
+            GradientOperator op = m_edgeType == EdgeDetectionType::SCHARR ? GradientOperator::SCHARR : GradientOperator::SOBEL;
+            if (fusedGradientMagnitude(inputImage, outputImage, op)) {
+                return;
+            }
         }
-        else {
-            grayImage = inputImage.clone();
+
+        // Gray version of the input, converted once and shared with other consumers;
+        // a view is converted on its own
+        cv::Mat grayImage = isView ? deriveImage(inputImage, DerivedFormat::GRAY) : getDerivedInput(0, DerivedFormat::GRAY);
+
+        // Canny on 8-bit images keeps its gradient and edge map buffers between frames
+        if (m_edgeType == EdgeDetectionType::CANNY && CannyDetector::isSupported(grayImage, m_apertureSize)) {
+            if (m_cannyDetector.detect(grayImage, outputImage, m_threshold1, m_threshold2, m_apertureSize, m_L2gradient)) {
+                return;
+            }
         }
 
+        // 8-bit gradients fit in 16 bits; 16-bit and float images keep single precision
+        // and store the magnitude in their own depth
+        const bool eightBit = grayImage.depth() == CV_8U;
+        const int gradientDepth = eightBit ? CV_16S : CV_32F;
+
         // Apply the selected edge detection method
         switch (m_edgeType) {
-        case EdgeDetectionType::SOBEL: {
-            cv::Mat gradX, gradY;
-            cv::Sobel(grayImage, gradX, CV_16S, 1, 0, m_apertureSize);
-            cv::Sobel(grayImage, gradY, CV_16S, 0, 1, m_apertureSize);
-            cv::convertScaleAbs(gradX, gradX);
-            cv::convertScaleAbs(gradY, gradY);
-            cv::addWeighted(gradX, 0.5, gradY, 0.5, 0, outputImage);
-            break;
-        }
-
+        case EdgeDetectionType::SOBEL:
         case EdgeDetectionType::SCHARR: {
             cv::Mat gradX, gradY;
-            cv::Scharr(grayImage, gradX, CV_16S, 1, 0);
-            cv::Scharr(grayImage, gradY, CV_16S, 0, 1);
-            cv::convertScaleAbs(gradX, gradX);
-            cv::convertScaleAbs(gradY, gradY);
-            cv::addWeighted(gradX, 0.5, gradY, 0.5, 0, outputImage);
+            if (m_edgeType == EdgeDetectionType::SOBEL) {
+                cv::Sobel(grayImage, gradX, gradientDepth, 1, 0, m_apertureSize);
+                cv::Sobel(grayImage, gradY, gradientDepth, 0, 1, m_apertureSize);
+            }
+            else {
+                cv::Scharr(grayImage, gradX, gradientDepth, 1, 0);
+                cv::Scharr(grayImage, gradY, gradientDepth, 0, 1);
+            }
+            if (eightBit) {
+                cv::convertScaleAbs(gradX, gradX);
+                cv::convertScaleAbs(gradY, gradY);
+                cv::addWeighted(gradX, 0.5, gradY, 0.5, 0, outputImage);
+            }
+            else {
+                cv::addWeighted(cv::abs(gradX), 0.5, cv::abs(gradY), 0.5, 0, outputImage, grayImage.depth());
+            }
             break;
         }
 
         case EdgeDetectionType::LAPLACIAN:
-            cv::Laplacian(grayImage, outputImage, CV_16S, m_apertureSize);
-            cv::convertScaleAbs(outputImage, outputImage);
+            cv::Laplacian(grayImage, outputImage, gradientDepth, m_apertureSize);
+            if (eightBit) {
+                cv::convertScaleAbs(outputImage, outputImage);
+            }
+            else {
+                cv::Mat(cv::abs(outputImage)).convertTo(outputImage, grayImage.depth());
+            }
             break;
 
         case EdgeDetectionType::CANNY:
-            cv::Canny(grayImage, outputImage, m_threshold1, m_threshold2, m_apertureSize, m_L2gradient);
+            // cv::Canny takes 8-bit images only, so the thresholds are in 8-bit units for every depth
+            if (eightBit) {
+                cv::Canny(grayImage, outputImage, m_threshold1, m_threshold2, m_apertureSize, m_L2gradient);
+            }
+            else {
+                cv::Mat scaled;
+                grayImage.convertTo(scaled, CV_8U, 255.0 / depthMaxValue(grayImage.depth()));
+                cv::Canny(scaled, outputImage, m_threshold1, m_threshold2, m_apertureSize, m_L2gradient);
+            }
             break;
 
         default:
-            std::cerr << "EdgeDetectionNode::process: Unknown edge detection type." << std::endl;
+            std::cerr << "EdgeDetectionNode::detectEdges: Unknown edge detection type." << std::endl;
             outputImage = grayImage.clone();
             break;
         }
-
-        m_outputValues[0] = outputImage;
     }
 
     int EdgeDetectionNode::getInputCount() const {
@@ -104,6 +172,62 @@ namespace image_processor {
         return "";
     }
 
+    std::string EdgeDetectionNode::getTypeName() const {
+        return "EdgeDetectionNode";
+    }
+
+    int EdgeDetectionNode::getRegionMargin(int inputIndex) const {
+        // Apertures 1 and 3 both read the direct neighbours
+        int gradientRadius = std::max(m_apertureSize / 2, 1);
+        if (m_edgeType == EdgeDetectionType::CANNY) {
+            // Non-maximum suppression compares with the neighbouring gradients
+            return gradientRadius + 1 + EDGE_CANNY_HYSTERESIS_MARGIN;
+        }
+        return gradientRadius;
+    }
+
+    bool EdgeDetectionNode::isRegionExact() const {
+        return m_edgeType != EdgeDetectionType::CANNY;
+    }
+
+    ParameterMap EdgeDetectionNode::getParameters() const {
+        ParameterMap parameters;
+        parameters["edgeType"] = enumToString(static_cast<int>(m_edgeType), EDGE_TYPE_NAMES, EDGE_TYPE_COUNT);
+        parameters["threshold1"] = m_threshold1;
+        parameters["threshold2"] = m_threshold2;
+        parameters["apertureSize"] = m_apertureSize;
+        parameters["L2gradient"] = m_L2gradient;
+        return parameters;
+    }
+
+    bool EdgeDetectionNode::setParameter(const std::string& name, const ParameterValue& value) {
+        int intValue = 0;
+        double doubleValue = 0.0;
+        bool boolValue = false;
+
+        if (name == "edgeType" && parameterToEnum(value, EDGE_TYPE_NAMES, EDGE_TYPE_COUNT, intValue)) {
+            setEdgeType(static_cast<EdgeDetectionType>(intValue));
+            return true;
+        }
+        if (name == "threshold1" && parameterToDouble(value, doubleValue)) {
+            setThreshold1(doubleValue);
+            return true;
+        }
+        if (name == "threshold2" && parameterToDouble(value, doubleValue)) {
+            setThreshold2(doubleValue);
+            return true;
+        }
+        if (name == "apertureSize" && parameterToInt(value, intValue)) {
+            setApertureSize(intValue);
+            return true;
+        }
+        if (name == "L2gradient" && parameterToBool(value, boolValue)) {
+            setL2gradient(boolValue);
+            return true;
+        }
+        return false;
+    }
+
     void EdgeDetectionNode::setEdgeType(EdgeDetectionType edgeType) {
         m_edgeType = edgeType;
     }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "base_node.h"
+#include "canny_detector.h"
 #include <opencv2/opencv.hpp>
 
 namespace image_processor {
@@ -77,6 +78,40 @@ namespace image_processor {
          */
         virtual std::string getOutputName(int index) const override;
 
+        /**
+         * @brief Get the stable type identifier of this node
+         * @return Always returns "EdgeDetectionNode"
+         */
+        virtual std::string getTypeName() const override;
+
+        /**
+         * @brief Get the margin of the input each edge pixel depends on
+         * @param inputIndex The input index
+         * @return The radius of the gradient operator, plus the distance edges
+         *         are followed for Canny
+         */
+        virtual int getRegionMargin(int inputIndex) const override;
+
+        /**
+         * @brief Check whether a requested region gets the same edges as the whole image
+         * @return False for Canny, whose hysteresis can follow edges past the margin
+         */
+        virtual bool isRegionExact() const override;
+
+        /**
+         * @brief Get the current parameters of this node
+         * @return Map of parameter names to values
+         */
+        virtual ParameterMap getParameters() const override;
+
+        /**
+         * @brief Set a parameter by name
+         * @param name The parameter name (as returned by getParameters)
+         * @param value The new value
+         * @return True if the parameter was recognised and applied, false otherwise
+         */
+        virtual bool setParameter(const std::string& name, const ParameterValue& value) override;
+
         /**
          * @brief Set the edge detection type
          * @param edgeType The new edge detection type
@@ -143,6 +178,16 @@ namespace image_processor {
         double m_threshold2;           // Second threshold for Canny
         int m_apertureSize;            // Aperture size for gradient operators
         bool m_L2gradient;             // Whether to use L2 norm for Canny
+        CannyDetector m_cannyDetector; // Canny detector keeping its buffers between frames
+
+        /**
+         * @brief Detect the edges of an image with the current settings
+         * @param inputImage Image to detect edges in
+         * @param isView True if inputImage is a view of part of the input, which
+         *        then gets its own gray conversion instead of the shared one
+         * @param outputImage Receives the edge image, with the size of inputImage
+         */
+        void detectEdges(const cv::Mat& inputImage, bool isView, cv::Mat& outputImage);
 
         /**
          * @brief Validate the aperture size for gradient operators
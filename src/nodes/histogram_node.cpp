@@ -0,0 +1,106 @@
+#include "histogram_node.h"
+#include "node_registry.h"
+#include "histogram.h"
+#include <algorithm>
+#include <iostream>
+
+namespace image_processor {
+
+    // Register the node type for graph files and dynamic construction
+    static NodeTypeRegistrar s_histogramNodeRegistrar({
+        "HistogramNode",
+        "Histogram",
+        [](const std::string& name) -> BaseNode* { return new HistogramNode(name); },
+        {
+            { "bins", ParameterType::INT, 256, "Number of histogram bins", 2.0, 65536.0 }
+        }
+    });
+
+    HistogramNode::HistogramNode(const std::string& name, int bins)
+        : BaseNode(name),
+        m_bins(std::min(std::max(bins, 2), 65536)) {
+    }
+
+    void HistogramNode::process() {
+        if (!isReady()) {
+            std::cerr << "HistogramNode::process: Node is not ready to process." << std::endl;
+            return;
+        }
+
+        auto inputConnection = getInputConnection(0);
+        if (inputConnection.first == nullptr) {
+            std::cerr << "HistogramNode::process: No valid input connection." << std::endl;
+            return;
+        }
+
+        // Gray version of the input, converted once and shared with other consumers
+        cv::Mat grayImage = inputConnection.first->getDerivedOutput(inputConnection.second, DerivedFormat::GRAY);
+        if (grayImage.empty()) {
+            std::cerr << "HistogramNode::process: Received empty image from input." << std::endl;
+            return;
+        }
+
+        cv::Mat histogram;
+        if (!parallelHistogram(grayImage, histogram, m_bins)) {
+            std::cerr << "HistogramNode::process: Could not compute the histogram." << std::endl;
+            return;
+        }
+
+        setOutputValue(0, PortValue(histogram, PortType::HISTOGRAM));
+    }
+
+    int HistogramNode::getInputCount() const {
+        return 1; // One input for the source image
+    }
+
+    int HistogramNode::getOutputCount() const {
+        return 1; // One output for the histogram
+    }
+
+    std::string HistogramNode::getInputName(int index) const {
+        if (index == 0) {
+            return "Image";
+        }
+        return "";
+    }
+
+    std::string HistogramNode::getOutputName(int index) const {
+        if (index == 0) {
+            return "Histogram";
+        }
+        return "";
+    }
+
+    PortType HistogramNode::getOutputType(int index) const {
+        return PortType::HISTOGRAM;
+    }
+
+    std::string HistogramNode::getTypeName() const {
+        return "HistogramNode";
+    }
+
+    ParameterMap HistogramNode::getParameters() const {
+        ParameterMap parameters;
+        parameters["bins"] = m_bins;
+        return parameters;
+    }
+
+    bool HistogramNode::setParameter(const std::string& name, const ParameterValue& value) {
+        int intValue = 0;
+
+        if (name == "bins" && parameterToInt(value, intValue)) {
+            setBins(intValue);
+            return true;
+        }
+        return false;
+    }
+
+    void HistogramNode::setBins(int bins) {
+        m_bins = std::min(std::max(bins, 2), 65536);
+    }
+
+    int HistogramNode::getBins() const {
+        return m_bins;
+    }
+
+} // namespace image_processor
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "base_node.h"
+#include <opencv2/opencv.hpp>
+
+namespace image_processor {
+
+    /**
+     * @brief Node for computing the histogram of an image
+     *
+     * This node computes the histogram of the grayscale version of its input
+     * once, in parallel, and outputs it on a histogram port. Several
+     * ThresholdNodes can take it as their optional "Histogram" input, so a
+     * frame analyzed with several histogram-based methods is only counted once.
+     */
+    class HistogramNode : public BaseNode {
+    public:
+        /**
+         * @brief Constructor for HistogramNode
+         * @param name The name of the node
+         * @param bins Initial number of bins (default: 256)
+         */
+        HistogramNode(const std::string& name = "Histogram", int bins = 256);
+
+        /**
+         * @brief Destructor
+         */
+        virtual ~HistogramNode() = default;
+
+        /**
+         * @brief Process the node
+         *
+         * Computes the histogram of the grayscale input image
+         */
+        virtual void process() override;
+
+        /**
+         * @brief Get the number of inputs this node accepts
+         * @return Always returns 1 as this node accepts a single input image
+         */
+        virtual int getInputCount() const override;
+
+        /**
+         * @brief Get the number of outputs this node produces
+         * @return Always returns 1 as this node outputs a single histogram
+         */
+        virtual int getOutputCount() const override;
+
+        /**
+         * @brief Get the name of a specific input
+         * @param index The input index
+         * @return The name of the input at the specified index
+         */
+        virtual std::string getInputName(int index) const override;
+
+        /**
+         * @brief Get the name of a specific output
+         * @param index The output index
+         * @return The name of the output at the specified index
+         */
+        virtual std::string getOutputName(int index) const override;
+
+        /**
+         * @brief Get the type of a specific output
+         * @param index The output index
+         * @return HISTOGRAM for the histogram output
+         */
+        virtual PortType getOutputType(int index) const override;
+
+        /**
+         * @brief Get the stable type identifier of this node
+         * @return Always returns "HistogramNode"
+         */
+        virtual std::string getTypeName() const override;
+
+        /**
+         * @brief Get the current parameters of this node
+         * @return Map of parameter names to values
+         */
+        virtual ParameterMap getParameters() const override;
+
+        /**
+         * @brief Set a parameter by name
+         * @param name The parameter name (as returned by getParameters)
+         * @param value The new value
+         * @return True if the parameter was recognised and applied, false otherwise
+         */
+        virtual bool setParameter(const std::string& name, const ParameterValue& value) override;
+
+        /**
+         * @brief Set the number of bins
+         * @param bins The new number of bins (clamped to 2..65536)
+         */
+        void setBins(int bins);
+
+        /**
+         * @brief Get the current number of bins
+         * @return The current number of bins
+         */
+        int getBins() const;
+
+    private:
+        int m_bins;  // Number of histogram bins
+    };
+
+} // namespace image_processor
@@ -1,9 +1,44 @@
 #include "noise_generation_node.h"
+#include "node_registry.h"
+#include "pixel_kernels.h"
+#include "simd_kernels.h"
 #include <iostream>
 #include <chrono>
+#include <vector>
 
 namespace image_processor {
 
+    // Symbolic names of NoiseType values, in declaration order
+    static const char* const NOISE_TYPE_NAMES[] = { "GAUSSIAN", "UNIFORM", "SALT_PEPPER" };
+    static const int NOISE_TYPE_COUNT = sizeof(NOISE_TYPE_NAMES) / sizeof(NOISE_TYPE_NAMES[0]);
+
+    // Symbolic names of the supported image depths, and the OpenCV depth of each
+    static const char* const IMAGE_DEPTH_NAMES[] = { "8U", "16U", "16F", "32F" };
+    static const int IMAGE_DEPTH_VALUES[] = { CV_8U, CV_16U, CV_16F, CV_32F };
+    static const int IMAGE_DEPTH_COUNT = sizeof(IMAGE_DEPTH_NAMES) / sizeof(IMAGE_DEPTH_NAMES[0]);
+
+    // Register the node type for graph files and dynamic construction
+    static NodeTypeRegistrar s_noiseGenerationNodeRegistrar({
+        "NoiseGenerationNode",
+        "Noise Generation",
+        [](const std::string& name) -> BaseNode* { return new NoiseGenerationNode(name); },
+        {
+            { "noiseType", ParameterType::ENUM, std::string("GAUSSIAN"), "Noise distribution", 0.0, 0.0,
+                std::vector<std::string>(NOISE_TYPE_NAMES, NOISE_TYPE_NAMES + NOISE_TYPE_COUNT) },
+            { "width", ParameterType::INT, 512, "Width of the noise image", 1.0 },
+            { "height", ParameterType::INT, 512, "Height of the noise image", 1.0 },
+            { "mean", ParameterType::DOUBLE, 0.0, "Mean of Gaussian noise" },
+            { "stdDev", ParameterType::DOUBLE, 1.0, "Standard deviation of Gaussian noise", 0.0 },
+            { "low", ParameterType::DOUBLE, 0.0, "Lower bound of uniform noise" },
+            { "high", ParameterType::DOUBLE, 1.0, "Upper bound of uniform noise" },
+            { "saltPepperRatio", ParameterType::DOUBLE, 0.5, "Fraction of salt among salt and pepper pixels", 0.0, 1.0 },
+            { "density", ParameterType::DOUBLE, 0.05, "Fraction of pixels replaced by salt or pepper", 0.0, 1.0 },
+            { "depth", ParameterType::ENUM, std::string("8U"), "Depth of the noise image", 0.0, 0.0,
+                std::vector<std::string>(IMAGE_DEPTH_NAMES, IMAGE_DEPTH_NAMES + IMAGE_DEPTH_COUNT) },
+            { "channels", ParameterType::INT, 3, "Channel count of the noise image (1, 3 or 4)", 1.0, 4.0 }
+        }
+    });
+
     NoiseGenerationNode::NoiseGenerationNode(const std::string& name, NoiseType noiseType,
         int width, int height, double mean, double stdDev,
         double low, double high, double saltPepperRatio, double density)
@@ -16,9 +51,14 @@ namespace image_processor {
         m_low(low),
         m_high(high),
         m_saltPepperRatio(saltPepperRatio),
-        m_density(density) {
-        // Seed the random number generator with the current time
-        unsigned seed = std::chrono::system_clock::now().time_since_epoch().count();
+        m_density(density),
+        m_depth(CV_8U),
+        m_channels(3) {
+        // Seed each node independently so that graph clones created in the
+        // same clock tick do not produce identical noise
+        std::random_device randomDevice;
+        std::seed_seq seed{ randomDevice(), randomDevice(),
+            static_cast<unsigned>(std::chrono::system_clock::now().time_since_epoch().count()) };
         m_generator.seed(seed);
     }
 
@@ -27,25 +67,31 @@ namespace image_processor {
             std::cerr << "NoiseGenerationNode: Invalid dimensions" << std::endl;
             return;
         }
-        cv::Mat noiseImage(m_height, m_width, CV_8UC3);
+        cv::Mat noiseImage(m_height, m_width, getImageType());
 
-        switch (m_noiseType) {
-        case NoiseType::GAUSSIAN:
-            generateGaussianNoise(noiseImage);
-            break;
-        case NoiseType::UNIFORM:
-            generateUniformNoise(noiseImage);
-            break;
-        case NoiseType::SALT_PEPPER:
-            generateSaltPepperNoise(noiseImage);
-            break;
-        default:
-            std::cerr << "NoiseGenerationNode::process: Unknown noise type." << std::endl;
-            noiseImage = cv::Mat::zeros(m_height, m_width, CV_8UC3);
-            break;
-        }
+        // Select the generator specialized for the depth and channel count once per image
+        dispatchPixelType(noiseImage.type(), [&](auto depthTag, auto channelTag) {
+            using T = typename decltype(depthTag)::type;
+            constexpr int CN = decltype(channelTag)::value;
 
-        m_outputValues[0] = noiseImage;
+            switch (m_noiseType) {
+            case NoiseType::GAUSSIAN:
+                generateGaussianNoise<T, CN>(noiseImage);
+                break;
+            case NoiseType::UNIFORM:
+                generateUniformNoise<T, CN>(noiseImage);
+                break;
+            case NoiseType::SALT_PEPPER:
+                generateSaltPepperNoise<T, CN>(noiseImage);
+                break;
+            default:
+                std::cerr << "NoiseGenerationNode::process: Unknown noise type." << std::endl;
+                noiseImage = cv::Mat::zeros(m_height, m_width, noiseImage.type());
+                break;
+            }
+        });
+
+        setOutputValue(0, noiseImage);
     }
 
     int NoiseGenerationNode::getInputCount() const {
@@ -67,6 +113,83 @@ namespace image_processor {
         return "";
     }
 
+    std::string NoiseGenerationNode::getTypeName() const {
+        return "NoiseGenerationNode";
+    }
+
+    bool NoiseGenerationNode::isCacheable() const {
+        return false;
+    }
+
+    ParameterMap NoiseGenerationNode::getParameters() const {
+        ParameterMap parameters;
+        parameters["noiseType"] = enumToString(static_cast<int>(m_noiseType), NOISE_TYPE_NAMES, NOISE_TYPE_COUNT);
+        parameters["width"] = m_width;
+        parameters["height"] = m_height;
+        parameters["mean"] = m_mean;
+        parameters["stdDev"] = m_stdDev;
+        parameters["low"] = m_low;
+        parameters["high"] = m_high;
+        parameters["saltPepperRatio"] = m_saltPepperRatio;
+        parameters["density"] = m_density;
+        for (int i = 0; i < IMAGE_DEPTH_COUNT; ++i) {
+            if (IMAGE_DEPTH_VALUES[i] == m_depth) {
+                parameters["depth"] = std::string(IMAGE_DEPTH_NAMES[i]);
+            }
+        }
+        parameters["channels"] = m_channels;
+        return parameters;
+    }
+
+    bool NoiseGenerationNode::setParameter(const std::string& name, const ParameterValue& value) {
+        int intValue = 0;
+        double doubleValue = 0.0;
+
+        if (name == "noiseType" && parameterToEnum(value, NOISE_TYPE_NAMES, NOISE_TYPE_COUNT, intValue)) {
+            setNoiseType(static_cast<NoiseType>(intValue));
+            return true;
+        }
+        if (name == "width" && parameterToInt(value, intValue)) {
+            setDimensions(intValue, m_height);
+            return true;
+        }
+        if (name == "height" && parameterToInt(value, intValue)) {
+            setDimensions(m_width, intValue);
+            return true;
+        }
+        if (name == "mean" && parameterToDouble(value, doubleValue)) {
+            setGaussianParameters(doubleValue, m_stdDev);
+            return true;
+        }
+        if (name == "stdDev" && parameterToDouble(value, doubleValue)) {
+            setGaussianParameters(m_mean, doubleValue);
+            return true;
+        }
+        if (name == "low" && parameterToDouble(value, doubleValue)) {
+            setUniformParameters(doubleValue, m_high);
+            return true;
+        }
+        if (name == "high" && parameterToDouble(value, doubleValue)) {
+            setUniformParameters(m_low, doubleValue);
+            return true;
+        }
+        if (name == "saltPepperRatio" && parameterToDouble(value, doubleValue)) {
+            setSaltPepperParameters(doubleValue, m_density);
+            return true;
+        }
+        if (name == "density" && parameterToDouble(value, doubleValue)) {
+            setSaltPepperParameters(m_saltPepperRatio, doubleValue);
+            return true;
+        }
+        if (name == "depth" && parameterToEnum(value, IMAGE_DEPTH_NAMES, IMAGE_DEPTH_COUNT, intValue)) {
+            return setImageType(IMAGE_DEPTH_VALUES[intValue], m_channels);
+        }
+        if (name == "channels" && parameterToInt(value, intValue)) {
+            return setImageType(m_depth, intValue);
+        }
+        return false;
+    }
+
     void NoiseGenerationNode::setNoiseType(NoiseType noiseType) {
         m_noiseType = noiseType;
     }
@@ -111,44 +234,66 @@ namespace image_processor {
         return { m_saltPepperRatio, m_density };
     }
 
+    bool NoiseGenerationNode::setImageType(int depth, int channels) {
+        if (!isKernelTypeSupported(CV_MAKETYPE(depth, channels))) {
+            std::cerr << "NoiseGenerationNode::setImageType: Depth must be 8U, 16U, 16F or 32F and channels 1, 3 or 4." << std::endl;
+            return false;
+        }
+        m_depth = depth;
+        m_channels = channels;
+        return true;
+    }
+
+    int NoiseGenerationNode::getImageType() const {
+        return CV_MAKETYPE(m_depth, m_channels);
+    }
+
+    template <typename T, int CN>
     void NoiseGenerationNode::generateGaussianNoise(cv::Mat& output) {
         std::normal_distribution<double> distribution(m_mean, m_stdDev);
+        std::vector<double> values(static_cast<size_t>(output.cols) * CN);
 
+        // Draw a row of samples, then scale and convert it with the dispatched kernel
         for (int y = 0; y < output.rows; ++y) {
-            for (int x = 0; x < output.cols; ++x) {
-                double noise = distribution(m_generator);
-                output.at<uchar>(y, x) = cv::saturate_cast<uchar>(noise * 255.0);
+            for (double& value : values) {
+                value = distribution(m_generator);
             }
+            convertScaledRow(values.data(), output.ptr<T>(y), output.cols * CN, PixelTraits<T>::maxValue);
         }
     }
 
+    template <typename T, int CN>
     void NoiseGenerationNode::generateUniformNoise(cv::Mat& output) {
         std::uniform_real_distribution<double> distribution(m_low, m_high);
+        std::vector<double> values(static_cast<size_t>(output.cols) * CN);
 
+        // Draw a row of samples, then scale and convert it with the dispatched kernel
         for (int y = 0; y < output.rows; ++y) {
-            for (int x = 0; x < output.cols; ++x) {
-                double noise = distribution(m_generator);
-                output.at<uchar>(y, x) = cv::saturate_cast<uchar>(noise * 255.0);
+            for (double& value : values) {
+                value = distribution(m_generator);
             }
+            convertScaledRow(values.data(), output.ptr<T>(y), output.cols * CN, PixelTraits<T>::maxValue);
         }
     }
 
+    template <typename T, int CN>
     void NoiseGenerationNode::generateSaltPepperNoise(cv::Mat& output) {
         std::uniform_real_distribution<double> distribution(0.0, 1.0);
+        const T salt = cv::saturate_cast<T>(PixelTraits<T>::maxValue);
+        const T pepper = T(0);
+        // Mid gray: 128 for 8U, 32768 for 16U, 0.5 for 16F and 32F
+        const T gray = std::is_integral<T>::value ? static_cast<T>((static_cast<int>(PixelTraits<T>::maxValue) + 1) / 2) : T(0.5f);
 
         for (int y = 0; y < output.rows; ++y) {
+            T* row = output.ptr<T>(y);
             for (int x = 0; x < output.cols; ++x) {
                 double random = distribution(m_generator);
+                T value = gray;
                 if (random < m_density) {
-                    if (random < m_density * m_saltPepperRatio) {
-                        output.at<uchar>(y, x) = 255; // Salt
-                    }
-                    else {
-                        output.at<uchar>(y, x) = 0;   // Pepper
-                    }
+                    value = random < m_density * m_saltPepperRatio ? salt : pepper;
                 }
-                else {
-                    output.at<uchar>(y, x) = 128; // Gray background
+                for (int c = 0; c < CN; ++c) {
+                    row[x * CN + c] = value;
                 }
             }
         }
@@ -85,6 +85,32 @@ namespace image_processor {
          */
         virtual std::string getOutputName(int index) const override;
 
+        /**
+         * @brief Get the stable type identifier of this node
+         * @return Always returns "NoiseGenerationNode"
+         */
+        virtual std::string getTypeName() const override;
+
+        /**
+         * @brief Check whether the outputs may be reused from the result cache
+         * @return Always returns false as every run draws new noise
+         */
+        virtual bool isCacheable() const override;
+
+        /**
+         * @brief Get the current parameters of this node
+         * @return Map of parameter names to values
+         */
+        virtual ParameterMap getParameters() const override;
+
+        /**
+         * @brief Set a parameter by name
+         * @param name The parameter name (as returned by getParameters)
+         * @param value The new value
+         * @return True if the parameter was recognised and applied, false otherwise
+         */
+        virtual bool setParameter(const std::string& name, const ParameterValue& value) override;
+
         /**
          * @brief Set the noise type
          * @param noiseType The new noise type
@@ -149,6 +175,25 @@ namespace image_processor {
          */
         std::pair<double, double> getSaltPepperParameters() const;
 
+        /**
+         * @brief Set the depth and channel count of the noise image
+         *
+         * Noise values are scaled by the full intensity of the depth (255 for
+         * 8U, 65535 for 16U, 1 for 16F and 32F), so the same settings give the
+         * same image in every depth.
+         *
+         * @param depth CV_8U, CV_16U, CV_16F or CV_32F
+         * @param channels 1, 3 or 4
+         * @return True if the type was accepted, false otherwise
+         */
+        bool setImageType(int depth, int channels);
+
+        /**
+         * @brief Get the OpenCV type of the noise image
+         * @return The matrix type (e.g. CV_8UC3)
+         */
+        int getImageType() const;
+
     private:
         NoiseType m_noiseType;
         int m_width;
@@ -159,25 +204,30 @@ namespace image_processor {
         double m_high;
         double m_saltPepperRatio;
         double m_density;
+        int m_depth;        // Depth of the noise image (CV_8U, CV_16U, CV_16F or CV_32F)
+        int m_channels;     // Channel count of the noise image (1, 3 or 4)
 
         std::mt19937 m_generator;  // Mersenne Twister random number generator
 
         /**
-         * @brief Generate Gaussian noise
-         * @param output The output image to fill with noise
+         * @brief Generate Gaussian noise, independently for each channel
+         * @param output The output image to fill with noise, of sample type T with CN channels
          */
+        template <typename T, int CN>
         void generateGaussianNoise(cv::Mat& output);
 
         /**
-         * @brief Generate uniform noise
-         * @param output The output image to fill with noise
+         * @brief Generate uniform noise, independently for each channel
+         * @param output The output image to fill with noise, of sample type T with CN channels
          */
+        template <typename T, int CN>
         void generateUniformNoise(cv::Mat& output);
 
         /**
-         * @brief Generate salt and pepper noise
-         * @param output The output image to fill with noise
+         * @brief Generate salt and pepper noise, with all channels of a pixel equal
+         * @param output The output image to fill with noise, of sample type T with CN channels
          */
+        template <typename T, int CN>
         void generateSaltPepperNoise(cv::Mat& output);
     };
 
@@ -1,8 +1,45 @@
 #include "threshold_node.h"
+#include "node_registry.h"
+#include "local_threshold.h"
+#include "histogram.h"
+#include "pixel_kernels.h"
+#include "pyramid.h"
+#include <algorithm>
 #include <iostream>
 
 namespace image_processor {
 
+    // Symbolic names of ThresholdType values, in declaration order
+    static const char* const THRESHOLD_TYPE_NAMES[] = {
+        "BINARY", "BINARY_INV", "TRUNC", "TOZERO", "TOZERO_INV", "OTSU", "ADAPTIVE_MEAN", "ADAPTIVE_GAUSSIAN",
+        "INTEGRAL_MEAN", "NIBLACK", "SAUVOLA", "MULTI_OTSU", "TRIANGLE", "PERCENTILE"
+    };
+    static const int THRESHOLD_TYPE_COUNT = sizeof(THRESHOLD_TYPE_NAMES) / sizeof(THRESHOLD_TYPE_NAMES[0]);
+
+    // Coarsest pyramid level the node may compute local means at
+    static const int THRESHOLD_MAX_PYRAMID_LEVELS = 8;
+
+    // Register the node type for graph files and dynamic construction
+    static NodeTypeRegistrar s_thresholdNodeRegistrar({
+        "ThresholdNode",
+        "Threshold",
+        [](const std::string& name) -> BaseNode* { return new ThresholdNode(name); },
+        {
+            { "thresholdType", ParameterType::ENUM, std::string("BINARY"), "Thresholding method", 0.0, 0.0,
+                std::vector<std::string>(THRESHOLD_TYPE_NAMES, THRESHOLD_TYPE_NAMES + THRESHOLD_TYPE_COUNT) },
+            { "threshold", ParameterType::DOUBLE, 128.0, "Threshold value, in the value range of the image depth", 0.0, 65535.0 },
+            { "maxValue", ParameterType::DOUBLE, 255.0, "Value assigned to pixels passing the threshold, in the value range of the image depth", 0.0, 65535.0 },
+            { "blockSize", ParameterType::INT, 11, "Neighbourhood size for adaptive methods (odd)", 3.0 },
+            { "C", ParameterType::DOUBLE, 2.0, "Constant subtracted from the mean for adaptive methods" },
+            { "k", ParameterType::DOUBLE, 0.5, "Weight of the local standard deviation for Sauvola" },
+            { "niblackK", ParameterType::DOUBLE, -0.2, "Weight of the local standard deviation for Niblack (usually negative)" },
+            { "R", ParameterType::DOUBLE, 128.0, "Dynamic range of the standard deviation for Sauvola" },
+            { "levels", ParameterType::INT, 3, "Number of classes for multi-level Otsu", 2.0, 16.0 },
+            { "percentile", ParameterType::DOUBLE, 50.0, "Share of pixels below the percentile threshold", 0.0, 100.0 },
+            { "pyramidLevels", ParameterType::INT, 0, "Coarsest pyramid level for large adaptive blocks (0 works at full resolution)", 0.0, 8.0 }
+        }
+    });
+
     ThresholdNode::ThresholdNode(const std::string& name, ThresholdType thresholdType,
         double threshold, double maxValue, int blockSize, double C)
         : BaseNode(name),
@@ -10,7 +47,13 @@ namespace image_processor {
         m_threshold(threshold),
         m_maxValue(maxValue),
         m_blockSize(validateBlockSize(blockSize)),
-        m_C(C) {
+        m_C(C),
+        m_k(0.5),
+        m_niblackK(-0.2),
+        m_R(128.0),
+        m_levels(3),
+        m_percentile(50.0),
+        m_pyramidLevels(0) {
     }
 
     void ThresholdNode::process() {
@@ -31,51 +74,86 @@ namespace image_processor {
             return;
         }
 
-        cv::Mat outputImage;
-        cv::Mat grayImage;
+        // A connected scalar input overrides the threshold parameter for this run
+        double threshold = m_threshold;
+        PortValue thresholdInput = getInputPortValue(1);
+        if (thresholdInput.isScalar()) {
+            threshold = thresholdInput.getScalar();
+        }
 
-        // Convert to grayscale if the image has multiple channels
-        if (inputImage.channels() > 1) {
-            cv::cvtColor(inputImage, grayImage, cv::COLOR_BGR2GRAY);
+        // Consumers that read part of the image get only that part thresholded
+        // by the methods that look at a neighbourhood of each pixel only
+        cv::Mat outputImage;
+        PortValue usedThreshold;
+        auto thresholdView = [this, threshold, &usedThreshold](const cv::Mat& source, cv::Mat& thresholded) {
+            usedThreshold = thresholdLocally(deriveImage(source, DerivedFormat::GRAY), threshold, false, thresholded);
+            narrowHalfFloat(thresholded, source.depth());
+        };
+        if (filterRequestedRegion(inputImage, outputImage, getRegionMargin(0), thresholdView)) {
+            setOutputValue(0, outputImage);
+            setOutputValue(1, usedThreshold);
+            setOutputValue(2, PortValue());
+            return;
         }
-        else {
-            grayImage = inputImage.clone();
+
+        std::vector<double> thresholds;
+
+        // Gray version of the input, converted once and shared with other consumers
+        cv::Mat grayImage = inputConnection.first->getDerivedOutput(inputConnection.second, DerivedFormat::GRAY);
+
+        // Histogram methods use a connected histogram, or count one in parallel
+        cv::Mat histogram;
+        if (m_thresholdType == ThresholdType::OTSU || m_thresholdType == ThresholdType::MULTI_OTSU ||
+            m_thresholdType == ThresholdType::TRIANGLE || m_thresholdType == ThresholdType::PERCENTILE) {
+            histogram = getInputPortValue(2).getMat();
+            if (histogram.empty() && !parallelHistogram(grayImage, histogram)) {
+                std::cerr << "ThresholdNode::process: Could not compute the histogram." << std::endl;
+                setOutputValue(0, grayImage.clone());
+                setOutputValue(1, PortValue());
+                setOutputValue(2, PortValue());
+                return;
+            }
         }
+        const int bins = histogram.cols;
 
         // Apply the selected thresholding method
         switch (m_thresholdType) {
         case ThresholdType::BINARY:
-            cv::threshold(grayImage, outputImage, m_threshold, m_maxValue, cv::THRESH_BINARY);
-            break;
-
         case ThresholdType::BINARY_INV:
-            cv::threshold(grayImage, outputImage, m_threshold, m_maxValue, cv::THRESH_BINARY_INV);
-            break;
-
         case ThresholdType::TRUNC:
-            cv::threshold(grayImage, outputImage, m_threshold, m_maxValue, cv::THRESH_TRUNC);
-            break;
-
         case ThresholdType::TOZERO:
-            cv::threshold(grayImage, outputImage, m_threshold, m_maxValue, cv::THRESH_TOZERO);
-            break;
-
         case ThresholdType::TOZERO_INV:
-            cv::threshold(grayImage, outputImage, m_threshold, m_maxValue, cv::THRESH_TOZERO_INV);
+        case ThresholdType::ADAPTIVE_MEAN:
+        case ThresholdType::ADAPTIVE_GAUSSIAN:
+        case ThresholdType::INTEGRAL_MEAN:
+        case ThresholdType::NIBLACK:
+        case ThresholdType::SAUVOLA:
+            usedThreshold = thresholdLocally(grayImage, threshold, true, outputImage);
             break;
 
         case ThresholdType::OTSU:
-            cv::threshold(grayImage, outputImage, m_threshold, m_maxValue, cv::THRESH_BINARY | cv::THRESH_OTSU);
+            thresholds.push_back(histogramBinToThreshold(otsuThreshold(histogram), bins, grayImage.depth()));
             break;
 
-        case ThresholdType::ADAPTIVE_MEAN:
-            cv::adaptiveThreshold(grayImage, outputImage, m_maxValue, cv::ADAPTIVE_THRESH_MEAN_C,
-                cv::THRESH_BINARY, m_blockSize, m_C);
+        case ThresholdType::MULTI_OTSU:
+            for (int bin : multiOtsuThresholds(histogram, m_levels)) {
+                thresholds.push_back(histogramBinToThreshold(bin, bins, grayImage.depth()));
+            }
+            // Two levels give one threshold, applied below like the other single thresholds
+            if (thresholds.size() > 1) {
+                if (!applyMultiThreshold(grayImage, outputImage, thresholds, m_maxValue)) {
+                    outputImage = grayImage.clone();
+                }
+                usedThreshold = PortValue(thresholds.front());
+            }
             break;
 
-        case ThresholdType::ADAPTIVE_GAUSSIAN:
-            cv::adaptiveThreshold(grayImage, outputImage, m_maxValue, cv::ADAPTIVE_THRESH_GAUSSIAN_C,
-                cv::THRESH_BINARY, m_blockSize, m_C);
+        case ThresholdType::TRIANGLE:
+            thresholds.push_back(histogramBinToThreshold(triangleThreshold(histogram), bins, grayImage.depth()));
+            break;
+
+        case ThresholdType::PERCENTILE:
+            thresholds.push_back(histogramBinToThreshold(percentileThreshold(histogram, m_percentile), bins, grayImage.depth()));
             break;
 
         default:
@@ -84,21 +162,43 @@ namespace image_processor {
             break;
         }
 
-        m_outputValues[0] = outputImage;
+        // Single thresholds computed from the histogram are applied as a binary threshold
+        if (thresholds.size() == 1) {
+            cv::threshold(grayImage, outputImage, thresholds[0], m_maxValue, cv::THRESH_BINARY);
+            usedThreshold = PortValue(thresholds[0]);
+        }
+
+        PortValue thresholdList;
+        if (!thresholds.empty()) {
+            thresholdList = PortValue(cv::Mat(thresholds, true).reshape(1, 1), PortType::VECTOR);
+        }
+
+        // Gray versions of half-float images are single precision; store the result like the input
+        narrowHalfFloat(outputImage, inputImage.depth());
+
+        setOutputValue(0, outputImage);
+        setOutputValue(1, usedThreshold);
+        setOutputValue(2, thresholdList);
     }
 
     int ThresholdNode::getInputCount() const {
-        return 1; // One input for the source image
+        return 3; // Source image, optional threshold and optional histogram
     }
 
     int ThresholdNode::getOutputCount() const {
-        return 1; // One output for the processed image
+        return 3; // Processed image, the threshold used and all computed thresholds
     }
 
     std::string ThresholdNode::getInputName(int index) const {
         if (index == 0) {
             return "Image";
         }
+        if (index == 1) {
+            return "Threshold";
+        }
+        if (index == 2) {
+            return "Histogram";
+        }
         return "";
     }
 
@@ -106,9 +206,104 @@ namespace image_processor {
         if (index == 0) {
             return "Thresholded Image";
         }
+        if (index == 1) {
+            return "Threshold";
+        }
+        if (index == 2) {
+            return "Thresholds";
+        }
         return "";
     }
 
+    PortType ThresholdNode::getInputType(int index) const {
+        if (index == 1) {
+            return PortType::SCALAR;
+        }
+        return index == 2 ? PortType::HISTOGRAM : PortType::IMAGE;
+    }
+
+    PortType ThresholdNode::getOutputType(int index) const {
+        if (index == 1) {
+            return PortType::SCALAR;
+        }
+        return index == 2 ? PortType::VECTOR : PortType::IMAGE;
+    }
+
+    bool ThresholdNode::isInputOptional(int index) const {
+        return index == 1 || index == 2;
+    }
+
+    std::string ThresholdNode::getTypeName() const {
+        return "ThresholdNode";
+    }
+
+    ParameterMap ThresholdNode::getParameters() const {
+        ParameterMap parameters;
+        parameters["thresholdType"] = enumToString(static_cast<int>(m_thresholdType), THRESHOLD_TYPE_NAMES, THRESHOLD_TYPE_COUNT);
+        parameters["threshold"] = m_threshold;
+        parameters["maxValue"] = m_maxValue;
+        parameters["blockSize"] = m_blockSize;
+        parameters["C"] = m_C;
+        parameters["k"] = m_k;
+        parameters["niblackK"] = m_niblackK;
+        parameters["R"] = m_R;
+        parameters["levels"] = m_levels;
+        parameters["percentile"] = m_percentile;
+        parameters["pyramidLevels"] = m_pyramidLevels;
+        return parameters;
+    }
+
+    bool ThresholdNode::setParameter(const std::string& name, const ParameterValue& value) {
+        int intValue = 0;
+        double doubleValue = 0.0;
+
+        if (name == "thresholdType" && parameterToEnum(value, THRESHOLD_TYPE_NAMES, THRESHOLD_TYPE_COUNT, intValue)) {
+            setThresholdType(static_cast<ThresholdType>(intValue));
+            return true;
+        }
+        if (name == "threshold" && parameterToDouble(value, doubleValue)) {
+            setThreshold(doubleValue);
+            return true;
+        }
+        if (name == "maxValue" && parameterToDouble(value, doubleValue)) {
+            setMaxValue(doubleValue);
+            return true;
+        }
+        if (name == "blockSize" && parameterToInt(value, intValue)) {
+            setBlockSize(intValue);
+            return true;
+        }
+        if (name == "C" && parameterToDouble(value, doubleValue)) {
+            setC(doubleValue);
+            return true;
+        }
+        if (name == "k" && parameterToDouble(value, doubleValue)) {
+            setK(doubleValue);
+            return true;
+        }
+        if (name == "niblackK" && parameterToDouble(value, doubleValue)) {
+            setNiblackK(doubleValue);
+            return true;
+        }
+        if (name == "R" && parameterToDouble(value, doubleValue)) {
+            setR(doubleValue);
+            return true;
+        }
+        if (name == "levels" && parameterToInt(value, intValue)) {
+            setLevels(intValue);
+            return true;
+        }
+        if (name == "percentile" && parameterToDouble(value, doubleValue)) {
+            setPercentile(doubleValue);
+            return true;
+        }
+        if (name == "pyramidLevels" && parameterToInt(value, intValue)) {
+            setPyramidLevels(intValue);
+            return true;
+        }
+        return false;
+    }
+
     void ThresholdNode::setThresholdType(ThresholdType thresholdType) {
         m_thresholdType = thresholdType;
     }
@@ -149,6 +344,196 @@ namespace image_processor {
         return m_C;
     }
 
+    void ThresholdNode::setK(double k) {
+        m_k = k;
+    }
+
+    double ThresholdNode::getK() const {
+        return m_k;
+    }
+
+    void ThresholdNode::setNiblackK(double k) {
+        m_niblackK = k;
+    }
+
+    double ThresholdNode::getNiblackK() const {
+        return m_niblackK;
+    }
+
+    void ThresholdNode::setR(double R) {
+        m_R = R;
+    }
+
+    double ThresholdNode::getR() const {
+        return m_R;
+    }
+
+    void ThresholdNode::setLevels(int levels) {
+        m_levels = std::min(std::max(levels, 2), 16);
+    }
+
+    int ThresholdNode::getLevels() const {
+        return m_levels;
+    }
+
+    void ThresholdNode::setPercentile(double percentile) {
+        m_percentile = std::min(std::max(percentile, 0.0), 100.0);
+    }
+
+    void ThresholdNode::setPyramidLevels(int pyramidLevels) {
+        m_pyramidLevels = std::min(std::max(pyramidLevels, 0), THRESHOLD_MAX_PYRAMID_LEVELS);
+    }
+
+    int ThresholdNode::getPyramidLevels() const {
+        return m_pyramidLevels;
+    }
+
+    // cv::adaptiveThreshold takes 8-bit images only; 16-bit and float images
+    // compare with a local mean in single precision (the box mean clips
+    // blocks at the border, see localAdaptiveThreshold)
+    static void adaptiveThresholdAnyDepth(const cv::Mat& grayImage, cv::Mat& outputImage, double maxValue,
+        bool gaussian, int blockSize, double C) {
+        if (grayImage.depth() == CV_8U) {
+            cv::adaptiveThreshold(grayImage, outputImage, maxValue,
+                gaussian ? cv::ADAPTIVE_THRESH_GAUSSIAN_C : cv::ADAPTIVE_THRESH_MEAN_C, cv::THRESH_BINARY, blockSize, C);
+            return;
+        }
+
+        if (!gaussian) {
+            if (!localAdaptiveThreshold(grayImage, outputImage, maxValue, blockSize, LocalThresholdMethod::MEAN, C)) {
+                outputImage = grayImage.clone();
+            }
+            return;
+        }
+
+        cv::Mat source;
+        grayImage.convertTo(source, CV_32F);
+        cv::Mat mean;
+        cv::GaussianBlur(source, mean, cv::Size(blockSize, blockSize), 0, 0, cv::BORDER_REPLICATE | cv::BORDER_ISOLATED);
+        cv::Mat mask;
+        cv::compare(source, mean - C, mask, cv::CMP_GT);
+        outputImage = cv::Mat::zeros(grayImage.size(), grayImage.type());
+        outputImage.setTo(maxValue, mask);
+    }
+
+    PortValue ThresholdNode::thresholdLocally(const cv::Mat& grayImage, double threshold, bool usePyramid, cv::Mat& outputImage) const {
+        PortValue usedThreshold;
+        switch (m_thresholdType) {
+        case ThresholdType::BINARY:
+            usedThreshold = PortValue(cv::threshold(grayImage, outputImage, threshold, m_maxValue, cv::THRESH_BINARY));
+            break;
+
+        case ThresholdType::BINARY_INV:
+            usedThreshold = PortValue(cv::threshold(grayImage, outputImage, threshold, m_maxValue, cv::THRESH_BINARY_INV));
+            break;
+
+        case ThresholdType::TRUNC:
+            usedThreshold = PortValue(cv::threshold(grayImage, outputImage, threshold, m_maxValue, cv::THRESH_TRUNC));
+            break;
+
+        case ThresholdType::TOZERO:
+            usedThreshold = PortValue(cv::threshold(grayImage, outputImage, threshold, m_maxValue, cv::THRESH_TOZERO));
+            break;
+
+        case ThresholdType::TOZERO_INV:
+            usedThreshold = PortValue(cv::threshold(grayImage, outputImage, threshold, m_maxValue, cv::THRESH_TOZERO_INV));
+            break;
+
+        case ThresholdType::ADAPTIVE_MEAN:
+            if (!usePyramid || !thresholdOnPyramid(outputImage, false)) {
+                adaptiveThresholdAnyDepth(grayImage, outputImage, m_maxValue, false, m_blockSize, m_C);
+            }
+            break;
+
+        case ThresholdType::ADAPTIVE_GAUSSIAN:
+            if (!usePyramid || !thresholdOnPyramid(outputImage, true)) {
+                adaptiveThresholdAnyDepth(grayImage, outputImage, m_maxValue, true, m_blockSize, m_C);
+            }
+            break;
+
+        case ThresholdType::INTEGRAL_MEAN:
+            if (usePyramid && thresholdOnPyramid(outputImage, false)) {
+                break;
+            }
+            if (!localAdaptiveThreshold(grayImage, outputImage, m_maxValue, m_blockSize, LocalThresholdMethod::MEAN, m_C)) {
+                outputImage = grayImage.clone();
+            }
+            break;
+
+        case ThresholdType::NIBLACK:
+            if (!localAdaptiveThreshold(grayImage, outputImage, m_maxValue, m_blockSize, LocalThresholdMethod::NIBLACK,
+                m_C, m_niblackK, m_R)) {
+                outputImage = grayImage.clone();
+            }
+            break;
+
+        case ThresholdType::SAUVOLA:
+            if (!localAdaptiveThreshold(grayImage, outputImage, m_maxValue, m_blockSize, LocalThresholdMethod::SAUVOLA,
+                m_C, m_k, m_R)) {
+                outputImage = grayImage.clone();
+            }
+            break;
+
+        default:
+            std::cerr << "ThresholdNode::thresholdLocally: Threshold type does not work on neighbourhoods." << std::endl;
+            outputImage = grayImage.clone();
+            break;
+        }
+        return usedThreshold;
+    }
+
+    int ThresholdNode::getRegionMargin(int inputIndex) const {
+        // Threshold values computed by other nodes depend on their whole image
+        if (inputIndex != 0) {
+            return WHOLE_IMAGE_MARGIN;
+        }
+
+        switch (m_thresholdType) {
+        case ThresholdType::BINARY:
+        case ThresholdType::BINARY_INV:
+        case ThresholdType::TRUNC:
+        case ThresholdType::TOZERO:
+        case ThresholdType::TOZERO_INV:
+            return 0;
+
+        case ThresholdType::ADAPTIVE_MEAN:
+        case ThresholdType::ADAPTIVE_GAUSSIAN:
+        case ThresholdType::INTEGRAL_MEAN:
+        case ThresholdType::NIBLACK:
+        case ThresholdType::SAUVOLA:
+            return m_blockSize / 2;
+
+        default:
+            // Histogram methods look at every pixel
+            return WHOLE_IMAGE_MARGIN;
+        }
+    }
+
+    bool ThresholdNode::isRegionExact() const {
+        return m_pyramidLevels == 0 || (m_thresholdType != ThresholdType::ADAPTIVE_MEAN &&
+            m_thresholdType != ThresholdType::ADAPTIVE_GAUSSIAN && m_thresholdType != ThresholdType::INTEGRAL_MEAN);
+    }
+
+    bool ThresholdNode::thresholdOnPyramid(cv::Mat& outputImage, bool gaussian) const {
+        if (m_pyramidLevels == 0) {
+            return false;
+        }
+
+        int level = coarsePyramidLevel(localMeanSigma(m_blockSize, gaussian), m_pyramidLevels);
+        if (level == 0) {
+            return false;
+        }
+
+        // The gray pyramid is cached on the producer and shared with other consumers
+        std::vector<cv::Mat> pyramid = getInputPyramid(0, level, DerivedFormat::GRAY);
+        return static_cast<int>(pyramid.size()) > level &&
+            pyramidAdaptiveThreshold(pyramid, level, outputImage, m_maxValue, m_blockSize, gaussian, m_C);
+    }
+
+    double ThresholdNode::getPercentile() const {
+        return m_percentile;
+    }
+
     int ThresholdNode::validateBlockSize(int size) {
         // Block size must be positive
         if (size <= 0) {
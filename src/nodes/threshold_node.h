@@ -16,7 +16,13 @@ namespace image_processor {
         TOZERO_INV,
         OTSU,
         ADAPTIVE_MEAN,
-        ADAPTIVE_GAUSSIAN
+        ADAPTIVE_GAUSSIAN,
+        INTEGRAL_MEAN,     // Block mean minus C, cost independent of the block size
+        NIBLACK,           // Block mean plus k standard deviations
+        SAUVOLA,           // Block mean scaled by 1 + k (s / R - 1), for document binarization
+        MULTI_OTSU,        // Otsu with several classes, quantized into evenly spaced levels
+        TRIANGLE,          // Triangle method for histograms with one dominant peak
+        PERCENTILE         // Threshold below which a given share of the pixels falls
     };
 
     /**
@@ -24,6 +30,17 @@ namespace image_processor {
      *
      * This node applies various types of thresholding to an input image,
      * including simple thresholding and adaptive thresholding methods.
+     *
+     * The optional scalar "Threshold" input overrides the threshold parameter
+     * while it is connected, and the scalar "Threshold" output reports the
+     * threshold actually used (the computed value for OTSU). Adaptive and
+     * block-statistics methods have no single threshold and leave that output empty.
+     *
+     * OTSU, MULTI_OTSU, TRIANGLE and PERCENTILE work on a histogram. It is
+     * taken from the optional "Histogram" input (e.g. a HistogramNode shared
+     * by several threshold nodes) or counted from the image otherwise. The
+     * "Thresholds" output lists every computed threshold, which is more than
+     * one for MULTI_OTSU.
      */
     class ThresholdNode : public BaseNode {
     public:
@@ -57,13 +74,13 @@ namespace image_processor {
 
         /**
          * @brief Get the number of inputs this node accepts
-         * @return Always returns 1 as this node accepts a single input image
+         * @return Always returns 3 (the input image, an optional threshold and an optional histogram)
          */
         virtual int getInputCount() const override;
 
         /**
          * @brief Get the number of outputs this node produces
-         * @return Always returns 1 as this node outputs a single processed image
+         * @return Always returns 3 (the thresholded image, the threshold used and all computed thresholds)
          */
         virtual int getOutputCount() const override;
 
@@ -81,6 +98,63 @@ namespace image_processor {
          */
         virtual std::string getOutputName(int index) const override;
 
+        /**
+         * @brief Get the type of a specific input
+         * @param index The input index
+         * @return IMAGE for the image input, SCALAR for the threshold input, HISTOGRAM for the histogram input
+         */
+        virtual PortType getInputType(int index) const override;
+
+        /**
+         * @brief Get the type of a specific output
+         * @param index The output index
+         * @return IMAGE for the thresholded image, SCALAR for the threshold, VECTOR for the thresholds
+         */
+        virtual PortType getOutputType(int index) const override;
+
+        /**
+         * @brief Check if an input may stay unconnected
+         * @param index The input index
+         * @return True for the threshold and histogram inputs, false otherwise
+         */
+        virtual bool isInputOptional(int index) const override;
+
+        /**
+         * @brief Get the stable type identifier of this node
+         * @return Always returns "ThresholdNode"
+         */
+        virtual std::string getTypeName() const override;
+
+        /**
+         * @brief Get the margin of an input each thresholded pixel depends on
+         * @param inputIndex The input index
+         * @return Half the block size for the adaptive methods, 0 for the fixed
+         *         ones and WHOLE_IMAGE_MARGIN for the histogram methods and the
+         *         threshold and histogram inputs
+         */
+        virtual int getRegionMargin(int inputIndex) const override;
+
+        /**
+         * @brief Check whether a requested region is thresholded exactly as the whole image would be
+         * @return False for the local mean methods when the whole image may
+         *         take its mean from a pyramid level
+         */
+        virtual bool isRegionExact() const override;
+
+        /**
+         * @brief Get the current parameters of this node
+         * @return Map of parameter names to values
+         */
+        virtual ParameterMap getParameters() const override;
+
+        /**
+         * @brief Set a parameter by name
+         * @param name The parameter name (as returned by getParameters)
+         * @param value The new value
+         * @return True if the parameter was recognised and applied, false otherwise
+         */
+        virtual bool setParameter(const std::string& name, const ParameterValue& value) override;
+
         /**
          * @brief Set the thresholding type
          * @param thresholdType The new thresholding type
@@ -141,12 +215,118 @@ namespace image_processor {
          */
         double getC() const;
 
+        /**
+         * @brief Set the k value (for SAUVOLA)
+         * @param k The new weight of the local standard deviation
+         */
+        void setK(double k);
+
+        /**
+         * @brief Get the current k value
+         * @return The current k value
+         */
+        double getK() const;
+
+        /**
+         * @brief Set the k value for NIBLACK
+         *
+         * Niblack adds k standard deviations to the block mean, so it needs a
+         * negative weight (-0.2 by default) where Sauvola uses a positive one.
+         *
+         * @param k The new weight of the local standard deviation
+         */
+        void setNiblackK(double k);
+
+        /**
+         * @brief Get the current k value for NIBLACK
+         * @return The current k value for NIBLACK
+         */
+        double getNiblackK() const;
+
+        /**
+         * @brief Set the R value (for SAUVOLA)
+         * @param R The new dynamic range of the standard deviation (positive)
+         */
+        void setR(double R);
+
+        /**
+         * @brief Get the current R value
+         * @return The current R value
+         */
+        double getR() const;
+
+        /**
+         * @brief Set the number of classes (for MULTI_OTSU)
+         * @param levels The new number of classes (clamped to 2..16)
+         */
+        void setLevels(int levels);
+
+        /**
+         * @brief Get the current number of classes
+         * @return The current number of classes
+         */
+        int getLevels() const;
+
+        /**
+         * @brief Set the percentile (for PERCENTILE)
+         * @param percentile The new share of pixels in percent (clamped to 0..100)
+         */
+        void setPercentile(double percentile);
+
+        /**
+         * @brief Get the current percentile
+         * @return The current percentile
+         */
+        double getPercentile() const;
+
+        /**
+         * @brief Set the coarsest pyramid level used for large adaptive blocks
+         *
+         * ADAPTIVE_MEAN, ADAPTIVE_GAUSSIAN and INTEGRAL_MEAN compute the local
+         * mean of large blocks on a coarse level of the gray input pyramid and
+         * upsample it (see pyramidAdaptiveThreshold).
+         *
+         * @param pyramidLevels The coarsest level (0 always works at full resolution, clamped to 0..8)
+         */
+        void setPyramidLevels(int pyramidLevels);
+
+        /**
+         * @brief Get the coarsest pyramid level used for large adaptive blocks
+         * @return The current level
+         */
+        int getPyramidLevels() const;
+
     private:
         ThresholdType m_thresholdType;  // Type of thresholding to apply
         double m_threshold;             // Threshold value
         double m_maxValue;              // Maximum value for BINARY and BINARY_INV
         int m_blockSize;                // Block size for adaptive methods
         double m_C;                     // Constant for adaptive methods
+        double m_k;                     // Standard deviation weight for SAUVOLA
+        double m_niblackK;              // Standard deviation weight for NIBLACK
+        double m_R;                     // Standard deviation range for SAUVOLA
+        int m_levels;                   // Number of classes for MULTI_OTSU
+        double m_percentile;            // Share of pixels below the threshold for PERCENTILE
+        int m_pyramidLevels;            // Coarsest pyramid level for adaptive methods (0 for full resolution only)
+
+        /**
+         * @brief Run a mean-based adaptive threshold on a coarse level of the gray input pyramid
+         * @param outputImage Receives the thresholded image
+         * @param gaussian True for Gaussian block weights, false for a box
+         * @return True if the threshold ran on the pyramid, false if it should run at full resolution
+         */
+        bool thresholdOnPyramid(cv::Mat& outputImage, bool gaussian) const;
+
+        /**
+         * @brief Apply a fixed or adaptive threshold, which reads a neighbourhood of each pixel only
+         * @param grayImage Gray image to threshold
+         * @param threshold Threshold of the fixed methods
+         * @param usePyramid True if the adaptive methods may run on the input pyramid,
+         *        false if grayImage is not the whole input
+         * @param outputImage Receives the thresholded image, with the size of grayImage
+         * @return The threshold used by the fixed methods, an empty value for the adaptive ones
+         */
+        PortValue thresholdLocally(const cv::Mat& grayImage, double threshold, bool usePyramid, cv::Mat& outputImage) const;
 
         /**
          * @brief Ensure that block size is positive and odd